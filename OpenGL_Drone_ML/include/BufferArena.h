@@ -0,0 +1,98 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Renderer.h"
+#include "VertexBufferLayout.h"
+
+// First fit over a free list sorted by offset, a freed range merges with its free neighbours.
+// Offsets and sizes are in whatever unit the owner counts in
+class RangeAllocator
+{
+    private:
+        std::map<unsigned int, unsigned int> m_Free; // offset -> size
+        unsigned int m_Size;
+        unsigned int m_Used;
+
+    public:
+        static constexpr unsigned int INVALID = 0xFFFFFFFF;
+
+        RangeAllocator(unsigned int size);
+
+        // Offset of a free range of size units, INVALID if none is large enough
+        unsigned int Allocate(unsigned int size);
+        void Free(unsigned int offset, unsigned int size);
+
+        inline unsigned int GetSize() const { return m_Size; }
+        inline unsigned int GetUsed() const { return m_Used; }
+};
+
+// Where a mesh lives inside a BufferArena, cheap to copy. Draw it with the arena's VAO and
+// index buffer for its block, indexCount indices from firstIndex offset by baseVertex
+struct ArenaMesh
+{
+    unsigned int block = RangeAllocator::INVALID;
+    int baseVertex = 0;
+    unsigned int vertexCount = 0;
+    unsigned int firstIndex = 0;
+    unsigned int indexCount = 0;
+
+    inline bool IsValid() const { return block != RangeAllocator::INVALID; }
+};
+
+// Meshes of one vertex layout packed into a few large vertex and index buffers instead of a
+// buffer pair and VAO each. Blocks are allocated as needed and kept when their meshes are freed,
+// so a scene loading after another one reuses the space without new GL objects
+class BufferArena
+{
+    private:
+        struct Block
+        {
+            std::unique_ptr<VertexArray> va;
+            std::unique_ptr<VertexBuffer> vb;
+            std::unique_ptr<IndexBuffer> ib;
+            RangeAllocator vertices; // in vertices
+            RangeAllocator indices;  // in indices
+        };
+
+        VertexBufferLayout m_Layout;
+        unsigned int m_BlockVertices, m_BlockIndices;
+        std::vector<Block> m_Blocks;
+        unsigned int m_MeshCount = 0;
+
+        static std::map<std::string, std::shared_ptr<BufferArena>> s_Shared;
+
+        void AddBlock(unsigned int vertices, unsigned int indices);
+
+    public:
+        struct Stats
+        {
+            unsigned int blocks, meshes;
+            size_t vertexBytesUsed, vertexBytes;
+            size_t indexBytesUsed, indexBytes;
+        };
+
+        // Block sizes are defaults, a mesh larger than a block gets a block of its own
+        BufferArena(const VertexBufferLayout& layout, unsigned int blockVertices = 1 << 16, unsigned int blockIndices = 1 << 18);
+
+        BufferArena(const BufferArena&) = delete;
+        BufferArena& operator=(const BufferArena&) = delete;
+
+        // Copies the mesh in, indices stay local to the mesh. vertices holds vertexCount * stride bytes
+        ArenaMesh Allocate(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+        void Free(ArenaMesh& mesh);
+
+        inline const VertexArray& GetVertexArray(const ArenaMesh& mesh) const { return *m_Blocks[mesh.block].va; }
+        inline const IndexBuffer& GetIndexBuffer(const ArenaMesh& mesh) const { return *m_Blocks[mesh.block].ib; }
+        void Draw(const Renderer& renderer, const Shader& shader, const ArenaMesh& mesh) const;
+
+        Stats GetStats() const;
+
+        // One arena per layout shared by everything that asks, it outlives the scenes so they
+        // reuse each other's blocks. ReleaseShared must run while the GL context still exists
+        static std::shared_ptr<BufferArena> Shared(const VertexBufferLayout& layout);
+        static void ReleaseShared();
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "Frustum.h"
+#include "Heightmap.h"
+#include "Renderer.h"
+#include "VertexBuffer.h"
+
+// Continuous distance-dependent LOD terrain (Strugar's CDLOD). Elevation lives in a single
+// channel R16 (or R32F) texture and one small grid mesh is reused for every quadtree node,
+// displaced and morphed towards the next coarser LOD in the vertex shader (res/shaders/Terrain.shader).
+// A 4k x 4k map costs 32 MB of texture instead of a 36 byte vertex per sample
+class CDLODTerrain
+{
+    private:
+        struct Node
+        {
+            float x, z;        // world corner
+            unsigned int lod;
+            bool quarter;      // only the child area of a node, drawn with the parent's LOD
+        };
+
+        const Heightmap& m_Heightmap; // must outlive the terrain
+        unsigned int m_RendererID;    // height texture
+        unsigned int m_GridSize;      // quads per node side at its LOD
+        unsigned int m_LodCount;
+        float m_LodDistance;
+        float m_MorphStart = 0.66f;   // fraction of a LOD band before morphing starts
+
+        std::vector<float> m_Ranges;                // per LOD, furthest distance it is drawn at
+        std::vector<unsigned int> m_NodesX, m_NodesZ; // node grid dimensions per LOD
+        std::vector<std::vector<glm::vec2>> m_MinMax; // per LOD, per node min/max height
+
+        std::unique_ptr<VertexArray> m_VAO;
+        std::unique_ptr<VertexBuffer> m_VertexBuffer;
+        std::unique_ptr<IndexBuffer> m_IndexBuffer;
+
+        std::vector<Node> m_Selection;
+
+        // Per node uniforms, resolved again only when Draw is given another program
+        unsigned int m_UniformProgram = 0;
+        Uniform<glm::vec2> m_NodeOffset, m_Morph;
+        Uniform<float> m_QuadSize;
+
+        void BuildMinMax();
+        void UpdateRanges();
+        AABB NodeBounds(unsigned int lod, unsigned int nx, unsigned int nz) const;
+        bool Select(unsigned int lod, unsigned int nx, unsigned int nz, const Frustum& frustum, const glm::vec3& cameraPos);
+
+    public:
+        static const unsigned int HEIGHTMAP_SLOT = 7; // last of the 8 slots Basic2 samples from
+
+        // lodDistance is the range of LOD 0, each coarser LOD doubles it. 0 picks 2.5 node widths
+        CDLODTerrain(const Heightmap& heightmap, unsigned int gridSize = 32, unsigned int lodCount = 6, float lodDistance = 0.0f);
+        ~CDLODTerrain();
+
+        CDLODTerrain(const CDLODTerrain&) = delete;
+        CDLODTerrain& operator=(const CDLODTerrain&) = delete;
+
+        // Selects nodes around the camera and draws them with a Terrain.shader program.
+        // Returns the number of draw calls issued
+        unsigned int Draw(const Renderer& renderer, Shader& shader, const glm::mat4& viewProj, const glm::vec3& cameraPos);
+
+        void SetLodDistance(float distance);
+
+        inline float GetLodDistance() const { return m_LodDistance; }
+        inline unsigned int GetLodCount() const { return m_LodCount; }
+        inline unsigned int GetNodeCount() const { return (unsigned int)m_Selection.size(); }
+        inline const Heightmap& GetHeightmap() const { return m_Heightmap; }
+        // Texture plus grid mesh, the whole GPU footprint of the terrain
+        size_t GetGPUBytes() const;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "BufferArena.h"
+#include "Frustum.h"
+#include "Renderer.h"
+#include "RenderQueue.h"
+
+// CPU side chunk produced by partitioning a mesh on the XZ plane
+struct MeshChunk
+{
+    int gridX, gridZ; // cell covers [grid * chunkSize, (grid + 1) * chunkSize) on X and Z
+    AABB bounds;
+    std::vector<unsigned char> vertices; // raw vertex bytes, same stride as the source mesh
+    std::vector<unsigned int> indices;   // local to this chunk's vertices
+};
+
+// Static mesh split at load time into a grid of spatial chunks, each with its own range of the
+// shared BufferArena for its layout and its own bounds, so only chunks inside the view frustum
+// are submitted
+class ChunkedMesh
+{
+    private:
+        struct Chunk
+        {
+            AABB bounds;
+            ArenaMesh mesh;
+        };
+        std::shared_ptr<BufferArena> m_Arena;
+        std::vector<Chunk> m_Chunks;
+        AABB m_Bounds;
+        mutable unsigned int m_VisibleCount;
+
+    public:
+        // positions are read from the first 3 floats of every vertex
+        ChunkedMesh(const void* vertices, unsigned int vertexCount, unsigned int stride,
+            const std::vector<unsigned int>& indices, const VertexBufferLayout& layout, float chunkSize);
+        ~ChunkedMesh();
+
+        ChunkedMesh(const ChunkedMesh&) = delete;
+        ChunkedMesh& operator=(const ChunkedMesh&) = delete;
+
+        // Draws chunks that intersect the frustum of viewProj, returns how many were drawn
+        unsigned int Draw(const Renderer& renderer, const Shader& shader, const glm::mat4& viewProj) const;
+        // Same culling, but queues the visible chunks in the opaque pass by distance from the camera
+        unsigned int Submit(RenderQueue& queue, Shader& shader, const glm::mat4& viewProj, const glm::vec3& cameraPos) const;
+
+        inline unsigned int GetChunkCount() const { return m_Chunks.size(); }
+        inline unsigned int GetVisibleCount() const { return m_VisibleCount; }
+        inline const AABB& GetBounds() const { return m_Bounds; }
+
+        // Bins triangles by centroid into chunkSize x chunkSize cells, duplicating shared vertices
+        static std::vector<MeshChunk> Partition(const void* vertices, unsigned int vertexCount, unsigned int stride,
+            const std::vector<unsigned int>& indices, float chunkSize);
+};
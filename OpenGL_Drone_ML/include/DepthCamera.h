@@ -0,0 +1,67 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Framebuffer.h"
+#include "Shader.h"
+#include "glm/glm.hpp"
+
+// Downward looking depth sensor. The scene is drawn from the drone into a small depth only
+// framebuffer with an orthographic projection, so every texel is a vertical ray like a LiDAR
+// sample and its depth turns into a height with a scale and offset. The depth goes through
+// a ring of pixel pack buffers with a fence each and is only mapped once the GPU is done,
+// results arrive a frame or two after Capture without ever waiting on it
+class DepthCamera
+{
+    public:
+        static constexpr unsigned int RING = 3;
+        static constexpr float NO_HIT = -999.0f; // like LidarScanBelow
+
+        // resolution x resolution samples over extent x extent world units, seeing range down
+        DepthCamera(int resolution, float extent, float range);
+        ~DepthCamera();
+
+        DepthCamera(const DepthCamera&) = delete;
+        DepthCamera& operator=(const DepthCamera&) = delete;
+
+        // Draws the scene under position and starts reading it back. draw gets the depth
+        // shader and the sensor's view projection and draws whatever the sensor should see.
+        // The caller's framebuffer and viewport are restored, depth test and writes are left on
+        void Capture(const glm::vec3& position, const std::function<void(Shader& shader, const glm::mat4& viewProj)>& draw);
+        // Takes in the newest capture the GPU has finished, true if there was one
+        bool Poll();
+
+        // Heights of the newest capture at the offsets LidarScanBelow uses, grid[row][column]
+        // with rows along z and columns along x, centered on where it was captured
+        std::vector<std::vector<float>> SampleGrid(int gridSize, float spacing) const;
+
+        // resolution x resolution heights, NO_HIT where nothing is in range. Row 0 is the +z
+        // edge (the image's up is -z), column 0 the -x edge
+        inline const std::vector<float>& GetHeights() const { return m_Heights; }
+        inline const glm::vec3& GetPosition() const { return m_Position; }
+        inline int GetResolution() const { return m_Resolution; }
+        inline unsigned int GetDroppedCount() const { return m_Dropped; }
+
+    private:
+        struct Slot
+        {
+            unsigned int buffer = 0;
+            GLsync fence = nullptr;
+            glm::vec3 position = glm::vec3(0.0f);
+        };
+
+        Framebuffer m_Target;
+        std::shared_ptr<Shader> m_Shader;
+        int m_Resolution;
+        float m_Extent, m_Range;
+        Slot m_Slots[RING];
+        unsigned int m_Next;
+        std::deque<unsigned int> m_InFlight; // oldest first
+        unsigned int m_Dropped;              // captures overwritten before they were read
+
+        std::vector<float> m_Heights;
+        glm::vec3 m_Position;
+};
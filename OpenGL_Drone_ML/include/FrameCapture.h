@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GLError.h"
+
+// Records what the bound framebuffer shows, one image per Capture(). glReadPixels goes into
+// a ring of RING pixel pack buffers with a fence each, and a buffer is only mapped once its
+// fence has passed, RING - 1 frames later, so reading back does not wait on the GPU unless
+// it falls a whole ring behind. An encoder thread writes the frames out in order, as
+// frame_000000.png... or appended to frames.rgba as raw RGBA8 video, top row first:
+//     ffmpeg -f rawvideo -pix_fmt rgba -s 960x540 -r 30 -i frames.rgba flight.mp4
+class FrameCapture
+{
+    public:
+        enum class Format { PNG, Raw };
+
+        struct Stats
+        {
+            unsigned int captured = 0; // frames read back
+            unsigned int written = 0;  // frames on disk, counted by the encoder
+            unsigned int stalls = 0;   // captures that waited on the GPU or the encoder
+        };
+
+        static constexpr unsigned int RING = 3;
+        static constexpr size_t MAX_QUEUED = 8; // frames waiting on the encoder
+
+        // Into directory, created if missing. width x height is read from the bottom left
+        FrameCapture(const std::string& directory, Format format, int width, int height);
+        ~FrameCapture();
+
+        FrameCapture(const FrameCapture&) = delete;
+        FrameCapture& operator=(const FrameCapture&) = delete;
+
+        // After the frame is drawn, reads the bound read framebuffer
+        void Capture();
+        // Blocks until every captured frame is on disk
+        void Finish();
+
+        Stats GetStats() const;
+
+    private:
+        struct Slot
+        {
+            unsigned int buffer = 0;
+            GLsync fence = nullptr;
+        };
+
+        std::string m_Directory;
+        Format m_Format;
+        int m_Width, m_Height;
+        Slot m_Slots[RING];
+        unsigned int m_Next;                  // slot the next Capture reads into
+        std::deque<unsigned int> m_InFlight;  // slots with a read pending, oldest first
+        Stats m_Stats;
+
+        std::thread m_Encoder;
+        mutable std::mutex m_Mutex;
+        std::condition_variable m_Wake, m_Done;
+        std::deque<std::vector<unsigned char>> m_Queue; // for the encoder, bottom row first
+        std::vector<std::vector<unsigned char>> m_Free; // recycled frame memory
+        unsigned int m_Encoding;                         // taken off m_Queue, not yet written
+        bool m_Stop;
+        std::ofstream m_RawFile;
+        std::vector<unsigned char> m_Encoded; // encoder thread only
+
+        // Hands the oldest read to the encoder, waiting on its fence only if wait is set.
+        // False if it was not ready
+        bool Collect(bool wait);
+        void EncoderMain();
+        void Write(const std::vector<unsigned char>& pixels, unsigned int index);
+};
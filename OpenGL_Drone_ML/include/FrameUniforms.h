@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "UniformBuffer.h"
+
+// std140 mirror of the "Camera" block, set once per frame and read by every program
+struct CameraData
+{
+    glm::mat4 view;
+    glm::mat4 proj;
+    glm::mat4 viewProj;
+    glm::vec4 position; // w unused
+};
+
+// std140 mirror of the "Object" block, one per draw
+struct ObjectData
+{
+    glm::mat4 mvp;      // full transform, so UI draws can use their own projection
+    glm::mat4 model;
+    int material;       // material layer override, -1 keeps the vertex's layer
+    int padding[3];
+};
+static_assert(sizeof(CameraData) == 208 && sizeof(ObjectData) == 144, "uniform block mirror does not match std140");
+
+// Per-frame uniform data without per-draw glUniform calls: the camera block is uploaded once
+// and stays bound at CameraBinding, per-object blocks are staged, uploaded with one
+// glBufferSubData and selected per draw with glBindBufferRange at ObjectBinding.
+// The object buffer is split in FRAMES regions so a frame never overwrites data the GPU
+// may still be reading for the previous one
+class FrameUniforms
+{
+    private:
+        static const unsigned int FRAMES = 3;
+
+        std::unique_ptr<UniformBuffer> m_CameraBuffer;
+        std::unique_ptr<UniformBuffer> m_ObjectBuffer;
+        unsigned int m_Stride;    // sizeof(ObjectData) rounded up to the offset alignment
+        unsigned int m_Capacity;  // objects per region
+        unsigned int m_Frame;
+        std::vector<unsigned char> m_Staging;
+        unsigned int m_Count;
+
+    public:
+        FrameUniforms(unsigned int objectsPerFrame = 1024);
+
+        void SetCamera(const glm::mat4& view, const glm::mat4& proj, const glm::vec3& position);
+
+        // Moves to the next region and drops last frame's objects
+        void BeginFrame();
+        // Returns the index to pass to BindObject once committed
+        unsigned int PushObject(const ObjectData& object);
+        // Uploads everything pushed since BeginFrame, growing the buffer if a frame needs more
+        void Commit();
+        void BindObject(unsigned int index) const;
+
+        inline unsigned int GetObjectCount() const { return m_Count; }
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "GLError.h"
+
+// An offscreen render target: an RGBA8 color texture (optional) and a 24 bit depth texture,
+// both sampleable. Bind() also sets the viewport to its size
+class Framebuffer
+{
+    private:
+        unsigned int m_RendererID;
+        unsigned int m_ColorAttachment, m_DepthAttachment;
+        int m_Width, m_Height;
+
+    public:
+        Framebuffer(int width, int height, bool color = true);
+        ~Framebuffer();
+
+        Framebuffer(const Framebuffer&) = delete;
+        Framebuffer& operator=(const Framebuffer&) = delete;
+
+        void Bind() const;
+        // Back to the window's framebuffer, the viewport is left for the caller
+        void Unbind() const;
+
+        inline bool HasColor() const { return m_ColorAttachment != 0; }
+        inline unsigned int GetRendererID() const { return m_RendererID; }
+        inline unsigned int GetColorAttachment() const { return m_ColorAttachment; }
+        inline unsigned int GetDepthAttachment() const { return m_DepthAttachment; }
+        inline int GetWidth() const { return m_Width; }
+        inline int GetHeight() const { return m_Height; }
+};
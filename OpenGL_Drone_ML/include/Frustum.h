@@ -0,0 +1,29 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+// Axis aligned bounding box in world space
+struct AABB
+{
+    glm::vec3 min;
+    glm::vec3 max;
+
+    AABB();
+    void Expand(const glm::vec3& point);
+    void Expand(const AABB& box);
+    inline bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+    inline glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+};
+
+// Six clip planes pulled out of a view-projection matrix (Gribb/Hartmann) for CPU culling
+class Frustum
+{
+    private:
+        glm::vec4 m_Planes[6]; // xyz = inward normal, w = distance
+
+    public:
+        Frustum(const glm::mat4& viewProj);
+
+        void Update(const glm::mat4& viewProj);
+        bool IsVisible(const AABB& box) const;
+};
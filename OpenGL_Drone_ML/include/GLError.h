@@ -2,10 +2,97 @@
 
 #include <GL/glew.h>
 
-#define ASSERT(x) if (!(x))  __debugbreak(); // Windows VisualC
-#define GLCall(x) GLClearError();\
-    x;\
-    ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+#if defined(_MSC_VER)
+    #define DEBUG_BREAK() __debugbreak() // Windows VisualC
+#elif defined(__clang__)
+    #define DEBUG_BREAK() __builtin_debugtrap()
+#elif defined(__GNUC__) && !defined(_WIN32)
+    #include <csignal>
+    #define DEBUG_BREAK() std::raise(SIGTRAP)
+#else
+    #include <cstdlib>
+    #define DEBUG_BREAK() std::abort()
+#endif
+
+#define ASSERT(x) if (!(x)) DEBUG_BREAK();
+
+// How GLCall looks for errors, switchable at runtime with GLSetErrorMode
+enum class GLErrorMode
+{
+    Off,      // no checks at all
+    Poll,     // glGetError around every call, exact but stalls the driver each time
+    Sampled,  // glGetError after one call in N, reports everything since the last check
+    Callback  // KHR_debug message callback, GLCall only records the call site
+};
+
+// Release builds compile GLCall down to the bare call. Define GL_ERRORS_ENABLED to keep
+// checking in a release build, or GL_ERRORS_DISABLED to drop it from a debug one
+#if defined(GL_ERRORS_DISABLED) || (defined(NDEBUG) && !defined(GL_ERRORS_ENABLED))
+    #define GL_ERRORS_COMPILED 0
+    #define GLCall(x) x
+#else
+    #define GL_ERRORS_COMPILED 1
+    #define GLCall(x) GLBeginCall(#x, __FILE__, __LINE__);\
+        x;\
+        ASSERT(GLEndCall())
+#endif
+
+// Where the current thread is inside GL, read back by the debug callback
+struct GLCallSite
+{
+    const char* function;
+    const char* file;
+    int line;
+};
+
+namespace glerror
+{
+    extern GLErrorMode g_Mode;
+    extern unsigned int g_SampleRate;
+    extern thread_local GLCallSite t_Site;
+    extern thread_local unsigned int t_Counter;
+    extern thread_local bool t_Check;
+}
 
 void GLClearError();
-bool GLLogCall(const char* function, const char* file, int line);
\ No newline at end of file
+bool GLLogCall(const char* function, const char* file, int line);
+
+inline void GLBeginCall(const char* function, const char* file, int line)
+{
+    using namespace glerror;
+    t_Site = {function, file, line};
+    switch (g_Mode)
+    {
+        case GLErrorMode::Poll:
+            GLClearError();
+            t_Check = true;
+            break;
+        case GLErrorMode::Sampled:
+            // Errors are left queued so the sampled call also reports the ones it skipped
+            t_Check = ++t_Counter >= g_SampleRate;
+            if (t_Check)
+                t_Counter = 0;
+            break;
+        default:
+            t_Check = false;
+            break;
+    }
+}
+
+inline bool GLEndCall()
+{
+    if (!glerror::t_Check)
+        return true;
+    return GLLogCall(glerror::t_Site.function, glerror::t_Site.file, glerror::t_Site.line);
+}
+
+// Turns on the KHR_debug callback when the driver has it and selects Callback mode,
+// otherwise stays on Poll. Call once after glewInit with the context current
+void GLEnableDebugOutput();
+
+// Returns the mode actually selected, Callback falls back to Poll without KHR_debug
+GLErrorMode GLSetErrorMode(GLErrorMode mode);
+GLErrorMode GLGetErrorMode();
+void GLSetErrorSampleRate(unsigned int everyNthCall);
+unsigned int GLGetErrorSampleRate();
+const char* GLErrorModeName(GLErrorMode mode);
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "GLError.h"
+
+// Shadow copy of the binding and fixed-function state of the one GL context, so a bind that
+// is already current costs a compare instead of a driver call. Every wrapper binds through
+// here; code that touches GL behind its back (ImGui) must be followed by Invalidate()
+class GLState
+{
+    public:
+        struct Stats
+        {
+            unsigned int issued = 0;  // state changes sent to GL
+            unsigned int elided = 0;  // state changes skipped as already current
+        };
+
+        static constexpr unsigned int MAX_TEXTURE_UNITS = 32;
+
+        static void UseProgram(unsigned int program);
+        static void BindVertexArray(unsigned int vao);
+        // GL_ELEMENT_ARRAY_BUFFER is remembered per VAO, other targets globally
+        static void BindBuffer(GLenum target, unsigned int buffer);
+        // Indexed binding, also becomes the target's generic binding like in GL
+        static void BindBufferRange(GLenum target, unsigned int index, unsigned int buffer, GLintptr offset, GLsizeiptr size);
+        static void ActiveTexture(unsigned int slot);
+        // Binds on the given unit, the active unit only changes when the bind is actually issued
+        static void BindTexture(unsigned int slot, GLenum target, unsigned int texture);
+        // Binds on whichever unit is active, for uploads that do not care about the slot
+        static void BindTexture(GLenum target, unsigned int texture);
+        // GL_FRAMEBUFFER, draw and read together
+        static void BindFramebuffer(unsigned int framebuffer);
+
+        static void SetBlend(bool enabled);
+        static void SetBlendFunc(GLenum src, GLenum dst);
+        static void SetDepthTest(bool enabled);
+        static void SetDepthMask(bool write);
+        static void SetDepthFunc(GLenum func);
+
+        // GL drops deleted names from the current bindings, and the name may be handed out again
+        static void OnDeleteProgram(unsigned int program);
+        static void OnDeleteVertexArray(unsigned int vao);
+        static void OnDeleteBuffer(unsigned int buffer);
+        static void OnDeleteTexture(unsigned int texture);
+        static void OnDeleteFramebuffer(unsigned int framebuffer);
+
+        // Forget everything, the next request of each kind is always issued
+        static void Invalidate();
+
+        // Call once a frame, returns the counts of the frame that just ended
+        static Stats NewFrame();
+        static const Stats& GetFrameStats() { return s_LastFrame; }
+
+    private:
+        static constexpr unsigned int UNKNOWN = 0xFFFFFFFF;
+        static constexpr unsigned int TEXTURE_TARGETS = 3;  // 2D, 2D array, buffer
+        static constexpr unsigned int BUFFER_TARGETS = 8;
+        static constexpr unsigned int UNIFORM_BINDINGS = 16; // GL 3.3 guarantees 36, the rest are not cached
+
+        struct TriState { signed char value = -1; }; // -1 unknown, else 0/1
+        struct Range
+        {
+            unsigned int buffer;
+            GLintptr offset;
+            GLsizeiptr size;
+        };
+
+        static unsigned int s_Program;
+        static unsigned int s_VertexArray;
+        static unsigned int s_Buffers[BUFFER_TARGETS];
+        static std::unordered_map<unsigned int, unsigned int> s_ElementBuffers; // VAO -> EBO
+        static Range s_UniformRanges[UNIFORM_BINDINGS];
+        static unsigned int s_ActiveTexture;
+        static unsigned int s_Textures[MAX_TEXTURE_UNITS][TEXTURE_TARGETS];
+        static unsigned int s_Framebuffer;
+        static TriState s_Blend, s_DepthTest, s_DepthMask;
+        static GLenum s_BlendSrc, s_BlendDst, s_DepthFunc;
+
+        static Stats s_Frame, s_LastFrame;
+
+        static int BufferIndex(GLenum target);
+        static int TextureIndex(GLenum target);
+        static void SetCap(TriState& cached, GLenum cap, bool enabled);
+        static bool Changed(unsigned int& cached, unsigned int value)
+        {
+            if (cached == value)
+            {
+                s_Frame.elided++;
+                return false;
+            }
+            cached = value;
+            s_Frame.issued++;
+            return true;
+        }
+};
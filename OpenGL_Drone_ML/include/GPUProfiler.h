@@ -0,0 +1,93 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "GLError.h"
+
+// GPU time of named scopes, measured with a GL_TIMESTAMP query at each end so scopes can nest
+// (GL_TIME_ELAPSED queries cannot). Queries live in a ring of FRAMES frames and a frame is read
+// back only when the ring comes around to it, long after the GPU finished it, so reading never
+// waits. A frame whose queries are still not ready is dropped rather than waited for
+class GPUProfiler
+{
+    public:
+        static constexpr unsigned int FRAMES = 4;
+        static constexpr unsigned int HISTORY = 256; // frames kept per scope for graphs and export
+
+        struct Result
+        {
+            std::string name;
+            unsigned int depth;
+            float ms;      // in the latest resolved frame
+            float average; // over the history
+            float peak;
+        };
+
+        // Call once a frame before any scope, resolves the oldest frame in the ring
+        static void NewFrame();
+        // name must outlive the frame, a string literal
+        static void Begin(const char* name);
+        static void End();
+
+        // Takes effect at the next NewFrame so Begin and End always pair up
+        static void SetEnabled(bool enabled);
+        static bool IsEnabled() { return s_Enabled; }
+
+        // Scopes of the latest resolved frame in submission order
+        static const std::vector<Result>& GetResults() { return s_Results; }
+        static unsigned int GetDroppedFrames() { return s_Dropped; }
+
+        // One row per frame of history, one column per scope, in milliseconds
+        static bool ExportCSV(const std::string& filepath);
+
+        // Table and graphs, drawn into the current ImGui window
+        static void OnImGuiRender();
+
+        // Deletes the query objects, the context must still exist
+        static void Shutdown();
+
+    private:
+        struct Record
+        {
+            const char* name;
+            unsigned int depth;
+            unsigned int begin, end; // indices into the frame's queries
+        };
+        struct Frame
+        {
+            std::vector<unsigned int> queries;
+            unsigned int used = 0;
+            std::vector<Record> records;
+        };
+        struct History
+        {
+            std::string name;
+            std::vector<float> samples; // ring of HISTORY, indexed by resolved frame
+        };
+
+        static Frame s_Frames[FRAMES];
+        static unsigned int s_Current;
+        static std::vector<unsigned int> s_Open; // records of the scopes not ended yet
+        static bool s_Enabled, s_PendingEnabled;
+
+        static std::vector<History> s_History;
+        static std::vector<Result> s_Results;
+        static unsigned int s_Resolved; // frames read back so far
+        static unsigned int s_Dropped;
+
+        static unsigned int Query(Frame& frame);
+        static void Resolve(Frame& frame);
+        static History& FindHistory(const char* name);
+};
+
+// Times the enclosing block
+class GPUScope
+{
+    public:
+        GPUScope(const char* name) { GPUProfiler::Begin(name); }
+        ~GPUScope() { GPUProfiler::End(); }
+
+        GPUScope(const GPUScope&) = delete;
+        GPUScope& operator=(const GPUScope&) = delete;
+};
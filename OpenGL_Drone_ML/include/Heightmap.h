@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+enum class HeightFormat
+{
+    UInt16 = 0, Float32 = 1
+};
+
+// How to interpret files that do not carry their own header (RAW, PGM)
+struct HeightmapImport
+{
+    unsigned int width = 0, height = 0; // RAW only, 0 = square map inferred from the file size
+    float spacing = 1.0f;               // world units between samples
+    float scale = 1.0f;                 // height = raw * scale + offset
+    float offset = 0.0f;
+    float minHeight = 1.0f, maxHeight = 0.0f; // world height range, min > max if unknown; spares a scan of mapped RAW
+};
+
+// Regular grid of elevations, height = raw * scale + offset. Sample (x, z) sits at world
+// (x * spacing, z * spacing), so the map covers [0, (width - 1) * spacing] x [0, (height - 1) * spacing].
+// Samples are either owned or read straight out of a memory mapped file, so DEMs larger than
+// RAM can be sampled; only the pages actually touched are read from disk
+class Heightmap
+{
+    public:
+        // .dhm layout: DHMHeader | width * height samples (little endian) at dataOffset
+        struct DHMHeader
+        {
+            char magic[4];          // "DHM1"
+            std::uint32_t width, height;
+            std::uint32_t format;   // HeightFormat
+            float spacing;
+            float scale, offset;
+            float minHeight, maxHeight; // min > max if unknown
+            std::uint32_t dataOffset;
+            std::uint32_t reserved[2];
+        };
+
+    private:
+        unsigned int m_Width, m_Height;
+        float m_Spacing;
+        HeightFormat m_Format;
+        float m_Scale, m_Offset;
+        float m_MinHeight, m_MaxHeight;
+        const void* m_Data;
+        std::vector<unsigned char> m_Storage;
+        std::unique_ptr<MappedFile> m_File;
+
+        void ComputeRange();
+        // For mapped samples, so a large map is not read end to end just for its bounds
+        void SetMappedRange(float minHeight, float maxHeight, const std::string& path);
+
+    public:
+        // Quantises width * height world heights, row by row, to 16 bits over their range
+        Heightmap(unsigned int width, unsigned int height, float spacing, const float* heights);
+        // Takes ownership of raw samples in the given format
+        Heightmap(unsigned int width, unsigned int height, float spacing, HeightFormat format, float scale, float offset, std::vector<unsigned char> samples);
+        // Views samples inside a mapped file, data must stay valid as long as the file is open
+        Heightmap(unsigned int width, unsigned int height, float spacing, HeightFormat format, float scale, float offset,
+            std::unique_ptr<MappedFile> file, std::size_t dataOffset);
+
+        // Picks the loader from the file: "DHM1" header, "P5" PGM (8 or 16 bit), otherwise headerless RAW
+        // (.r32 / .f32 are 32 bit float, anything else 16 bit). Returns nullptr if the file is unusable
+        static std::unique_ptr<Heightmap> Load(const std::string& path, const HeightmapImport& import = HeightmapImport());
+        // Writes the map as .dhm so it can be mapped directly next time
+        static bool Write(const std::string& path, const Heightmap& heightmap);
+
+        inline float GetSample(unsigned int x, unsigned int z) const
+        {
+            std::size_t i = (std::size_t)z * m_Width + x;
+            float raw = m_Format == HeightFormat::UInt16 ? (float)static_cast<const std::uint16_t*>(m_Data)[i] : static_cast<const float*>(m_Data)[i];
+            return raw * m_Scale + m_Offset;
+        }
+        // Bilinear height at a world position, clamped to the map edges. Matches linear filtering on the GPU
+        float Sample(float worldX, float worldZ) const;
+        bool Contains(float worldX, float worldZ) const;
+
+        inline bool IsMapped() const { return m_File != nullptr; }
+        inline unsigned int GetWidth() const { return m_Width; }
+        inline unsigned int GetHeight() const { return m_Height; }
+        inline float GetSpacing() const { return m_Spacing; }
+        inline HeightFormat GetFormat() const { return m_Format; }
+        inline float GetScale() const { return m_Scale; }
+        inline float GetOffset() const { return m_Offset; }
+        inline float GetMinHeight() const { return m_MinHeight; }
+        inline float GetMaxHeight() const { return m_MaxHeight; }
+        inline float GetWorldWidth() const { return (m_Width - 1) * m_Spacing; }
+        inline float GetWorldDepth() const { return (m_Height - 1) * m_Spacing; }
+        inline unsigned int GetBytesPerSample() const { return m_Format == HeightFormat::UInt16 ? 2 : 4; }
+        inline const void* GetData() const { return m_Data; }
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <memory>
+
+#include "Heightmap.h"
+#include "TerrainGenerator.h"
+
+// Cuts a heightmap into streamable mesh tiles straight from the grid. Only the samples of the
+// requested tile are read, so with a mapped Heightmap the streamer can page through DEMs far
+// larger than RAM or any texture
+class HeightmapTileSource : public TileSource
+{
+    private:
+        std::shared_ptr<const Heightmap> m_Heightmap;
+        unsigned int m_Resolution; // quads per tile side
+        int m_TilesX, m_TilesZ;
+
+    public:
+        HeightmapTileSource(std::shared_ptr<const Heightmap> heightmap, unsigned int resolution = 64);
+
+        bool HasTile(int gridX, int gridZ) const override;
+        bool LoadTile(int gridX, int gridZ, TerrainTile& out) const override;
+
+        float GetTileSize() const override { return m_Resolution * m_Heightmap->GetSpacing(); }
+        unsigned int GetStride() const override { return sizeof(TerrainVertex); }
+        unsigned int GetMaxVertexCount() const override { return (m_Resolution + 1) * (m_Resolution + 1); }
+        unsigned int GetMaxIndexCount() const override { return m_Resolution * m_Resolution * 6; }
+};
@@ -5,14 +5,34 @@ class IndexBuffer
 {
     private:
         unsigned int m_RendererID;
-        unsigned int m_Count;
+        unsigned int m_Count;     // indices holding data, what a draw uses
+        unsigned int m_Capacity;  // indices allocated
+        unsigned int m_Usage;
+
+        void Release();
     public:
         IndexBuffer(const unsigned int* data, unsigned int count);
-        IndexBuffer(unsigned int count);
+        // Empty dynamic buffer with room for capacity indices, GetCount() is 0 until SetData
+        IndexBuffer(unsigned int capacity);
         ~IndexBuffer();
 
+        IndexBuffer(const IndexBuffer&) = delete;
+        IndexBuffer& operator=(const IndexBuffer&) = delete;
+        IndexBuffer(IndexBuffer&& other) noexcept;
+        IndexBuffer& operator=(IndexBuffer&& other) noexcept;
+
+        // Writes count indices starting at index offset, growing the buffer if needed. The count
+        // becomes offset + count, so stale indices past the new data are never drawn
+        void SetData(const unsigned int* data, unsigned int count, unsigned int offset = 0);
+        // Grows to room for at least capacity indices (at least doubling), keeping the contents
+        void Reserve(unsigned int capacity);
+        // Draws use the first count indices, capped at the capacity
+        void SetCount(unsigned int count);
+
         void Bind() const;
         void Unbind() const;
 
         inline unsigned int GetCount() const { return m_Count; }
-};
\ No newline at end of file
+        inline unsigned int GetCapacity() const { return m_Capacity; }
+        inline unsigned int GetRendererID() const { return m_RendererID; }
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. Pages are only brought in by the OS when touched,
+// so files far larger than RAM can be opened and sampled
+class MappedFile
+{
+    private:
+        std::string m_FilePath;
+        const unsigned char* m_Data;
+        std::size_t m_Size;
+#ifdef _WIN32
+        void* m_FileHandle;
+        void* m_MappingHandle;
+#else
+        int m_FileDescriptor;
+#endif
+
+    public:
+        MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        inline bool IsOpen() const { return m_Data != nullptr; }
+        inline const unsigned char* GetData() const { return m_Data; }
+        inline std::size_t GetSize() const { return m_Size; }
+        inline const std::string& GetPath() const { return m_FilePath; }
+};
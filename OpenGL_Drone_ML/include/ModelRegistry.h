@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "Renderer.h"
+#include "VertexBuffer.h"
+#include "VertexFormat.h"
+
+// Per-instance attributes, bound after the mesh's own attributes (locations 4-8 for test::Vertex)
+struct InstanceData
+{
+    glm::mat4 model;
+    glm::vec4 color; // multiplies the vertex colour / texture
+
+    using Format = VertexFormat<Attr<float, 4>, Attr<float, 4>, Attr<float, 4>, Attr<float, 4>, Attr<float, 4>>;
+};
+static_assert(InstanceData::Format::Matches<InstanceData>(), "InstanceData is not tightly packed");
+
+// Meshes uploaded once and drawn with glDrawElementsInstanced, one draw per mesh no matter how
+// many copies are placed. Draw with res/shaders/Instanced.shader
+class ModelRegistry
+{
+    private:
+        struct Model
+        {
+            std::unique_ptr<VertexArray> va;
+            std::unique_ptr<VertexBuffer> vb;
+            std::unique_ptr<IndexBuffer> ib;
+            std::unique_ptr<VertexBuffer> instanceBuffer;
+            unsigned int attributeCount;  // per-vertex attributes, instance data starts here
+            std::vector<InstanceData> instances;
+            bool dirty;
+        };
+
+        std::vector<Model> m_Models;
+        std::unordered_map<std::string, unsigned int> m_Lookup;
+        unsigned int m_DrawCalls = 0;
+
+        void Upload(Model& model);
+
+    public:
+        // Returns the id of the mesh, adding it if the name is new
+        unsigned int AddModel(const std::string& name, const void* vertices, unsigned int vertexCount, unsigned int stride,
+            const std::vector<unsigned int>& indices, const VertexBufferLayout& layout);
+        bool HasModel(const std::string& name) const { return m_Lookup.find(name) != m_Lookup.end(); }
+        unsigned int GetModel(const std::string& name) const { return m_Lookup.at(name); }
+
+        void AddInstance(unsigned int model, const glm::mat4& transform, const glm::vec4& color = glm::vec4(1.0f));
+        void ClearInstances(unsigned int model);
+        inline unsigned int GetInstanceCount(unsigned int model) const { return (unsigned int)m_Models[model].instances.size(); }
+
+        // Uploads changed instance lists, then one instanced draw per mesh that has instances.
+        // The view-projection comes from the Camera block (FrameUniforms)
+        void Draw(const Renderer& renderer, Shader& shader);
+
+        inline unsigned int GetModelCount() const { return (unsigned int)m_Models.size(); }
+        inline unsigned int GetDrawCallCount() const { return m_DrawCalls; }
+};
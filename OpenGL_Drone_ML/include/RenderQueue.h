@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "FrameUniforms.h"
+#include "Renderer.h"
+#include "Texture.h"
+
+// Passes run in this order: Opaque front to back grouped by state, Transparent back to
+// front, UI in submission order with the depth test off
+enum class RenderPass : unsigned int
+{
+    Opaque = 0,
+    Transparent = 1,
+    UI = 2
+};
+
+struct DrawCommand
+{
+    const VertexArray* va;
+    const IndexBuffer* ib;
+    Shader* shader;
+    glm::mat4 mvp;                   // u_MVP, a uniform or part of the Object block
+    glm::mat4 model = glm::mat4(1.0f);
+    int material = -1;               // Object block only, material layer override
+    unsigned int count = 0;          // indices to draw, 0 for the whole buffer
+    unsigned int firstIndex = 0;     // range inside a shared buffer (BufferArena)
+    int baseVertex = 0;
+    unsigned int instanceCount = 0;  // 0 for a plain draw
+    unsigned int textureSet = 0;     // from AddTextureSet, 0 leaves bound textures alone
+};
+
+// Draws are submitted during OnRender and executed by Flush in the order of a 64 bit key
+// (pass | shader | textures | VAO | depth, see MakeKey), so state changes between neighbours
+// are as few as the scene allows no matter what order it was written in
+class RenderQueue
+{
+    private:
+        struct Entry
+        {
+            uint64_t key;
+            unsigned int command;
+        };
+
+        std::vector<DrawCommand> m_Commands;
+        std::vector<Entry> m_Entries, m_Scratch; // scratch is the radix sort's second buffer
+        std::vector<std::vector<const Texture*>> m_TextureSets;
+        std::vector<unsigned int> m_Objects; // per command, index in the FrameUniforms ring
+        unsigned int m_LastDrawCount = 0;
+
+        void Sort();
+
+    public:
+        RenderQueue();
+
+        // Textures bound to slots 0, 1, 2... before a command using the returned set
+        unsigned int AddTextureSet(const std::vector<const Texture*>& textures);
+
+        // depth is the distance from the camera, only its order matters
+        void Submit(RenderPass pass, const DrawCommand& command, float depth = 0.0f);
+
+        // Sorts and issues everything submitted since the last Flush, then empties the queue.
+        // With uniforms, programs that declare the Object block get their per-draw data from one
+        // upload and a glBindBufferRange instead of a u_MVP glUniform each
+        void Flush(const Renderer& renderer, FrameUniforms* uniforms = nullptr);
+
+        inline unsigned int GetSubmittedCount() const { return (unsigned int)m_Commands.size(); }
+        inline unsigned int GetLastDrawCount() const { return m_LastDrawCount; }
+
+        static uint64_t MakeKey(RenderPass pass, unsigned int shader, unsigned int textureSet, unsigned int vao, float depth);
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct GLFWwindow;
+
+// GL work recorded on the update thread to run later on the render thread. Commands capture
+// what they need, anything they reach through a pointer must not change until they have run
+class RenderCommandList
+{
+    private:
+        std::vector<std::function<void()>> m_Commands;
+
+    public:
+        inline void Record(std::function<void()> command) { m_Commands.push_back(std::move(command)); }
+
+        void Execute();
+        // Keeps the capacity, a frame records about as many commands as the last one
+        inline void Clear() { m_Commands.clear(); }
+
+        inline size_t GetCount() const { return m_Commands.size(); }
+};
+
+// Owns the window's GL context on a thread of its own and runs the lists the update thread
+// submits, then presents. There are two lists: one recording while the other executes, so the
+// update thread is at most one frame ahead. Update code must not touch GL, and anything a
+// command reads by reference must not change until the render thread has passed a handoff
+// (RecordHandoff / WaitForHandoff), typically recorded right after the scene is drawn so the
+// next update overlaps the UI, uploads and swap of the frame before.
+// GLFW events stay on the main thread, glfwSwapBuffers is allowed from any
+class RenderThread
+{
+    public:
+        struct Stats
+        {
+            float executeMs = 0.0f; // commands of the last list
+            float presentMs = 0.0f; // its swap, the vsync wait included
+            unsigned int commands = 0;
+        };
+
+        // Takes the context from the calling thread, which must have it current
+        RenderThread(GLFWwindow* window, int swapInterval);
+        // Finishes and hands the context back to the calling thread
+        ~RenderThread();
+
+        RenderThread(const RenderThread&) = delete;
+        RenderThread& operator=(const RenderThread&) = delete;
+
+        // The list being recorded, update thread only
+        inline RenderCommandList& GetList() { return m_Lists[m_Record]; }
+        // Hands the recorded list over, waiting for the one before to finish first
+        void Submit(bool present = true);
+        // Blocks until everything submitted has run
+        void Finish();
+
+        void RecordHandoff();
+        // Blocks until the render thread has run the last handoff recorded
+        void WaitForHandoff();
+
+        // Runs command on the render thread and waits for it
+        void Run(std::function<void()> command);
+        // Runs fn on the calling thread with the context moved over for it, for work that needs
+        // both GL and the main thread (a test constructor setting GLFW callbacks)
+        void Borrow(const std::function<void()>& fn);
+
+        Stats GetStats() const;
+
+    private:
+        GLFWwindow* m_Window;
+        int m_SwapInterval;
+        RenderCommandList m_Lists[2];
+        unsigned int m_Record;   // list the update thread records into, the other executes
+        bool m_Pending;          // the other list is submitted and not done yet
+        bool m_Present;
+        bool m_Stop;
+        unsigned int m_HandoffsRecorded, m_HandoffsDone;
+        Stats m_Stats;
+
+        std::thread m_Thread;
+        mutable std::mutex m_Mutex;
+        std::condition_variable m_Wake, m_Done;
+
+        void ThreadMain();
+};
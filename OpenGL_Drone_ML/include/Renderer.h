@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GLError.h"
+#include "GLState.h"
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
@@ -11,4 +12,18 @@ class Renderer
     public:
         void Clear() const;
         void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+        // Draws only the first count indices, for buffers that are not filled to capacity
+        void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int count) const;
+        // A range of a shared buffer: count indices from firstIndex, each offset by baseVertex
+        void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int count, unsigned int firstIndex, int baseVertex) const;
+        // Draws the whole mesh instanceCount times, per-instance attributes come from the VAO (divisor 1)
+        void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const;
+        // Several index ranges of the same buffers in one call, each range offset by its own base vertex
+        void DrawMulti(const VertexArray& va, const IndexBuffer& ib, const Shader& shader,
+            GLsizei* counts, void** offsets, GLint* baseVertices, unsigned int drawCount) const;
+        // Indices from the element buffer already bound to the VAO, starting indexOffset bytes in
+        // and offset by baseVertex, for geometry that moves around inside a StreamBuffer
+        void DrawBaseVertex(const VertexArray& va, const Shader& shader, unsigned int count, unsigned int indexOffset, int baseVertex) const;
+        // drawCount DrawElementsIndirectCommands read from the bound GL_DRAW_INDIRECT_BUFFER
+        void DrawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int drawCount) const;
 };
\ No newline at end of file
@@ -1,8 +1,23 @@
 #pragma once
+#include <memory>
+#include <sstream>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include "glm/glm.hpp"
-#include "GLerror.h"
+#include "GLError.h"
+
+// Injected as "#define <entry>" after the #version line of both stages, e.g. "UNTEXTURED"
+// or "TEXTURE_SLOT 2"
+using ShaderDefines = std::vector<std::string>;
+
+// A file together with the defines it is built with, as requested through Shader::Get
+struct ShaderPermutation
+{
+    std::string filepath;
+    ShaderDefines defines;
+};
 
 struct ShaderProgramSource
 {
@@ -10,30 +25,100 @@ struct ShaderProgramSource
     std::string FragmentSource;
 };
 
+// Active uniform found by reflection when the program is linked
+struct UniformInfo
+{
+    std::string name; // arrays without the trailing "[0]"
+    GLint location;
+    GLenum type;
+    GLint size;       // array length, 1 otherwise
+};
+
+// GL type a handle of T accepts, int handles also take samplers
+template<typename T> struct UniformType;
+template<> struct UniformType<int>       { static constexpr GLenum value = GL_INT; };
+template<> struct UniformType<float>     { static constexpr GLenum value = GL_FLOAT; };
+template<> struct UniformType<glm::vec2> { static constexpr GLenum value = GL_FLOAT_VEC2; };
+template<> struct UniformType<glm::vec3> { static constexpr GLenum value = GL_FLOAT_VEC3; };
+template<> struct UniformType<glm::vec4> { static constexpr GLenum value = GL_FLOAT_VEC4; };
+template<> struct UniformType<glm::mat4> { static constexpr GLenum value = GL_FLOAT_MAT4; };
+
+// Location resolved once with Shader::GetUniform, setting through it is a single glUniform
+// call with no lookup. An invalid handle (missing or mistyped uniform) sets nothing
+template<typename T>
+struct Uniform
+{
+    GLint location = -1;
+    inline bool IsValid() const { return location >= 0; }
+};
+
 class Shader
 {
     private:
         std::string m_FilePath;
         unsigned int m_RendererID;
-        mutable std::unordered_map<std::string, GLint> m_UniformLocationCache;
+        std::vector<UniformInfo> m_Uniforms; // sorted by name
+        mutable std::unordered_set<std::string> m_MissingUniforms; // already warned about
+        Uniform<glm::mat4> m_MVP;
+        bool m_HasObjectBlock;
 
     public:
-        Shader(const std::string& filepath);
+        Shader(const std::string& filepath, const ShaderDefines& defines = {});
         ~Shader();
 
+        // Shared permutation of filepath, built on first request and reused by every caller
+        // for as long as one of them holds it
+        static std::shared_ptr<Shader> Get(const std::string& filepath, const ShaderDefines& defines = {});
+
+        // Builds the binaries of every permutation the ShaderCache doesn't have yet, all compiled
+        // at once so a driver with parallel compilation can work on them side by side
+        static void Precompile(const std::vector<ShaderPermutation>& permutations);
+
         void Bind() const;
         void Unbind() const;
+        inline unsigned int GetRendererID() const { return m_RendererID; }
+        // Declares the per-draw "Object" uniform block instead of a u_MVP uniform
+        inline bool HasObjectBlock() const { return m_HasObjectBlock; }
+
+        // Resolve a handle once, typically in a constructor, and set through it every frame
+        template<typename T>
+        Uniform<T> GetUniform(const std::string& name) const
+        {
+            Uniform<T> uniform;
+            uniform.location = ResolveUniform(name, UniformType<T>::value);
+            return uniform;
+        }
+        // u_MVP, pre-resolved since nearly every draw sets it
+        inline Uniform<glm::mat4> GetMVPUniform() const { return m_MVP; }
+        inline const std::vector<UniformInfo>& GetUniforms() const { return m_Uniforms; }
 
-        // Set uniforms
+        void Set(Uniform<int> uniform, int value);
+        void Set(Uniform<int> uniform, int count, const int* values);
+        void Set(Uniform<float> uniform, float value);
+        void Set(Uniform<glm::vec2> uniform, const glm::vec2& value);
+        void Set(Uniform<glm::vec3> uniform, const glm::vec3& value);
+        void Set(Uniform<glm::vec4> uniform, const glm::vec4& value);
+        void Set(Uniform<glm::mat4> uniform, const glm::mat4& value);
+
+        // Set uniforms by name, a search of the reflected table per call
         void SetUniform1i(const std::string& name, int value);
         void SetUniform1iv(const std::string& name, int num, int values[]);
         void SetUniform1f(const std::string& name, float value);
+        void SetUniform2f(const std::string& name, float v0, float v1);
+        void SetUniform3f(const std::string& name, float v0, float v1, float v2);
         void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
         void SetUniformMat4f(const std::string& name, const glm::mat4& matrix);
 
     private:
-        ShaderProgramSource ParseShader(const std::string& filepath);
-        unsigned int CompileShader(unsigned int type, const std::string& source);
-        unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
+        static std::unordered_map<std::string, std::weak_ptr<Shader>> s_Permutations;
+
+        static ShaderProgramSource ParseShader(const std::string& filepath, const ShaderDefines& defines = {});
+        static bool AppendFile(const std::string& filepath, std::stringstream& out, unsigned int depth);
+        static unsigned int CompileShader(unsigned int type, const std::string& source);
+        static unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
+        static bool FinishProgram(unsigned int program, const std::string& filepath);
         GLint GetUniformLocation(const std::string& name) const;
+        GLint ResolveUniform(const std::string& name, GLenum type) const;
+        void Reflect();
+        void BindUniformBlocks();
 };
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "GLError.h"
+
+// Linked programs saved to disk with glGetProgramBinary. The key hashes both sources together
+// with the driver's vendor, renderer and version strings, so a driver update misses instead of
+// loading a stale binary. A hit links straight from the binary and skips compilation entirely,
+// a binary the driver rejects is deleted and the program rebuilt from source
+class ShaderCache
+{
+    public:
+        struct Stats
+        {
+            unsigned int hits = 0;        // programs loaded from a binary
+            unsigned int misses = 0;      // Shaders compiled from source
+            unsigned int precompiled = 0; // compiled ahead by Shader::Precompile, a hit once used
+            unsigned int rejected = 0;    // binaries the driver refused
+        };
+
+        // After glewInit. Also lets the driver compile on its own threads when it offers
+        // KHR/ARB_parallel_shader_compile
+        static void Init(const std::string& directory = "res/shaders/cache");
+
+        static uint64_t Key(const std::string& vertexSource, const std::string& fragmentSource);
+        // A linked program, or 0 when there is no usable binary for key
+        static unsigned int Load(uint64_t key);
+        // program must be linked, and was ideally created after PrepareProgram
+        static void Store(uint64_t key, unsigned int program);
+        // Before linking a program that will be stored
+        static void PrepareProgram(unsigned int program);
+        // Counts a program built from source
+        static void OnCompiled(bool precompiled);
+
+        // Has the binary been written already, without loading it
+        static bool Contains(uint64_t key);
+
+        inline static bool IsSupported() { return s_Supported; }
+        inline static bool IsParallel() { return s_Parallel; }
+        inline static const Stats& GetStats() { return s_Stats; }
+
+    private:
+        static std::string s_Directory;
+        static uint64_t s_DriverHash;
+        static bool s_Supported;
+        static bool s_Parallel;
+        static Stats s_Stats;
+
+        static std::string PathFor(uint64_t key);
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "Frustum.h"
+#include "Renderer.h"
+#include "VertexBuffer.h"
+
+// Many static meshes with the same vertex format packed into one vertex and one index buffer
+// and drawn with a single glMultiDrawElementsBaseVertex, or glMultiDrawElementsIndirect when
+// ARB_multi_draw_indirect is available. Every vertex also carries its mesh's row in a
+// transform table kept in a buffer texture, so meshes keep their own model matrix without a
+// uniform per draw. Draw with res/shaders/Batched.shader
+class StaticBatch
+{
+    private:
+        struct Mesh
+        {
+            unsigned int firstIndex, indexCount;
+            int baseVertex;
+            AABB localBounds;
+            AABB bounds; // world, follows the transform
+        };
+
+        // Matches the layout glMultiDrawElementsIndirect reads
+        struct IndirectCommand
+        {
+            unsigned int count, instanceCount, firstIndex;
+            int baseVertex;
+            unsigned int baseInstance;
+        };
+
+        unsigned int m_Stride;
+        VertexBufferLayout m_Layout;
+        // CPU copies until Build uploads them
+        std::vector<unsigned char> m_Vertices;
+        std::vector<unsigned int> m_Indices;
+        std::vector<float> m_DrawIDs;
+
+        std::vector<Mesh> m_Meshes;
+        std::vector<glm::mat4> m_Transforms;
+        unsigned int m_DirtyBegin, m_DirtyEnd; // transform rows to re-upload
+
+        std::unique_ptr<VertexArray> m_VAO;
+        std::unique_ptr<VertexBuffer> m_VertexBuffer;
+        std::unique_ptr<VertexBuffer> m_DrawIDBuffer;
+        std::unique_ptr<IndexBuffer> m_IndexBuffer;
+        unsigned int m_TransformBuffer; // buffer holding the table
+        unsigned int m_RendererID;      // buffer texture reading it as RGBA32F
+        unsigned int m_IndirectBuffer;  // 0 when drawing with glMultiDrawElementsBaseVertex
+
+        // rebuilt every Draw from the meshes that survive culling
+        std::vector<GLsizei> m_Counts;
+        std::vector<void*> m_Offsets;
+        std::vector<GLint> m_BaseVertices;
+        std::vector<IndirectCommand> m_Commands;
+        unsigned int m_VisibleCount;
+        unsigned int m_UniformProgram = 0; // program m_TransformsUniform was resolved in
+        Uniform<int> m_TransformsUniform;
+
+        void UploadTransforms();
+
+    public:
+        static const unsigned int TRANSFORM_SLOT = 1; // after the u_Materials array on unit 0
+
+        // layout describes one vertex of stride bytes, the draw id follows as the next attribute
+        StaticBatch(unsigned int stride, const VertexBufferLayout& layout);
+        ~StaticBatch();
+
+        StaticBatch(const StaticBatch&) = delete;
+        StaticBatch& operator=(const StaticBatch&) = delete;
+
+        // Copies the mesh into the batch, positions are read from the first 3 floats of every vertex.
+        // Returns the id used for SetTransform. Only valid before Build
+        unsigned int AddMesh(const void* vertices, unsigned int vertexCount, const std::vector<unsigned int>& indices,
+            const glm::mat4& transform = glm::mat4(1.0f));
+        // Uploads everything added so far and frees the CPU copies
+        void Build();
+
+        void SetTransform(unsigned int mesh, const glm::mat4& transform);
+
+        // Culls per mesh against viewProj and draws what is left in one call, the shader takes its
+        // view-projection from the Camera block (FrameUniforms). Returns the number of meshes drawn
+        unsigned int Draw(const Renderer& renderer, Shader& shader, const glm::mat4& viewProj);
+
+        inline unsigned int GetMeshCount() const { return (unsigned int)m_Meshes.size(); }
+        inline unsigned int GetVisibleCount() const { return m_VisibleCount; }
+        inline bool IsIndirect() const { return m_IndirectBuffer != 0; }
+};
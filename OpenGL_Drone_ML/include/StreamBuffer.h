@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+
+#include "GLError.h"
+
+// One buffer split in FRAMES regions that are written in turn, for data the CPU rewrites while
+// the GPU may still be drawing an older copy. On GL 4.4 / ARB_buffer_storage it is mapped once,
+// persistently and coherently, and a fence per region makes a write wait only if the GPU is
+// still reading that region. On 3.3 the storage is orphaned with glBufferData each time the
+// ring wraps and regions are written with glBufferSubData.
+// Writes identical to the previous one are skipped, so callers can write every frame
+class StreamBuffer
+{
+    public:
+        struct Stats
+        {
+            unsigned int writes = 0;   // regions written
+            unsigned int skipped = 0;  // writes dropped as unchanged
+            unsigned int stalls = 0;   // writes that had to wait on the GPU
+            size_t bytes = 0;          // uploaded
+        };
+
+        static constexpr unsigned int FRAMES = 3;
+
+        // target is where the buffer is used from (GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER...),
+        // regionSize the largest write expected, a larger one grows the buffer
+        StreamBuffer(GLenum target, unsigned int regionSize);
+        ~StreamBuffer();
+
+        StreamBuffer(const StreamBuffer&) = delete;
+        StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+        // Copies data into the next region unless it matches the last write. Returns true when
+        // something was written; either way GetOffset() is where the current data starts.
+        // Growing replaces the buffer, so GetRendererID() changes
+        bool Write(const void* data, unsigned int size);
+        // After the draws that read the current region, so a later Write knows when it is free
+        void Fence();
+
+        void Bind() const;
+
+        inline unsigned int GetRendererID() const { return m_RendererID; }
+        inline unsigned int GetOffset() const { return m_Region * m_RegionSize; }
+        inline unsigned int GetSize() const { return m_Size; } // of the current data
+        inline bool IsPersistent() const { return m_Mapped != nullptr; }
+
+        // Totals of every stream buffer, NewFrame returns last frame's and starts counting again
+        static Stats NewFrame();
+        static const Stats& GetFrameStats() { return s_LastFrame; }
+
+    private:
+        GLenum m_Target;
+        unsigned int m_RendererID;
+        unsigned int m_RegionSize;
+        unsigned int m_Region;
+        unsigned int m_Size;
+        unsigned char* m_Mapped;        // persistent mapping, null on the orphaning path
+        GLsync m_Fences[FRAMES];
+        std::vector<unsigned char> m_Last; // copy of the current data for change detection
+
+        static Stats s_Frame, s_LastFrame;
+
+        void Allocate();
+        void Release();
+        void WaitForRegion(unsigned int region);
+};
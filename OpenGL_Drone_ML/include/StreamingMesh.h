@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+
+#include "Renderer.h"
+#include "StreamBuffer.h"
+#include "VertexBufferLayout.h"
+
+// Indexed geometry rebuilt on the CPU and drawn from StreamBuffers, for things like the pickup
+// zones that change at runtime. Indices stay local to the mesh, the draw adds the region's
+// base vertex. Updating with the same data as last time uploads nothing
+class StreamingMesh
+{
+    private:
+        unsigned int m_Stride;
+        VertexBufferLayout m_Layout;
+        std::unique_ptr<VertexArray> m_VAO;
+        std::unique_ptr<StreamBuffer> m_Vertices;
+        std::unique_ptr<StreamBuffer> m_Indices;
+        unsigned int m_VertexBufferID; // the buffer m_VAO's attributes point at
+        unsigned int m_IndexCount;
+
+    public:
+        // Sizes are the expected maximum, the buffers grow past them if needed
+        StreamingMesh(unsigned int stride, const VertexBufferLayout& layout, unsigned int maxVertices, unsigned int maxIndices);
+
+        // Returns true if anything had to be uploaded
+        bool Update(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+        void Draw(const Renderer& renderer, const Shader& shader);
+
+        inline unsigned int GetIndexCount() const { return m_IndexCount; }
+};
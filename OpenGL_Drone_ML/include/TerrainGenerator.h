@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+#include "TileFile.h"
+#include "VertexFormat.h"
+
+// Vertex written by generated terrain, same attribute layout Basic2.shader expects
+struct TerrainVertex
+{
+    float x, y, z;
+    float r, g, b;
+    float u, v;
+    float texSlot;
+
+    using Format = VertexFormat<Attr<float, 3>, Attr<float, 3>, Attr<float, 2>, Attr<float, 1>>;
+};
+static_assert(TerrainVertex::Format::Matches<TerrainVertex>(), "TerrainVertex is not tightly packed");
+
+// Vertex colour for terrain: grass -> rock on slopes -> snow on peaks, lit by a fixed sun.
+// t is the height normalised over the terrain's range
+glm::vec3 TerrainColor(float t, const glm::vec3& normal);
+
+struct TerrainNoiseSettings
+{
+    std::uint32_t seed = 1337;
+    int octaves = 6;
+    float frequency = 1.0f / 900.0f; // first octave features per world unit
+    float lacunarity = 2.0f;
+    float gain = 0.5f;
+    float ridged = 0.35f;            // 0 = plain fBm, 1 = fully ridged
+    float erosion = 0.6f;            // damps detail on steep slopes, 0 disables
+    float heightScale = 350.0f;
+};
+
+// Deterministic heightfield terrain built from value noise fBm. Every sample is a pure function
+// of (seed, world position) so tiles can be generated in any order, on any thread, and still
+// share identical borders. Rows of samples are evaluated 4 at a time with SSE2 where available.
+class TerrainGenerator : public TileSource
+{
+    private:
+        TerrainNoiseSettings m_Settings;
+        float m_TileSize;
+        unsigned int m_Resolution; // quads per tile side
+
+    public:
+        TerrainGenerator(const TerrainNoiseSettings& settings, float tileSize = 256.0f, unsigned int resolution = 64);
+
+        // Height at a world position, usable for collision anywhere, resident or not
+        float Height(float x, float z) const;
+        // Heights at sample points (sampleX + i) * spacing, sampleZ * spacing for i < count
+        void HeightRow(int sampleX, int sampleZ, float spacing, unsigned int count, float* out) const;
+
+        bool HasTile(int /*gridX*/, int /*gridZ*/) const override { return true; } // endless
+        bool LoadTile(int gridX, int gridZ, TerrainTile& out) const override;
+
+        float GetTileSize() const override { return m_TileSize; }
+        unsigned int GetStride() const override { return sizeof(TerrainVertex); }
+        unsigned int GetMaxVertexCount() const override { return (m_Resolution + 1) * (m_Resolution + 1); }
+        unsigned int GetMaxIndexCount() const override { return m_Resolution * m_Resolution * 6; }
+
+        inline const TerrainNoiseSettings& GetSettings() const { return m_Settings; }
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Frustum.h"
+#include "Renderer.h"
+#include "TileFile.h"
+
+// Out-of-core terrain. Tiles around the focus points (drone, camera) are paged in from a
+// TileSource by background I/O threads and uploaded into a fixed pool of GPU buffers.
+// When the pool is full the least recently wanted, furthest tile is evicted. Collision
+// data lives and dies with the GPU copy so ray casts only see resident tiles.
+class TerrainStreamer
+{
+    private:
+        struct Slot
+        {
+            std::unique_ptr<VertexArray> va;
+            std::unique_ptr<VertexBuffer> vb;
+            std::unique_ptr<IndexBuffer> ib;
+            bool resident = false;
+            int gridX = 0, gridZ = 0;
+            AABB bounds;
+            std::uint64_t lastUsedFrame = 0;
+            std::vector<glm::vec3> triangles; // collision soup, 3 points per triangle
+        };
+
+        struct LoadedTile
+        {
+            TerrainTile tile;
+            std::vector<glm::vec3> triangles;
+        };
+
+        std::unique_ptr<TileSource> m_Source;
+        std::vector<Slot> m_Slots;
+        std::unordered_map<std::int64_t, unsigned int> m_Resident; // grid coords -> slot
+        std::unordered_set<std::int64_t> m_Desired;
+        std::vector<glm::vec3> m_FocusPoints;
+        float m_LoadRadius;
+        unsigned int m_UploadBudget; // tiles uploaded per Update at most
+        std::uint64_t m_Frame;
+
+        // shared with the I/O threads
+        std::vector<std::thread> m_Workers;
+        std::mutex m_Mutex;
+        std::condition_variable m_cv;
+        std::deque<std::int64_t> m_Requests;       // closest first
+        std::unordered_set<std::int64_t> m_Loading; // taken by a worker, not yet consumed
+        std::queue<LoadedTile> m_Loaded;
+        bool m_Stop;
+
+        // stats
+        unsigned int m_UploadsLastFrame;
+        std::size_t m_BytesUploadedLastFrame;
+        unsigned int m_Evictions;
+        unsigned int m_VisibleCount;
+
+    public:
+        // A source whose stride is not the layout's gets an empty pool and streams nothing
+        TerrainStreamer(std::unique_ptr<TileSource> source, const VertexBufferLayout& layout,
+            unsigned int poolSize, float loadRadius, unsigned int workerCount = 1);
+        ~TerrainStreamer();
+
+        // Main thread, once per frame: uploads finished tiles and re-prioritises requests
+        void Update(const std::vector<glm::vec3>& focusPoints);
+        // Draws resident tiles inside the frustum, returns how many were drawn
+        unsigned int Draw(const Renderer& renderer, const Shader& shader, const glm::mat4& viewProj);
+        // Closest hit against resident tiles only
+        bool Raycast(const glm::vec3& origin, const glm::vec3& dir, float& outT) const;
+
+        inline void SetLoadRadius(float radius) { m_LoadRadius = radius; }
+        inline float GetLoadRadius() const { return m_LoadRadius; }
+        inline void SetUploadBudget(unsigned int tiles) { m_UploadBudget = tiles; }
+        inline const TileSource& GetSource() const { return *m_Source; }
+
+        inline unsigned int GetPoolSize() const { return m_Slots.size(); }
+        inline unsigned int GetResidentCount() const { return m_Resident.size(); }
+        inline unsigned int GetVisibleCount() const { return m_VisibleCount; }
+        inline unsigned int GetUploadsLastFrame() const { return m_UploadsLastFrame; }
+        inline std::size_t GetBytesUploadedLastFrame() const { return m_BytesUploadedLastFrame; }
+        inline unsigned int GetEvictionCount() const { return m_Evictions; }
+        unsigned int GetPendingCount();
+
+    private:
+        void WorkerThreadFunc();
+        void Upload(LoadedTile& loaded);
+        int FindSlotForUpload() const;
+        float DistanceToFocus(const AABB& bounds) const;
+};
@@ -1,22 +1,35 @@
 #pragma once
 
+#include <memory>
+
 #include "Renderer.h"
+#include "TextureLoader.h"
 
+// An image file on the GPU with a full mip chain. Loading is asynchronous, the texture is grey
+// until the image is decoded and uploaded, its GL name stays the same so it can be bound once
 class Texture
 {
     private:
         unsigned int m_RendererID;
         std::string m_FilePath;
-        unsigned char* m_LocalBuffer;
         int m_Width, m_Height, m_BPP; // bytes per pixel
+        std::shared_ptr<TextureLoader::Job> m_Job; // until loaded
+
+        friend class TextureLoader;
+        void OnLoaded(int width, int height);
 
     public:
         Texture(const std::string& path);
         ~Texture();
 
+        Texture(const Texture&) = delete;
+        Texture& operator=(const Texture&) = delete;
+
         void Bind(unsigned int slot = 0) const; // 32 texture slots typical
         void Unbind() const;
 
+        inline bool IsLoaded() const { return m_Width > 0; }
+        // Zero until loaded
         inline int GetWidth() const { return m_Width; }
         inline int GetHeight() const { return m_Height; }
-};
\ No newline at end of file
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GLError.h"
+#include "TextureLoader.h"
+
+// Images of one size as the layers of a GL_TEXTURE_2D_ARRAY, so a vertex picks its material
+// by layer (Material.glsl) and every material is one bind on one slot. Files load through
+// TextureLoader and are scaled to the layer size, a layer is grey until its image is in.
+// Stored as BC3 with the mips built on the CPU when TextureCache is supported, RGBA8 otherwise
+class TextureArray
+{
+    private:
+        unsigned int m_RendererID;
+        int m_Width, m_Height, m_Layers;
+        GLenum m_Format; // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT or 0 for RGBA8
+        std::vector<std::shared_ptr<TextureLoader::Job>> m_Jobs;
+        unsigned int m_Pending;
+
+        friend class TextureLoader;
+        void OnLayerLoaded(int layer);
+
+    public:
+        TextureArray(int width, int height, int layers);
+        ~TextureArray();
+
+        TextureArray(const TextureArray&) = delete;
+        TextureArray& operator=(const TextureArray&) = delete;
+
+        // Loads the file into layer in the background
+        void Load(int layer, const std::string& path);
+        // Uploads RGBA8 pixels, bottom row first, into layer now
+        void SetLayer(int layer, const unsigned char* pixels, int width, int height);
+
+        void Bind(unsigned int slot = 0) const;
+
+        inline bool IsLoaded() const { return m_Pending == 0; }
+        inline bool IsCompressed() const { return m_Format != 0; }
+        inline unsigned int GetRendererID() const { return m_RendererID; }
+        inline int GetWidth() const { return m_Width; }
+        inline int GetHeight() const { return m_Height; }
+        inline int GetLayerCount() const { return m_Layers; }
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+// Packs small images (buttons, icons) into one square RGBA8 image, row by row on shelves, so
+// they share a single texture or TextureArray layer. Each image gets a border of its own edge
+// texels so filtering and the lower mips do not bleed in from its neighbours. Images are
+// decoded on the spot, this is for UI sized images at scene setup
+class TextureAtlas
+{
+    private:
+        int m_Size, m_Padding;
+        std::vector<unsigned char> m_Pixels; // bottom row first like GL
+        int m_ShelfX, m_ShelfY, m_ShelfHeight;
+        std::unordered_map<std::string, glm::vec4> m_Rects;
+
+    public:
+        TextureAtlas(int size, int padding = 4);
+
+        // The image is scaled down to fit maxSize texels on its longer side. False if it could
+        // not be decoded or there is no room left
+        bool Add(const std::string& name, const std::string& path, int maxSize);
+        bool Add(const std::string& name, const unsigned char* pixels, int width, int height);
+
+        // Offset in xy and scale in zw, in atlas UVs: atlasUV = rect.xy + uv * rect.zw.
+        // The whole atlas for a name that was never added
+        glm::vec4 GetRect(const std::string& name) const;
+
+        inline const unsigned char* GetPixels() const { return m_Pixels.data(); }
+        inline int GetSize() const { return m_Size; }
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GLError.h"
+#include "MappedFile.h"
+
+// A block compressed image with its whole mip chain, either built in memory or mapped
+// straight from a cache file
+struct CompressedImage
+{
+    struct Level
+    {
+        int width, height;
+        uint64_t offset, size; // into GetData()
+    };
+
+    GLenum format = 0; // GL_COMPRESSED_RGB_S3TC_DXT1_EXT (BC1) or GL_COMPRESSED_RGBA_S3TC_DXT5_EXT (BC3)
+    std::vector<Level> levels;
+    std::vector<unsigned char> data;
+    std::unique_ptr<MappedFile> file; // data lives here instead when loaded from the cache
+    uint64_t dataOffset = 0;          // of the first level inside file
+
+    inline const unsigned char* GetData() const { return file ? file->GetData() + dataOffset : data.data(); }
+    inline size_t GetSize() const { return levels.empty() ? 0 : (size_t)(levels.back().offset + levels.back().size); }
+};
+
+// Images converted once to BC1 (opaque) or BC3 (with alpha) with a full mip chain and kept
+// under res/textures/cache, so later runs skip PNG decoding and upload a quarter to an eighth
+// of the bytes with glCompressedTexImage. The key covers the source's path, size and write
+// time and the requested size, editing or replacing an image converts it again. Everything
+// but Init is safe to call from TextureLoader's workers
+class TextureCache
+{
+    public:
+        struct Stats
+        {
+            std::atomic<unsigned int> hits{0};      // images mapped from the cache
+            std::atomic<unsigned int> converted{0}; // images decoded, compressed and stored
+            std::atomic<unsigned int> rejected{0};  // cache files that failed validation
+        };
+
+        // After glewInit, without S3TC support every texture stays uncompressed
+        static void Init(const std::string& directory = "res/textures/cache");
+
+        // path compressed at width x height (0 keeps its size). BC3 if forceAlpha or the image
+        // has any transparency, BC1 otherwise. False if the image can't be decoded, reason
+        // then says why
+        static bool Get(const std::string& path, int width, int height, bool forceAlpha, CompressedImage& image,
+            const char** reason = nullptr);
+
+        // RGBA8, bottom row first, into format with mips down to 1x1
+        static void Compress(const unsigned char* pixels, int width, int height, GLenum format, CompressedImage& image);
+
+        static int LevelCount(int width, int height);
+        static size_t LevelSize(GLenum format, int width, int height);
+
+        inline static bool IsSupported() { return s_Supported; }
+        inline static const Stats& GetStats() { return s_Stats; }
+
+    private:
+        static std::string s_Directory;
+        static bool s_Supported;
+        static Stats s_Stats;
+
+        static bool Load(const std::string& cachePath, uint64_t key, CompressedImage& image);
+        static void Store(const std::string& cachePath, uint64_t key, const CompressedImage& image);
+};
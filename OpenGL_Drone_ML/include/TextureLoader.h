@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GLError.h"
+#include "TextureCache.h"
+
+class Texture;
+class TextureArray;
+
+// Decodes image files on worker threads and uploads them from the GL thread at most
+// UPLOAD_BUDGET bytes a frame through a pixel unpack buffer, so a scene starts with its
+// textures still streaming in. Until the last row is in and the mip chain is built a texture
+// samples a 1x1 grey level of its own, a TextureArray layer stays grey. With S3TC support
+// images come block compressed from TextureCache and go up a whole mip level at a time
+class TextureLoader
+{
+    public:
+        static constexpr size_t UPLOAD_BUDGET = 4 << 20;
+
+        struct Job
+        {
+            std::string path;
+            Texture* texture = nullptr;      // GL thread only, the owner, null once it is gone
+            TextureArray* array = nullptr;   // or the array whose layer this fills
+            int layer = 0;
+            int targetWidth = 0, targetHeight = 0; // scaled to this on the worker, 0 keeps the size
+            unsigned char* pixels = nullptr; // RGBA8 rows bottom up, null if decoding failed
+            const char* failure = nullptr;   // stb_image keeps its reason per thread
+            std::vector<unsigned char> scaled; // pixels points here once scaled
+            int width = 0, height = 0;
+            unsigned int rendererID = 0;     // GL thread only, the texture's name, filled in place
+            int uploadedRows = 0;
+            bool compress = false;           // through TextureCache, pixels then stays null
+            bool forceAlpha = false;         // BC3 even for an opaque image
+            CompressedImage image;
+            int uploadedLevels = 0;
+        };
+
+        // Queues path for decoding, texture is told through OnLoaded once it is on the GPU
+        static std::shared_ptr<Job> Load(const std::string& path, Texture* texture);
+        // Into one layer of array, scaled to the array's size
+        static std::shared_ptr<Job> Load(const std::string& path, TextureArray* array, int layer);
+
+        // Call once a frame on the GL thread
+        static void Update();
+        // Blocks until everything queued is on the GPU, for runs that need every texel
+        static void Finish();
+
+        // A 2D texture showing a grey texel, Load fills it in place so its name never changes
+        static unsigned int CreateTexture();
+        static unsigned int GetPendingCount() { return s_Pending; }
+
+        // RGBA8, bilinear when enlarging and averaging the covered texels when shrinking
+        static void Resample(const unsigned char* source, int sourceWidth, int sourceHeight,
+            unsigned char* destination, int width, int height);
+
+        // Stops the workers and deletes the loader's GL objects, the context must still exist
+        static void Shutdown();
+
+    private:
+        static std::vector<std::thread> s_Workers;
+        static std::mutex s_Mutex;
+        static std::condition_variable s_Wake;
+        static std::deque<std::shared_ptr<Job>> s_Queue;   // waiting for a worker
+        static std::vector<std::shared_ptr<Job>> s_Decoded; // decoded, not yet seen by Update
+        static bool s_Stop;
+
+        static std::deque<std::shared_ptr<Job>> s_Uploads; // GL thread only
+        static std::atomic<unsigned int> s_Pending;
+        static unsigned int s_PixelBuffer;
+
+        static std::shared_ptr<Job> Queue(std::shared_ptr<Job> job);
+        static void StartWorkers();
+        static void WorkerMain();
+        static bool IsDecoded(const Job& job) { return job.pixels || !job.image.levels.empty(); }
+        static const void* Stage(const unsigned char* source, size_t size);
+        static size_t Upload(Job& job, size_t budget);
+        static size_t UploadCompressed(Job& job, size_t budget);
+        static void Release(Job& job);
+};
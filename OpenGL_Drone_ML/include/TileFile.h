@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ChunkedMesh.h"
+#include "MappedFile.h"
+
+// One terrain tile as handed from a TileSource to the streamer
+struct TerrainTile
+{
+    int gridX, gridZ;
+    AABB bounds;
+    std::vector<unsigned char> vertices; // raw vertex bytes, stride given by the source
+    std::vector<unsigned int> indices;
+};
+
+// Anything that can produce terrain tiles on demand. LoadTile is called from the streamer's
+// I/O thread so implementations must be safe to call concurrently with the render thread
+class TileSource
+{
+    public:
+        virtual ~TileSource() {}
+
+        virtual bool HasTile(int gridX, int gridZ) const = 0;
+        virtual bool LoadTile(int gridX, int gridZ, TerrainTile& out) const = 0;
+
+        virtual float GetTileSize() const = 0;
+        virtual unsigned int GetStride() const = 0;
+        // Upper bounds used to size the streamer's fixed GPU buffer pool
+        virtual unsigned int GetMaxVertexCount() const = 0;
+        virtual unsigned int GetMaxIndexCount() const = 0;
+};
+
+// Memory mapped on-disk tile set (.tiles). Layout:
+//   TileFileHeader | TileRecord[tileCount] | vertex / index blocks (16 byte aligned)
+class TileFile : public TileSource
+{
+    public:
+        struct TileFileHeader
+        {
+            char magic[4];          // "DTIL"
+            std::uint32_t version;
+            std::uint32_t stride;
+            std::uint32_t tileCount;
+            float tileSize;
+            std::uint32_t maxVertexCount;
+            std::uint32_t maxIndexCount;
+            std::uint32_t reserved;
+            std::uint64_t sourceKey; // whatever the baker hashed its inputs to, 0 if nothing
+        };
+
+        struct TileRecord
+        {
+            std::int32_t gridX, gridZ;
+            float boundsMin[3];
+            float boundsMax[3];
+            std::uint64_t vertexOffset;
+            std::uint64_t indexOffset;
+            std::uint32_t vertexCount;
+            std::uint32_t indexCount;
+        };
+
+    private:
+        std::unique_ptr<MappedFile> m_File;
+        const TileFileHeader* m_Header;
+        const TileRecord* m_Records;
+        std::unordered_map<std::int64_t, unsigned int> m_Lookup; // packed grid coords -> record
+
+    public:
+        TileFile(const std::string& path);
+
+        inline bool IsOpen() const { return m_Header != nullptr; }
+        inline unsigned int GetTileCount() const { return m_Header ? m_Header->tileCount : 0; }
+        inline std::uint64_t GetSourceKey() const { return m_Header ? m_Header->sourceKey : 0; }
+
+        bool HasTile(int gridX, int gridZ) const override;
+        bool LoadTile(int gridX, int gridZ, TerrainTile& out) const override;
+
+        float GetTileSize() const override { return m_Header->tileSize; }
+        unsigned int GetStride() const override { return m_Header->stride; }
+        unsigned int GetMaxVertexCount() const override { return m_Header->maxVertexCount; }
+        unsigned int GetMaxIndexCount() const override { return m_Header->maxIndexCount; }
+
+        // Partitions a mesh into tileSize chunks and writes them out as a tile file
+        // sourceKey is stored so a cache can tell when its inputs changed
+        static bool Bake(const std::string& path, const void* vertices, unsigned int vertexCount, unsigned int stride,
+            const std::vector<unsigned int>& indices, float tileSize, std::uint64_t sourceKey = 0);
+        static bool Write(const std::string& path, const std::vector<MeshChunk>& chunks, unsigned int stride, float tileSize,
+            std::uint64_t sourceKey = 0);
+
+        static inline std::int64_t PackCoords(int gridX, int gridZ)
+        {
+            return ((std::int64_t)gridX << 32) | (std::uint32_t)gridZ;
+        }
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+// Binding points shared by every program, Shader connects blocks with these names on link
+enum UniformBinding : unsigned int
+{
+    CameraBinding = 0, // "Camera", see FrameUniforms.h
+    ObjectBinding = 1  // "Object"
+};
+
+// m_RendererID keeps track of object / buffer IDs
+class UniformBuffer
+{
+    private:
+        unsigned int m_RendererID;
+        unsigned int m_Size;
+    public:
+        UniformBuffer(unsigned int size);
+        ~UniformBuffer();
+
+        UniformBuffer(const UniformBuffer&) = delete;
+        UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+        void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+        // Reallocates, the old contents are lost
+        void Resize(unsigned int size);
+
+        void BindBase(unsigned int binding) const;
+        // offset must be a multiple of GetOffsetAlignment()
+        void BindRange(unsigned int binding, unsigned int offset, unsigned int size) const;
+
+        inline unsigned int GetSize() const { return m_Size; }
+
+        // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, 256 on most desktop drivers
+        static unsigned int GetOffsetAlignment();
+};
@@ -3,15 +3,24 @@
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 
+class StreamBuffer;
+
 class VertexArray
 {
     private:
         unsigned int m_RendererID;
+
+        // Points the attributes at whatever GL_ARRAY_BUFFER is bound
+        void SetAttributes(const VertexBufferLayout& layout, unsigned int firstAttribute, unsigned int divisor);
     public:
         VertexArray();
         ~VertexArray();
 
-        void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+        // firstAttribute lets a second buffer follow the per-vertex attributes, a non-zero divisor
+        // advances the attributes once per instance instead of once per vertex
+        void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int firstAttribute = 0, unsigned int divisor = 0);
+        void AddBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout, unsigned int firstAttribute = 0, unsigned int divisor = 0);
         void Bind() const;
         void Unbind() const;
+        inline unsigned int GetRendererID() const { return m_RendererID; }
 };
\ No newline at end of file
@@ -1,15 +1,39 @@
 #pragma once
 
+// Gives buffer a new data store of newSize bytes that starts with the first keepSize bytes of
+// the old one, shared by the growable buffers
+void ReallocateBuffer(unsigned int buffer, unsigned int newSize, unsigned int keepSize, unsigned int usage);
+
 // m_RendererID keeps track of object / buffer IDs
 class VertexBuffer
 {
     private:
         unsigned int m_RendererID;
+        unsigned int m_Size;     // bytes allocated
+        unsigned int m_Usage;    // GL_STATIC_DRAW or GL_DYNAMIC_DRAW
+
+        void Release();
     public:
         VertexBuffer(const void* data, unsigned int size);
+        // Empty dynamic buffer of size bytes, filled with SetData
         VertexBuffer(unsigned int size);
         ~VertexBuffer();
 
+        // Moving hands over the GL buffer, a copy would delete it twice
+        VertexBuffer(const VertexBuffer&) = delete;
+        VertexBuffer& operator=(const VertexBuffer&) = delete;
+        VertexBuffer(VertexBuffer&& other) noexcept;
+        VertexBuffer& operator=(VertexBuffer&& other) noexcept;
+
+        // Writes size bytes at offset, growing the buffer first if they don't fit
+        void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+        // Grows to at least size bytes (at least doubling) and keeps the contents. The GL name
+        // stays the same, so VAOs reading the buffer need no AddBuffer again
+        void Reserve(unsigned int size);
+
         void Bind() const;
         void Unbind() const;
-};
\ No newline at end of file
+
+        inline unsigned int GetSize() const { return m_Size; }
+        inline unsigned int GetRendererID() const { return m_RendererID; }
+};
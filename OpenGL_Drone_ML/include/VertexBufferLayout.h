@@ -35,7 +35,15 @@ class VertexBufferLayout
         template<typename T>
         void Push(unsigned int count)
         {
-            static_assert(false);
+            // dependent on T so it only fires for unsupported types (static_assert(false) is ill-formed)
+            static_assert(sizeof(T) == 0, "unsupported vertex attribute type");
+        }
+
+        // Untyped push used by VertexFormat::Layout()
+        void Push(unsigned int type, unsigned int count, unsigned char normalized)
+        {
+            m_Elements.push_back({ type, count, normalized });
+            m_Stride += count * VertexBufferElement::GetSizeOfType(type);
         }
 
         inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
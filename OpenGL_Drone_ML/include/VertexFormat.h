@@ -0,0 +1,131 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <GL/glew.h>
+#include "VertexBufferLayout.h"
+
+// Maps a C++ component type onto the matching GL enum at compile time
+template<typename T> struct GLTypeOf;
+template<> struct GLTypeOf<float>         { static constexpr unsigned int value = GL_FLOAT; };
+template<> struct GLTypeOf<unsigned int>  { static constexpr unsigned int value = GL_UNSIGNED_INT; };
+template<> struct GLTypeOf<unsigned char> { static constexpr unsigned int value = GL_UNSIGNED_BYTE; };
+
+// One vertex attribute: Count components of type T (e.g. Attr<float, 3> for a position)
+template<typename T, unsigned int Count, bool Normalized = false>
+struct Attr
+{
+    using Type = T;
+    static constexpr unsigned int count = Count;
+    static constexpr unsigned int size = Count * sizeof(T);
+    static constexpr unsigned int type = GLTypeOf<T>::value;
+    static constexpr unsigned char normalized = Normalized ? GL_TRUE : GL_FALSE;
+};
+
+// Compile-time vertex description. Stride, offsets and GL types are all derived from the
+// attribute list so a vertex struct only has to be described once:
+//     using Format = VertexFormat<Attr<float, 3>, Attr<float, 2>>;
+//     static_assert(Format::Matches<MyVertex>());
+//     va.AddBuffer(vb, Format::Layout());
+template<typename... Attrs>
+struct VertexFormat
+{
+    static_assert(sizeof...(Attrs) > 0, "VertexFormat needs at least one attribute");
+
+    static constexpr unsigned int AttributeCount = sizeof...(Attrs);
+    static constexpr unsigned int Stride = (Attrs::size + ...);
+
+    static constexpr std::array<unsigned int, AttributeCount> Counts = { Attrs::count... };
+    static constexpr std::array<unsigned int, AttributeCount> Types = { Attrs::type... };
+
+    static constexpr std::array<unsigned int, AttributeCount> ComputeOffsets()
+    {
+        std::array<unsigned int, AttributeCount> offsets = {};
+        constexpr unsigned int sizes[] = { Attrs::size... };
+        unsigned int offset = 0;
+        for (unsigned int i = 0; i < AttributeCount; i++)
+        {
+            offsets[i] = offset;
+            offset += sizes[i];
+        }
+        return offsets;
+    }
+    static constexpr std::array<unsigned int, AttributeCount> Offsets = ComputeOffsets();
+
+    static constexpr unsigned int Offset(unsigned int attribute) { return Offsets[attribute]; }
+
+    // True if V is a tightly packed, memcpy-able struct of exactly this format
+    template<typename V>
+    static constexpr bool Matches()
+    {
+        return sizeof(V) == Stride && std::is_standard_layout<V>::value && std::is_trivially_copyable<V>::value;
+    }
+
+    // Runtime layout for VertexArray::AddBuffer, built from the compile-time description
+    static VertexBufferLayout Layout()
+    {
+        VertexBufferLayout layout;
+        (layout.Push(Attrs::type, Attrs::count, Attrs::normalized), ...);
+        return layout;
+    }
+
+    // Structure-of-arrays view: one tightly packed component stream per attribute,
+    // e.g. std::get<0>(streams) holds x0 y0 z0 x1 y1 z1 ... for CPU-side kernels
+    using Streams = std::tuple<std::vector<typename Attrs::Type>...>;
+
+    template<typename V>
+    static Streams ToSoA(const V* vertices, std::size_t count)
+    {
+        static_assert(Matches<V>(), "vertex struct does not match VertexFormat");
+        Streams streams;
+        ToSoA(reinterpret_cast<const unsigned char*>(vertices), count, streams, std::index_sequence_for<Attrs...>{});
+        return streams;
+    }
+
+    template<typename V>
+    static Streams ToSoA(const std::vector<V>& vertices) { return ToSoA(vertices.data(), vertices.size()); }
+
+    template<typename V>
+    static std::vector<V> ToAoS(const Streams& streams)
+    {
+        static_assert(Matches<V>(), "vertex struct does not match VertexFormat");
+        std::size_t count = std::get<0>(streams).size() / Counts[0];
+        std::vector<V> vertices(count);
+        ToAoS(streams, reinterpret_cast<unsigned char*>(vertices.data()), count, std::index_sequence_for<Attrs...>{});
+        return vertices;
+    }
+
+private:
+    template<std::size_t... I>
+    static void ToSoA(const unsigned char* base, std::size_t count, Streams& streams, std::index_sequence<I...>)
+    {
+        (Gather<I>(base, count, std::get<I>(streams)), ...);
+    }
+
+    template<std::size_t... I>
+    static void ToAoS(const Streams& streams, unsigned char* base, std::size_t count, std::index_sequence<I...>)
+    {
+        (Scatter<I>(std::get<I>(streams), base, count), ...);
+    }
+
+    template<std::size_t I, typename T>
+    static void Gather(const unsigned char* base, std::size_t count, std::vector<T>& stream)
+    {
+        constexpr unsigned int n = Counts[I];
+        stream.resize(count * n);
+        for (std::size_t v = 0; v < count; v++)
+            std::memcpy(&stream[v * n], base + v * Stride + Offsets[I], n * sizeof(T));
+    }
+
+    template<std::size_t I, typename T>
+    static void Scatter(const std::vector<T>& stream, unsigned char* base, std::size_t count)
+    {
+        constexpr unsigned int n = Counts[I];
+        for (std::size_t v = 0; v < count && (v + 1) * n <= stream.size(); v++)
+            std::memcpy(base + v * Stride + Offsets[I], &stream[v * n], n * sizeof(T));
+    }
+};
@@ -27,15 +27,9 @@ in vec3 ourColor;
 in vec2 TexCoord;
 flat in float vTexIndex;
 
-uniform sampler2D u_Textures[8];
+#include "include/Material.glsl"
 
 void main()
 {
-   int index = int(vTexIndex);
-   if (index < 0) {
-      FragColor = vec4(ourColor, 1.0);
-   }
-   else {
-      FragColor = texture(u_Textures[index], TexCoord);
-   }
+   FragColor = MaterialColor(ourColor, TexCoord, vTexIndex);
 }
\ No newline at end of file
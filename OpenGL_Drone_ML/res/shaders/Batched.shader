@@ -0,0 +1,43 @@
+#shader vertex
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in float aTexIndex;
+layout (location = 4) in float aDrawID; // row of the mesh in u_Transforms
+
+out vec3 ourColor;
+out vec2 TexCoord;
+flat out float vTexIndex;
+
+#include "include/Camera.glsl"
+
+uniform samplerBuffer u_Transforms; // one mat4 per mesh, as four RGBA32F columns
+
+void main()
+{
+   int row = int(aDrawID) * 4;
+   mat4 model = mat4(texelFetch(u_Transforms, row),
+                     texelFetch(u_Transforms, row + 1),
+                     texelFetch(u_Transforms, row + 2),
+                     texelFetch(u_Transforms, row + 3));
+   gl_Position = u_ViewProj * model * vec4(aPos, 1.0);
+   ourColor = aColor;
+   TexCoord = aTexCoord;
+   vTexIndex = aTexIndex;
+}
+
+#shader fragment
+#version 330 core
+out vec4 FragColor;
+
+in vec3 ourColor;
+in vec2 TexCoord;
+flat in float vTexIndex;
+
+#include "include/Material.glsl"
+
+void main()
+{
+   FragColor = MaterialColor(ourColor, TexCoord, vTexIndex);
+}
@@ -0,0 +1,40 @@
+#shader vertex
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in float aTexIndex;
+layout (location = 4) in mat4 aModel; // per instance, takes locations 4-7
+layout (location = 8) in vec4 aTint;  // per instance
+
+out vec3 ourColor;
+out vec2 TexCoord;
+out vec4 vTint;
+flat out float vTexIndex;
+
+#include "include/Camera.glsl"
+
+void main()
+{
+   gl_Position = u_ViewProj * aModel * vec4(aPos, 1.0);
+   ourColor = aColor;
+   TexCoord = aTexCoord;
+   vTint = aTint;
+   vTexIndex = aTexIndex;
+}
+
+#shader fragment
+#version 330 core
+out vec4 FragColor;
+
+in vec3 ourColor;
+in vec2 TexCoord;
+in vec4 vTint;
+flat in float vTexIndex;
+
+#include "include/Material.glsl"
+
+void main()
+{
+   FragColor = MaterialColor(ourColor, TexCoord, vTexIndex) * vTint;
+}
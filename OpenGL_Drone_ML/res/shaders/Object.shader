@@ -0,0 +1,43 @@
+#shader vertex
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in float aTexIndex;
+
+out vec3 ourColor;
+out vec2 TexCoord;
+flat out float vTexIndex;
+
+#include "include/Camera.glsl"
+
+// One range of the object ring per draw
+layout (std140) uniform Object
+{
+   mat4 u_MVP;
+   mat4 u_Model;
+   int u_Material; // material layer override, -1 keeps the vertex's layer
+};
+
+void main()
+{
+   gl_Position = u_MVP * vec4(aPos, 1.0);
+   ourColor = aColor;
+   TexCoord = aTexCoord;
+   vTexIndex = u_Material >= 0 ? float(u_Material) : aTexIndex;
+}
+
+#shader fragment
+#version 330 core
+out vec4 FragColor;
+
+in vec3 ourColor;
+in vec2 TexCoord;
+flat in float vTexIndex;
+
+#include "include/Material.glsl"
+
+void main()
+{
+   FragColor = MaterialColor(ourColor, TexCoord, vTexIndex);
+}
\ No newline at end of file
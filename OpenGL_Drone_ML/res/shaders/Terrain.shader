@@ -0,0 +1,57 @@
+#shader vertex
+#version 330 core
+layout (location = 0) in vec2 aGrid; // integer grid coordinate inside the node
+
+out vec2 vWorld;
+
+uniform mat4 u_MVP;
+uniform vec3 u_CameraPos;
+uniform vec2 u_NodeOffset;   // world xz of the node corner
+uniform float u_QuadSize;    // world size of one grid quad at this LOD
+uniform vec2 u_Morph;        // morph start distance, 1 / (end - start)
+uniform vec2 u_MapSize;      // world extent of the heightmap
+
+#include "include/Heightmap.glsl"
+
+void main()
+{
+   vec2 world = u_NodeOffset + aGrid * u_QuadSize;
+
+   // Slide odd vertices onto their even neighbours as the camera moves away, so at the end
+   // of the band this node matches the coarser LOD exactly and the switch does not pop
+   float dist = distance(u_CameraPos, vec3(world.x, HeightAt(world), world.y));
+   float k = clamp((dist - u_Morph.x) * u_Morph.y, 0.0, 1.0);
+   world -= fract(aGrid * 0.5) * 2.0 * u_QuadSize * k;
+   world = min(world, u_MapSize);
+
+   vWorld = world;
+   gl_Position = u_MVP * vec4(world.x, HeightAt(world), world.y, 1.0);
+}
+
+#shader fragment
+#version 330 core
+out vec4 FragColor;
+
+in vec2 vWorld;
+
+uniform vec2 u_HeightBounds; // min, max height of the whole map
+
+#include "include/Heightmap.glsl"
+
+void main()
+{
+   // Per pixel normal from the full resolution map, independent of the LOD drawn
+   float e = u_Spacing;
+   vec3 normal = normalize(vec3(HeightAt(vWorld - vec2(e, 0.0)) - HeightAt(vWorld + vec2(e, 0.0)), 2.0 * e,
+                                HeightAt(vWorld - vec2(0.0, e)) - HeightAt(vWorld + vec2(0.0, e))));
+   float t = (HeightAt(vWorld) - u_HeightBounds.x) / max(u_HeightBounds.y - u_HeightBounds.x, 0.001);
+
+   // grass -> rock on slopes -> snow on peaks, same palette as the generated tiles
+   float rock = clamp((0.85 - normal.y) * 4.0, 0.0, 1.0);
+   float snow = clamp((t - 0.75) * 6.0, 0.0, 1.0) * (1.0 - rock);
+   vec3 color = mix(vec3(0.22, 0.42, 0.16), vec3(0.45, 0.40, 0.35), rock);
+   color = mix(color, vec3(0.95, 0.95, 0.97), snow);
+
+   vec3 sun = normalize(vec3(0.4, 1.0, 0.3));
+   FragColor = vec4(color * (0.35 + 0.65 * max(0.0, dot(normal, sun))), 1.0);
+}
@@ -0,0 +1,8 @@
+// Shared with every program, see FrameUniforms.h
+layout (std140) uniform Camera
+{
+   mat4 u_View;
+   mat4 u_Proj;
+   mat4 u_ViewProj;
+   vec4 u_CameraPos;
+};
@@ -0,0 +1,10 @@
+uniform float u_Spacing;     // world distance between height samples
+uniform vec2 u_HeightDecode; // height = x + texel * y
+uniform sampler2D u_Heightmap;
+
+// The map has no mip levels, so both stages read level 0
+float HeightAt(vec2 world)
+{
+   vec2 uv = (world / u_Spacing + 0.5) / vec2(textureSize(u_Heightmap, 0));
+   return u_HeightDecode.x + textureLod(u_Heightmap, uv, 0.0).r * u_HeightDecode.y;
+}
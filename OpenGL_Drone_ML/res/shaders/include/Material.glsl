@@ -0,0 +1,23 @@
+// Surface color of the vertex format the scenes share (color, uv, texture layer). The layer
+// picks a slice of the TextureArray bound on unit 0, so any number of materials is one bind
+// and no sampler array is indexed per fragment. Pick the variant with a define so the
+// compiler drops the branches it doesn't need:
+//   UNTEXTURED       every vertex uses its color
+//   TEXTURE_LAYER n  every vertex samples layer n
+//   neither          the layer is read per vertex, negative meaning the color
+#ifndef UNTEXTURED
+uniform sampler2DArray u_Materials;
+#endif
+
+vec4 MaterialColor(vec3 color, vec2 uv, float layer)
+{
+#if defined(UNTEXTURED)
+   return vec4(color, 1.0);
+#elif defined(TEXTURE_LAYER)
+   return texture(u_Materials, vec3(uv, TEXTURE_LAYER));
+#else
+   if (layer < 0.0)
+      return vec4(color, 1.0);
+   return texture(u_Materials, vec3(uv, layer));
+#endif
+}
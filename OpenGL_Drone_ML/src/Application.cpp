@@ -1,7 +1,10 @@
 #include <GL/glew.h> // Must be included first
 #include <GLFW/glfw3.h>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <sstream>
 
@@ -10,8 +13,17 @@
 #include "IndexBuffer.h"
 #include "VertexArray.h"
 #include "Shader.h"
+#include "BufferArena.h"
+#include "FrameCapture.h"
+#include "Framebuffer.h"
+#include "GPUProfiler.h"
+#include "ShaderCache.h"
+#include "StreamBuffer.h"
 #include "Renderer.h"
+#include "RenderThread.h"
 #include "Texture.h"
+#include "TextureCache.h"
+#include "TextureLoader.h"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
@@ -28,19 +40,247 @@
 #include "Test3DB.h"
 #include "Test3DSurvey.h"
 #include "Test3DC.h"
+#include "Test3DTerrain.h"
 
-int main(void)
+// Command line for runs without a display: a test straight into an offscreen framebuffer,
+// optionally recorded, then exit
+struct HeadlessOptions
+{
+    std::string test;  // empty opens the window and test menu as usual
+    int frames = 300;
+    float fps = 30.0f; // the fixed time step, a recording does not depend on render speed
+    int width = 960, height = 540;
+    std::string capture; // directory, empty records nothing
+    FrameCapture::Format format = FrameCapture::Format::PNG;
+};
+
+static bool ParseOptions(int argc, char** argv, HeadlessOptions& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--headless") && hasValue)
+            options.test = argv[++i];
+        else if (!std::strcmp(argv[i], "--frames") && hasValue)
+            options.frames = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--fps") && hasValue)
+            options.fps = (float)std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--size") && hasValue)
+        {
+            if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2)
+                return false;
+        }
+        else if (!std::strcmp(argv[i], "--capture") && hasValue)
+            options.capture = argv[++i];
+        else if (!std::strcmp(argv[i], "--raw"))
+            options.format = FrameCapture::Format::Raw;
+        else
+            return false;
+    }
+    return options.frames > 0 && options.fps > 0.0f && options.width > 0 && options.height > 0;
+}
+
+static int RunHeadless(test::TestMenu& menu, const HeadlessOptions& options)
+{
+    test::Test* test = menu.Create(options.test);
+    if (!test)
+    {
+        std::cout << "No test called \"" << options.test << "\", the tests are " << menu.GetNames() << std::endl;
+        return 1;
+    }
+
+    // The hidden window's own framebuffer is undefined where it is not on screen
+    Framebuffer framebuffer(options.width, options.height);
+    std::unique_ptr<FrameCapture> capture;
+    if (!options.capture.empty())
+        capture = std::make_unique<FrameCapture>(options.capture, options.format, options.width, options.height);
+
+    Renderer renderer;
+    for (int frame = 0; frame < options.frames; frame++)
+    {
+        GLState::NewFrame();
+        StreamBuffer::NewFrame();
+        GPUProfiler::NewFrame();
+        TextureLoader::Finish(); // every texel in, a reference render must not show placeholders
+
+        framebuffer.Bind();
+        GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+        renderer.Clear();
+        test->OnUpdate(1.0f / options.fps);
+        test->OnRender();
+        if (capture)
+            capture->Capture();
+
+        glfwPollEvents();
+    }
+    delete test;
+
+    if (capture)
+    {
+        capture->Finish();
+        const FrameCapture::Stats stats = capture->GetStats();
+        std::cout << "Captured " << stats.written << " frames to " << options.capture << ", "
+            << stats.stalls << " stalls" << std::endl;
+    }
+    return 0;
+}
+
+// The update thread (this one) polls events and runs OnUpdate, everything touching GL is recorded
+// for the render thread. A frame is handed back once its scene and ImGui windows are built, so the
+// next update runs while the render thread uploads textures, draws ImGui and waits on the swap
+static void RunWindowed(GLFWwindow* window, test::TestMenu* testMenu, test::Test*& currentTest)
+{
+    Renderer renderer;
+    bool backToMenu = false;
+    double lastFrame = glfwGetTime();
+
+    RenderThread renderThread(window, 1); // last, so it finishes before the state above goes
+    while (!glfwWindowShouldClose(window))
+    {
+        // Input callbacks and OnUpdate write the test the last scene read
+        renderThread.WaitForHandoff();
+
+        /* Poll for and process events */
+        glfwPollEvents();
+
+        if (backToMenu || testMenu->HasSelection())
+        {
+            // Constructors and destructors set GLFW callbacks and own GL objects
+            renderThread.Borrow([&]()
+            {
+                if (backToMenu)
+                {
+                    glfwSetWindowUserPointer(window, testMenu);
+                    glfwSetKeyCallback(window, testMenu->KeyCallback);
+                    glfwSetCursorPosCallback(window, testMenu->MouseCallback);
+                    glfwSetMouseButtonCallback(window, testMenu->MouseButtonCallback);
+                    glfwSetScrollCallback(window, testMenu->ScrollCallback);
+                    delete currentTest;
+                    currentTest = testMenu;
+                }
+                testMenu->CreateSelected();
+            });
+            backToMenu = false;
+        }
+
+        const double currentFrame = glfwGetTime();            // seconds since init
+        float deltaTime = (float)(currentFrame - lastFrame);  // time since last frame
+        lastFrame = currentFrame;
+
+        ImGui_ImplGlfw_NewFrame(); // reads the window and cursor, main thread only
+        if (currentTest)
+            currentTest->OnUpdate(deltaTime);
+        const float updateMs = (float)(glfwGetTime() - currentFrame) * 1000.0f;
+
+        RenderCommandList& commands = renderThread.GetList();
+        commands.Record([&, deltaTime, updateMs]()
+        {
+            GLState::NewFrame();
+            StreamBuffer::NewFrame();
+            GPUProfiler::NewFrame();
+            GPUProfiler::Begin("Frame");
+
+            GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+            /* Render here */
+            renderer.Clear();
+
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui::NewFrame();
+            if (currentTest)
+            {
+                {
+                    GPUScope scope("Scene");
+                    currentTest->OnRender();
+                }
+                ImGui::Begin("Test");
+                if (currentTest != testMenu && ImGui::Button("<-"))
+                    backToMenu = true;
+                currentTest->OnImGuiRender();
+                const RenderThread::Stats frame = renderThread.GetStats();
+                ImGui::Text("Frame %.2f ms: update %.2f, render %.2f, present %.2f (%u commands)",
+                    deltaTime * 1000.0f, updateMs, frame.executeMs, frame.presentMs, frame.commands);
+                const GLState::Stats& stats = GLState::GetFrameStats();
+                ImGui::Text("State changes: %u issued, %u elided", stats.issued, stats.elided);
+                const StreamBuffer::Stats& streamed = StreamBuffer::GetFrameStats();
+                ImGui::Text("Streamed: %zu bytes in %u writes, %u unchanged, %u stalls",
+                    streamed.bytes, streamed.writes, streamed.skipped, streamed.stalls);
+                const ShaderCache::Stats& shaders = ShaderCache::GetStats();
+                ImGui::Text("Programs: %u from cache, %u compiled, %u precompiled%s", shaders.hits,
+                    shaders.misses, shaders.precompiled, ShaderCache::IsParallel() ? " (parallel)" : "");
+                if (TextureCache::IsSupported())
+                {
+                    const TextureCache::Stats& textures = TextureCache::GetStats();
+                    ImGui::Text("Textures: %u from cache, %u converted", textures.hits.load(), textures.converted.load());
+                }
+                if (TextureLoader::GetPendingCount() > 0)
+                    ImGui::Text("Textures loading: %u", TextureLoader::GetPendingCount());
+                if (ImGui::CollapsingHeader("GPU profiler"))
+                    GPUProfiler::OnImGuiRender();
+#if GL_ERRORS_COMPILED
+                if (ImGui::CollapsingHeader("GL errors"))
+                {
+                    const GLErrorMode modes[] = {GLErrorMode::Off, GLErrorMode::Poll, GLErrorMode::Sampled, GLErrorMode::Callback};
+                    GLErrorMode current = GLGetErrorMode();
+                    if (ImGui::BeginCombo("Mode", GLErrorModeName(current)))
+                    {
+                        for (GLErrorMode mode : modes)
+                            if (ImGui::Selectable(GLErrorModeName(mode), mode == current))
+                                GLSetErrorMode(mode);
+                        ImGui::EndCombo();
+                    }
+                    int rate = (int)GLGetErrorSampleRate();
+                    if (current == GLErrorMode::Sampled && ImGui::SliderInt("Check every", &rate, 1, 1024))
+                        GLSetErrorSampleRate((unsigned int)rate);
+                }
+#endif
+                ImGui::End();
+            }
+            ImGui::Render();
+        });
+        // Nothing after this reads the test
+        renderThread.RecordHandoff();
+        commands.Record([]()
+        {
+            TextureLoader::Update();
+            {
+                GPUScope scope("ImGui");
+                ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            }
+            GLState::Invalidate(); // ImGui binds behind the cache's back
+            GPUProfiler::End(); // Frame
+        });
+        /* Swap front and back buffers, on the render thread */
+        renderThread.Submit();
+    }
+}
+
+int main(int argc, char** argv)
 {
     GLFWwindow *window;
 
+    HeadlessOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::cout << "Usage: drone_sim [--headless <test> [--frames N] [--fps N] [--size WxH] [--capture <dir> [--raw]]]" << std::endl;
+        return -1;
+    }
+    const bool headless = !options.test.empty();
+    int exitCode = 0;
+
     if (!glfwInit())
         return -1;
 
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#if GL_ERRORS_COMPILED
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE); // some drivers only report through KHR_debug on a debug context
+#endif
+    if (headless)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE); // only there for the context
 
-    window = glfwCreateWindow(960, 540, "ML Drone", NULL, NULL);
+    window = headless ? glfwCreateWindow(options.width, options.height, "ML Drone", NULL, NULL)
+                      : glfwCreateWindow(960, 540, "ML Drone", NULL, NULL);
     if (!window)
     {
         glfwTerminate();
@@ -49,18 +289,34 @@ int main(void)
 
     glfwMakeContextCurrent(window);
 
-    glfwSwapInterval(1);
+    glfwSwapInterval(headless ? 0 : 1);
 
     if (glewInit() != GLEW_OK)
         std::cout << "Error!" << std::endl;
 
     std::cout << glGetString(GL_VERSION) << std::endl;
+#if GL_ERRORS_COMPILED
+    GLEnableDebugOutput();
+#endif
+    ShaderCache::Init();
+    TextureCache::Init();
+    {
+        // Builds whatever the cache is missing now, so opening a test only loads binaries. Lists
+        // the permutations the tests and DepthCamera actually ask for, keep it in step with them
+        Shader::Precompile({
+            {"res/shaders/Basic.shader", {}},
+            {"res/shaders/Basic2.shader", {}},
+            {"res/shaders/Batched.shader", {}},
+            {"res/shaders/Depth.shader", {}},
+            {"res/shaders/Instanced.shader", {"UNTEXTURED"}},
+            {"res/shaders/Object.shader", {}},
+            {"res/shaders/Terrain.shader", {}},
+        });
+    }
     {
 
-        GLCall(glEnable(GL_BLEND));
-        GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
-
-        Renderer renderer;
+        GLState::SetBlend(true);
+        GLState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         test::Test *currentTest = nullptr; // TestMenu will change this for us
         test::TestMenu *testMenu = new test::TestMenu(currentTest);
@@ -75,6 +331,7 @@ int main(void)
         testMenu->RegisterTest<test::Test3DB>("3DB", window);
         testMenu->RegisterTest<test::Test3DSurvey>("3DSurvey", window);
         testMenu->RegisterTest<test::Test3DC>("3DC", window);
+        testMenu->RegisterTest<test::Test3DTerrain>("3D Terrain", window);
 
         ImGui::CreateContext();
         ImGuiIO &io = ImGui::GetIO();
@@ -85,57 +342,22 @@ int main(void)
         ImGui_ImplOpenGL3_Init();
         ImGui::StyleColorsDark();
 
-        float lastFrame = 0.0f;
-        while (!glfwWindowShouldClose(window))
-        {
-            float currentFrame = glfwGetTime();         // seconds since init
-            float deltaTime = currentFrame - lastFrame; // time since last frame
-            lastFrame = currentFrame;
-
-            GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
-            /* Render here */
-            renderer.Clear();
-
-            ImGui_ImplOpenGL3_NewFrame();
-            ImGui_ImplGlfw_NewFrame();
-            ImGui::NewFrame();
-            if (currentTest)
-            {
-                currentTest->OnUpdate(deltaTime);
-                currentTest->OnRender();
-                ImGui::Begin("Test");
-                if (currentTest != testMenu && ImGui::Button("<-"))
-                {
-                    glfwSetWindowUserPointer(window, testMenu);
-                    glfwSetKeyCallback(window, testMenu->KeyCallback);
-                    glfwSetCursorPosCallback(window, testMenu->MouseCallback);
-                    glfwSetMouseButtonCallback(window, testMenu->MouseButtonCallback);
-                    glfwSetScrollCallback(window, testMenu->ScrollCallback);
-                    delete currentTest;
-                    currentTest = testMenu;
-                }
-                currentTest->OnImGuiRender();
-                ImGui::End();
-            }
-
-            ImGui::Render();
-            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-
-            /* Swap front and back buffers */
-            glfwSwapBuffers(window);
-
-            /* Poll for and process events */
-            glfwPollEvents();
-        }
+        if (headless)
+            exitCode = RunHeadless(*testMenu, options);
+        else
+            RunWindowed(window, testMenu, currentTest);
 
         delete currentTest;
         if (currentTest != testMenu)
             delete testMenu;
+        BufferArena::ReleaseShared(); // its blocks outlive the tests, not the context
+        GPUProfiler::Shutdown();
+        TextureLoader::Shutdown();
     } // created a scope to get application to terminate when x is clicked
 
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
     glfwTerminate();
-    return 0;
+    return exitCode;
 }
\ No newline at end of file
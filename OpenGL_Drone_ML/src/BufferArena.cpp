@@ -0,0 +1,159 @@
+#include "BufferArena.h"
+
+#include <algorithm>
+
+RangeAllocator::RangeAllocator(unsigned int size)
+    : m_Size(size), m_Used(0)
+{
+    if (size > 0)
+        m_Free[0] = size;
+}
+
+unsigned int RangeAllocator::Allocate(unsigned int size)
+{
+    if (size == 0)
+        return 0;
+    for (auto it = m_Free.begin(); it != m_Free.end(); ++it)
+    {
+        if (it->second < size)
+            continue;
+        const unsigned int offset = it->first;
+        const unsigned int remaining = it->second - size;
+        m_Free.erase(it);
+        if (remaining > 0)
+            m_Free[offset + size] = remaining;
+        m_Used += size;
+        return offset;
+    }
+    return INVALID;
+}
+
+void RangeAllocator::Free(unsigned int offset, unsigned int size)
+{
+    if (size == 0)
+        return;
+    m_Used -= size;
+    auto next = m_Free.lower_bound(offset);
+    if (next != m_Free.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset)
+        {
+            offset = previous->first;
+            size += previous->second;
+            m_Free.erase(previous);
+        }
+    }
+    if (next != m_Free.end() && offset + size == next->first)
+    {
+        size += next->second;
+        m_Free.erase(next);
+    }
+    m_Free[offset] = size;
+}
+
+std::map<std::string, std::shared_ptr<BufferArena>> BufferArena::s_Shared;
+
+BufferArena::BufferArena(const VertexBufferLayout& layout, unsigned int blockVertices, unsigned int blockIndices)
+    : m_Layout(layout), m_BlockVertices(std::max(1u, blockVertices)), m_BlockIndices(std::max(1u, blockIndices))
+{
+}
+
+void BufferArena::AddBlock(unsigned int vertices, unsigned int indices)
+{
+    Block block{nullptr, nullptr, nullptr, RangeAllocator(vertices), RangeAllocator(indices)};
+    block.va = std::make_unique<VertexArray>();
+    block.vb = std::make_unique<VertexBuffer>(vertices * m_Layout.GetStride());
+    block.va->AddBuffer(*block.vb, m_Layout);
+    block.ib = std::make_unique<IndexBuffer>(indices);
+    m_Blocks.push_back(std::move(block));
+}
+
+ArenaMesh BufferArena::Allocate(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+    ArenaMesh mesh;
+    unsigned int vertexOffset = RangeAllocator::INVALID, indexOffset = RangeAllocator::INVALID;
+    for (unsigned int i = 0; i < m_Blocks.size() && !mesh.IsValid(); i++)
+    {
+        Block& block = m_Blocks[i];
+        vertexOffset = block.vertices.Allocate(vertexCount);
+        if (vertexOffset == RangeAllocator::INVALID)
+            continue;
+        indexOffset = block.indices.Allocate(indexCount);
+        if (indexOffset == RangeAllocator::INVALID)
+        {
+            block.vertices.Free(vertexOffset, vertexCount);
+            continue;
+        }
+        mesh.block = i;
+    }
+    if (!mesh.IsValid())
+    {
+        AddBlock(std::max(vertexCount, m_BlockVertices), std::max(indexCount, m_BlockIndices));
+        mesh.block = (unsigned int)m_Blocks.size() - 1;
+        vertexOffset = m_Blocks.back().vertices.Allocate(vertexCount);
+        indexOffset = m_Blocks.back().indices.Allocate(indexCount);
+    }
+
+    mesh.baseVertex = (int)vertexOffset;
+    mesh.vertexCount = vertexCount;
+    mesh.firstIndex = indexOffset;
+    mesh.indexCount = indexCount;
+
+    Block& block = m_Blocks[mesh.block];
+    const unsigned int stride = m_Layout.GetStride();
+    if (vertexCount)
+        block.vb->SetData(vertices, vertexCount * stride, vertexOffset * stride);
+    if (indexCount)
+        block.ib->SetData(indices, indexCount, indexOffset);
+    m_MeshCount++;
+    return mesh;
+}
+
+void BufferArena::Free(ArenaMesh& mesh)
+{
+    if (!mesh.IsValid())
+        return;
+    Block& block = m_Blocks[mesh.block];
+    block.vertices.Free((unsigned int)mesh.baseVertex, mesh.vertexCount);
+    block.indices.Free(mesh.firstIndex, mesh.indexCount);
+    m_MeshCount--;
+    mesh = ArenaMesh();
+}
+
+void BufferArena::Draw(const Renderer& renderer, const Shader& shader, const ArenaMesh& mesh) const
+{
+    const Block& block = m_Blocks[mesh.block];
+    renderer.Draw(*block.va, *block.ib, shader, mesh.indexCount, mesh.firstIndex, mesh.baseVertex);
+}
+
+BufferArena::Stats BufferArena::GetStats() const
+{
+    Stats stats = {(unsigned int)m_Blocks.size(), m_MeshCount, 0, 0, 0, 0};
+    const unsigned int stride = m_Layout.GetStride();
+    for (const Block& block : m_Blocks)
+    {
+        stats.vertexBytesUsed += (size_t)block.vertices.GetUsed() * stride;
+        stats.vertexBytes += (size_t)block.vertices.GetSize() * stride;
+        stats.indexBytesUsed += (size_t)block.indices.GetUsed() * sizeof(unsigned int);
+        stats.indexBytes += (size_t)block.indices.GetSize() * sizeof(unsigned int);
+    }
+    return stats;
+}
+
+std::shared_ptr<BufferArena> BufferArena::Shared(const VertexBufferLayout& layout)
+{
+    std::string key;
+    for (const VertexBufferElement& element : layout.GetElements())
+        key += std::to_string(element.type) + ":" + std::to_string(element.count) + (element.normalized ? "n " : " ");
+
+    std::shared_ptr<BufferArena>& arena = s_Shared[key];
+    if (!arena)
+        arena = std::make_shared<BufferArena>(layout);
+    return arena;
+}
+
+void BufferArena::ReleaseShared()
+{
+    s_Shared.clear();
+}
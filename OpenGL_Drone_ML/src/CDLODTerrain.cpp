@@ -0,0 +1,247 @@
+#include "CDLODTerrain.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <iostream>
+
+#include "VertexFormat.h"
+
+using GridFormat = VertexFormat<Attr<float, 2>>; // integer grid coordinate, 0..gridSize
+
+CDLODTerrain::CDLODTerrain(const Heightmap& heightmap, unsigned int gridSize, unsigned int lodCount, float lodDistance)
+    : m_Heightmap(heightmap), m_RendererID(0), m_GridSize(std::max(2u, gridSize & ~1u)), m_LodCount(std::max(1u, lodCount)),
+      m_LodDistance(lodDistance > 0.0f ? lodDistance : 2.5f * m_GridSize * heightmap.GetSpacing())
+{
+    // Height texture, one channel holding the raw samples (R16 normalised to [0, 1], or R32F)
+    GLint maxSize = 0;
+    GLCall(glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize));
+    if ((GLint)heightmap.GetWidth() > maxSize || (GLint)heightmap.GetHeight() > maxSize)
+        std::cout << "Heightmap " << heightmap.GetWidth() << "x" << heightmap.GetHeight() << " exceeds GL_MAX_TEXTURE_SIZE " << maxSize << std::endl;
+
+    GLCall(glGenTextures(1, &m_RendererID));
+    GLState::BindTexture(GL_TEXTURE_2D, m_RendererID);
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+    if (heightmap.GetFormat() == HeightFormat::UInt16)
+    {
+        GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 2)); // rows of odd width are not 4 byte aligned
+        GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_R16, heightmap.GetWidth(), heightmap.GetHeight(), 0, GL_RED, GL_UNSIGNED_SHORT, heightmap.GetData()));
+        GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+    }
+    else
+    {
+        GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, heightmap.GetWidth(), heightmap.GetHeight(), 0, GL_RED, GL_FLOAT, heightmap.GetData()));
+    }
+
+    // Grid mesh, indices ordered by quadrant so the first quarter draws just the lower-left
+    // child area (gridSize / 2 quads a side) when a node is only partially selected
+    const unsigned int side = m_GridSize + 1;
+    const unsigned int half = m_GridSize / 2;
+    std::vector<float> grid;
+    grid.reserve(side * side * 2);
+    for (unsigned int z = 0; z < side; z++)
+    {
+        for (unsigned int x = 0; x < side; x++)
+        {
+            grid.push_back((float)x);
+            grid.push_back((float)z);
+        }
+    }
+
+    std::vector<unsigned int> indices;
+    indices.reserve(m_GridSize * m_GridSize * 6);
+    for (unsigned int quadrant = 0; quadrant < 4; quadrant++)
+    {
+        unsigned int ox = (quadrant & 1) * half, oz = (quadrant >> 1) * half;
+        for (unsigned int z = oz; z < oz + half; z++)
+        {
+            for (unsigned int x = ox; x < ox + half; x++)
+            {
+                unsigned int a = z * side + x;
+                indices.insert(indices.end(), {a, a + side, a + side + 1, a + side + 1, a + 1, a});
+            }
+        }
+    }
+
+    m_VAO = std::make_unique<VertexArray>();
+    m_VertexBuffer = std::make_unique<VertexBuffer>(grid.data(), grid.size() * sizeof(float));
+    m_VAO->AddBuffer(*m_VertexBuffer, GridFormat::Layout());
+    m_IndexBuffer = std::make_unique<IndexBuffer>(indices.data(), indices.size());
+
+    BuildMinMax();
+    UpdateRanges();
+}
+
+CDLODTerrain::~CDLODTerrain()
+{
+    GLState::OnDeleteTexture(m_RendererID);
+    GLCall(glDeleteTextures(1, &m_RendererID));
+}
+
+void CDLODTerrain::BuildMinMax()
+{
+    const unsigned int width = m_Heightmap.GetWidth(), height = m_Heightmap.GetHeight();
+    m_NodesX.resize(m_LodCount);
+    m_NodesZ.resize(m_LodCount);
+    m_MinMax.resize(m_LodCount);
+
+    // LOD 0 straight from the samples, a node covers gridSize + 1 samples so neighbours share an edge
+    m_NodesX[0] = std::max(1u, (width - 1 + m_GridSize - 1) / m_GridSize);
+    m_NodesZ[0] = std::max(1u, (height - 1 + m_GridSize - 1) / m_GridSize);
+    m_MinMax[0].assign(m_NodesX[0] * m_NodesZ[0], glm::vec2(FLT_MAX, -FLT_MAX));
+    for (unsigned int nz = 0; nz < m_NodesZ[0]; nz++)
+    {
+        for (unsigned int nx = 0; nx < m_NodesX[0]; nx++)
+        {
+            glm::vec2& range = m_MinMax[0][nz * m_NodesX[0] + nx];
+            unsigned int x1 = std::min(width - 1, (nx + 1) * m_GridSize);
+            unsigned int z1 = std::min(height - 1, (nz + 1) * m_GridSize);
+            for (unsigned int z = nz * m_GridSize; z <= z1; z++)
+            {
+                for (unsigned int x = nx * m_GridSize; x <= x1; x++)
+                {
+                    float h = m_Heightmap.GetSample(x, z);
+                    range.x = std::min(range.x, h);
+                    range.y = std::max(range.y, h);
+                }
+            }
+        }
+    }
+
+    // Coarser LODs reduce 2x2 children
+    for (unsigned int lod = 1; lod < m_LodCount; lod++)
+    {
+        m_NodesX[lod] = (m_NodesX[lod - 1] + 1) / 2;
+        m_NodesZ[lod] = (m_NodesZ[lod - 1] + 1) / 2;
+        m_MinMax[lod].assign(m_NodesX[lod] * m_NodesZ[lod], glm::vec2(FLT_MAX, -FLT_MAX));
+        for (unsigned int cz = 0; cz < m_NodesZ[lod - 1]; cz++)
+        {
+            for (unsigned int cx = 0; cx < m_NodesX[lod - 1]; cx++)
+            {
+                const glm::vec2& child = m_MinMax[lod - 1][cz * m_NodesX[lod - 1] + cx];
+                glm::vec2& range = m_MinMax[lod][(cz / 2) * m_NodesX[lod] + cx / 2];
+                range.x = std::min(range.x, child.x);
+                range.y = std::max(range.y, child.y);
+            }
+        }
+    }
+}
+
+void CDLODTerrain::UpdateRanges()
+{
+    m_Ranges.resize(m_LodCount);
+    float range = m_LodDistance;
+    for (unsigned int lod = 0; lod < m_LodCount; lod++)
+    {
+        m_Ranges[lod] = range;
+        range *= 2.0f;
+    }
+}
+
+void CDLODTerrain::SetLodDistance(float distance)
+{
+    // A LOD band narrower than a node diagonal would pop, keep it comfortably wider
+    m_LodDistance = std::max(distance, 1.5f * m_GridSize * m_Heightmap.GetSpacing());
+    UpdateRanges();
+}
+
+AABB CDLODTerrain::NodeBounds(unsigned int lod, unsigned int nx, unsigned int nz) const
+{
+    const float size = (float)(m_GridSize << lod) * m_Heightmap.GetSpacing();
+    const glm::vec2& range = m_MinMax[lod][nz * m_NodesX[lod] + nx];
+
+    AABB box;
+    box.min = glm::vec3(nx * size, range.x, nz * size);
+    box.max = glm::vec3(std::min((nx + 1) * size, m_Heightmap.GetWorldWidth()), range.y,
+                        std::min((nz + 1) * size, m_Heightmap.GetWorldDepth()));
+    return box;
+}
+
+static bool InRange(const AABB& box, const glm::vec3& point, float range)
+{
+    glm::vec3 closest = glm::clamp(point, box.min, box.max);
+    glm::vec3 d = closest - point;
+    return glm::dot(d, d) <= range * range;
+}
+
+// Returns false if the node is out of this LOD's range, so the caller covers its area instead
+bool CDLODTerrain::Select(unsigned int lod, unsigned int nx, unsigned int nz, const Frustum& frustum, const glm::vec3& cameraPos)
+{
+    if (nx >= m_NodesX[lod] || nz >= m_NodesZ[lod])
+        return true; // off the map, nothing to draw
+
+    AABB box = NodeBounds(lod, nx, nz);
+    if (!InRange(box, cameraPos, m_Ranges[lod]))
+        return false;
+    if (!frustum.IsVisible(box))
+        return true;
+
+    if (lod == 0 || !InRange(box, cameraPos, m_Ranges[lod - 1]))
+    {
+        m_Selection.push_back({box.min.x, box.min.z, lod, false});
+        return true;
+    }
+
+    const float childSize = (float)(m_GridSize << (lod - 1)) * m_Heightmap.GetSpacing();
+    for (unsigned int c = 0; c < 4; c++)
+    {
+        unsigned int cx = nx * 2 + (c & 1), cz = nz * 2 + (c >> 1);
+        if (!Select(lod - 1, cx, cz, frustum, cameraPos))
+            m_Selection.push_back({cx * childSize, cz * childSize, lod, true});
+    }
+    return true;
+}
+
+unsigned int CDLODTerrain::Draw(const Renderer& renderer, Shader& shader, const glm::mat4& viewProj, const glm::vec3& cameraPos)
+{
+    Frustum frustum(viewProj);
+    m_Selection.clear();
+    const unsigned int top = m_LodCount - 1;
+    for (unsigned int nz = 0; nz < m_NodesZ[top]; nz++)
+        for (unsigned int nx = 0; nx < m_NodesX[top]; nx++)
+            Select(top, nx, nz, frustum, cameraPos);
+
+    GLState::BindTexture(HEIGHTMAP_SLOT, GL_TEXTURE_2D, m_RendererID);
+
+    shader.Bind();
+    if (m_UniformProgram != shader.GetRendererID())
+    {
+        m_UniformProgram = shader.GetRendererID();
+        m_NodeOffset = shader.GetUniform<glm::vec2>("u_NodeOffset");
+        m_QuadSize = shader.GetUniform<float>("u_QuadSize");
+        m_Morph = shader.GetUniform<glm::vec2>("u_Morph");
+    }
+    shader.Set(shader.GetMVPUniform(), viewProj);
+    shader.SetUniform3f("u_CameraPos", cameraPos.x, cameraPos.y, cameraPos.z);
+    shader.SetUniform1i("u_Heightmap", HEIGHTMAP_SLOT);
+    shader.SetUniform1f("u_Spacing", m_Heightmap.GetSpacing());
+    shader.SetUniform2f("u_MapSize", m_Heightmap.GetWorldWidth(), m_Heightmap.GetWorldDepth());
+    // R16 texels come back divided by 65535, R32F texels as they are
+    float texelScale = m_Heightmap.GetScale() * (m_Heightmap.GetFormat() == HeightFormat::UInt16 ? 65535.0f : 1.0f);
+    shader.SetUniform2f("u_HeightDecode", m_Heightmap.GetOffset(), texelScale);
+    shader.SetUniform2f("u_HeightBounds", m_Heightmap.GetMinHeight(), m_Heightmap.GetMaxHeight());
+
+    const unsigned int fullCount = m_IndexBuffer->GetCount();
+    for (const Node& node : m_Selection)
+    {
+        // Morph over the last part of this LOD's band into the next coarser one
+        float previous = node.lod > 0 ? m_Ranges[node.lod - 1] : 0.0f;
+        float end = m_Ranges[node.lod];
+        float start = previous + (end - previous) * m_MorphStart;
+
+        shader.Set(m_NodeOffset, glm::vec2(node.x, node.z));
+        shader.Set(m_QuadSize, (float)(1u << node.lod) * m_Heightmap.GetSpacing());
+        shader.Set(m_Morph, glm::vec2(start, 1.0f / (end - start)));
+        renderer.Draw(*m_VAO, *m_IndexBuffer, shader, node.quarter ? fullCount / 4 : fullCount);
+    }
+    return (unsigned int)m_Selection.size();
+}
+
+size_t CDLODTerrain::GetGPUBytes() const
+{
+    const size_t side = m_GridSize + 1;
+    return (size_t)m_Heightmap.GetWidth() * m_Heightmap.GetHeight() * m_Heightmap.GetBytesPerSample()
+        + side * side * GridFormat::Stride + (size_t)m_IndexBuffer->GetCount() * sizeof(unsigned int);
+}
@@ -0,0 +1,150 @@
+#include "ChunkedMesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+static glm::vec3 PositionOf(const unsigned char* vertices, unsigned int stride, unsigned int index)
+{
+    float p[3];
+    std::memcpy(p, vertices + (size_t)index * stride, sizeof(p));
+    return glm::vec3(p[0], p[1], p[2]);
+}
+
+std::vector<MeshChunk> ChunkedMesh::Partition(const void* vertices, unsigned int vertexCount, unsigned int stride,
+    const std::vector<unsigned int>& indices, float chunkSize)
+{
+    const unsigned char* src = static_cast<const unsigned char*>(vertices);
+    const unsigned int triangleCount = indices.size() / 3;
+
+    // Grid extents from triangle centroids
+    float minX = std::numeric_limits<float>::max(), minZ = std::numeric_limits<float>::max();
+    float maxX = -std::numeric_limits<float>::max(), maxZ = -std::numeric_limits<float>::max();
+    std::vector<glm::vec3> centroids(triangleCount);
+    for (unsigned int t = 0; t < triangleCount; t++)
+    {
+        glm::vec3 c = (PositionOf(src, stride, indices[t * 3 + 0]) +
+                       PositionOf(src, stride, indices[t * 3 + 1]) +
+                       PositionOf(src, stride, indices[t * 3 + 2])) / 3.0f;
+        centroids[t] = c;
+        minX = std::min(minX, c.x); maxX = std::max(maxX, c.x);
+        minZ = std::min(minZ, c.z); maxZ = std::max(maxZ, c.z);
+    }
+    if (triangleCount == 0)
+        return {};
+
+    // Cells are aligned to world space multiples of chunkSize so grid coords are stable between meshes
+    const int firstX = (int)std::floor(minX / chunkSize);
+    const int firstZ = (int)std::floor(minZ / chunkSize);
+    const int cellsX = (int)std::floor(maxX / chunkSize) - firstX + 1;
+    const int cellsZ = (int)std::floor(maxZ / chunkSize) - firstZ + 1;
+
+    // Bucket triangles per cell
+    std::vector<std::vector<unsigned int>> buckets(cellsX * cellsZ);
+    for (unsigned int t = 0; t < triangleCount; t++)
+    {
+        int cx = std::clamp((int)std::floor(centroids[t].x / chunkSize) - firstX, 0, cellsX - 1);
+        int cz = std::clamp((int)std::floor(centroids[t].z / chunkSize) - firstZ, 0, cellsZ - 1);
+        buckets[cz * cellsX + cx].push_back(t);
+    }
+
+    // Build each chunk with its own compact vertex set, remap is shared and reset per chunk
+    std::vector<MeshChunk> chunks;
+    std::vector<unsigned int> remap(vertexCount, std::numeric_limits<unsigned int>::max());
+    std::vector<unsigned int> touched;
+    for (int cz = 0; cz < cellsZ; cz++)
+    {
+        for (int cx = 0; cx < cellsX; cx++)
+        {
+            const auto& bucket = buckets[cz * cellsX + cx];
+            if (bucket.empty())
+                continue;
+
+            MeshChunk chunk;
+            chunk.gridX = firstX + cx;
+            chunk.gridZ = firstZ + cz;
+            chunk.indices.reserve(bucket.size() * 3);
+            for (unsigned int t : bucket)
+            {
+                for (unsigned int k = 0; k < 3; k++)
+                {
+                    unsigned int index = indices[t * 3 + k];
+                    if (remap[index] == std::numeric_limits<unsigned int>::max())
+                    {
+                        remap[index] = chunk.vertices.size() / stride;
+                        chunk.vertices.insert(chunk.vertices.end(), src + (size_t)index * stride, src + (size_t)(index + 1) * stride);
+                        chunk.bounds.Expand(PositionOf(src, stride, index));
+                        touched.push_back(index);
+                    }
+                    chunk.indices.push_back(remap[index]);
+                }
+            }
+            for (unsigned int index : touched)
+                remap[index] = std::numeric_limits<unsigned int>::max();
+            touched.clear();
+
+            chunks.push_back(std::move(chunk));
+        }
+    }
+    return chunks;
+}
+
+ChunkedMesh::ChunkedMesh(const void* vertices, unsigned int vertexCount, unsigned int stride,
+    const std::vector<unsigned int>& indices, const VertexBufferLayout& layout, float chunkSize)
+    : m_Arena(BufferArena::Shared(layout)), m_VisibleCount(0)
+{
+    std::vector<MeshChunk> chunks = Partition(vertices, vertexCount, stride, indices, chunkSize);
+    m_Chunks.reserve(chunks.size());
+    for (const auto& data : chunks)
+    {
+        Chunk chunk;
+        chunk.bounds = data.bounds;
+        chunk.mesh = m_Arena->Allocate(data.vertices.data(), (unsigned int)(data.vertices.size() / stride),
+            data.indices.data(), (unsigned int)data.indices.size());
+        m_Bounds.Expand(chunk.bounds);
+        m_Chunks.push_back(chunk);
+    }
+}
+
+ChunkedMesh::~ChunkedMesh()
+{
+    for (auto& chunk : m_Chunks)
+        m_Arena->Free(chunk.mesh);
+}
+
+unsigned int ChunkedMesh::Draw(const Renderer& renderer, const Shader& shader, const glm::mat4& viewProj) const
+{
+    Frustum frustum(viewProj);
+    m_VisibleCount = 0;
+    for (const auto& chunk : m_Chunks)
+    {
+        if (!frustum.IsVisible(chunk.bounds))
+            continue;
+        m_Arena->Draw(renderer, shader, chunk.mesh);
+        m_VisibleCount++;
+    }
+    return m_VisibleCount;
+}
+
+unsigned int ChunkedMesh::Submit(RenderQueue& queue, Shader& shader, const glm::mat4& viewProj, const glm::vec3& cameraPos) const
+{
+    Frustum frustum(viewProj);
+    m_VisibleCount = 0;
+    for (const auto& chunk : m_Chunks)
+    {
+        if (!frustum.IsVisible(chunk.bounds))
+            continue;
+        DrawCommand command;
+        command.va = &m_Arena->GetVertexArray(chunk.mesh);
+        command.ib = &m_Arena->GetIndexBuffer(chunk.mesh);
+        command.count = chunk.mesh.indexCount;
+        command.firstIndex = chunk.mesh.firstIndex;
+        command.baseVertex = chunk.mesh.baseVertex;
+        command.shader = &shader;
+        command.mvp = viewProj;
+        queue.Submit(RenderPass::Opaque, command, glm::length((chunk.bounds.min + chunk.bounds.max) * 0.5f - cameraPos));
+        m_VisibleCount++;
+    }
+    return m_VisibleCount;
+}
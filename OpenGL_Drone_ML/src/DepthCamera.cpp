@@ -0,0 +1,134 @@
+#include "DepthCamera.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "GLState.h"
+#include "GPUProfiler.h"
+#include "glm/gtc/matrix_transform.hpp"
+
+DepthCamera::DepthCamera(int resolution, float extent, float range)
+    : m_Target(resolution, resolution, false), m_Shader(Shader::Get("res/shaders/Depth.shader")),
+      m_Resolution(resolution), m_Extent(extent), m_Range(range), m_Next(0), m_Dropped(0), m_Position(0.0f)
+{
+    for (Slot& slot : m_Slots)
+    {
+        GLCall(glGenBuffers(1, &slot.buffer));
+        GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        GLCall(glBufferData(GL_PIXEL_PACK_BUFFER, (size_t)resolution * resolution * sizeof(float), nullptr, GL_STREAM_READ));
+    }
+    GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+DepthCamera::~DepthCamera()
+{
+    for (Slot& slot : m_Slots)
+    {
+        if (slot.fence)
+        {
+            GLCall(glDeleteSync(slot.fence));
+        }
+        GLState::OnDeleteBuffer(slot.buffer);
+        GLCall(glDeleteBuffers(1, &slot.buffer));
+    }
+}
+
+void DepthCamera::Capture(const glm::vec3& position, const std::function<void(Shader& shader, const glm::mat4& viewProj)>& draw)
+{
+    Slot& slot = m_Slots[m_Next];
+    if (slot.fence)
+    {
+        // Still not read a whole ring later, a newer capture is worth more than waiting for it
+        GLCall(glDeleteSync(slot.fence));
+        slot.fence = nullptr;
+        m_InFlight.pop_front();
+        m_Dropped++;
+    }
+
+    GPUScope scope("Depth camera");
+    GLint framebuffer = 0, viewport[4];
+    GLCall(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer));
+    GLCall(glGetIntegerv(GL_VIEWPORT, viewport));
+
+    // Straight down with -z up the image, so image x is world x
+    const float half = m_Extent * 0.5f;
+    const glm::mat4 viewProj = glm::ortho(-half, half, -half, half, 0.0f, m_Range) *
+        glm::lookAt(position, position - glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+
+    m_Target.Bind();
+    GLState::SetDepthTest(true);
+    GLState::SetDepthMask(true);
+    GLCall(glClear(GL_DEPTH_BUFFER_BIT));
+    m_Shader->Bind();
+    draw(*m_Shader, viewProj);
+
+    GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    GLCall(glReadPixels(0, 0, m_Resolution, m_Resolution, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr));
+    GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    GLCall(slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    slot.position = position;
+    m_InFlight.push_back(m_Next);
+    m_Next = (m_Next + 1) % RING;
+
+    GLState::BindFramebuffer((unsigned int)framebuffer);
+    GLCall(glViewport(viewport[0], viewport[1], viewport[2], viewport[3]));
+}
+
+bool DepthCamera::Poll()
+{
+    // Only the newest finished capture is converted, older ones would be overwritten anyway
+    Slot* newest = nullptr;
+    while (!m_InFlight.empty())
+    {
+        Slot& slot = m_Slots[m_InFlight.front()];
+        GLCall(GLenum status = glClientWaitSync(slot.fence, 0, 0));
+        if (status == GL_TIMEOUT_EXPIRED)
+            break;
+        GLCall(glDeleteSync(slot.fence));
+        slot.fence = nullptr;
+        m_InFlight.pop_front();
+        newest = &slot;
+    }
+    if (!newest)
+        return false;
+
+    const size_t count = (size_t)m_Resolution * m_Resolution;
+    m_Heights.resize(count);
+    GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, newest->buffer);
+    GLCall(const float* depth = (const float*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, count * sizeof(float), GL_MAP_READ_BIT));
+    if (depth)
+    {
+        // Orthographic depth is already linear, 0 at the sensor and 1 at range
+        for (size_t i = 0; i < count; i++)
+            m_Heights[i] = depth[i] < 1.0f ? newest->position.y - depth[i] * m_Range : NO_HIT;
+        GLCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+    }
+    else
+    {
+        std::fill(m_Heights.begin(), m_Heights.end(), NO_HIT);
+    }
+    GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_Position = newest->position;
+    return true;
+}
+
+std::vector<std::vector<float>> DepthCamera::SampleGrid(int gridSize, float spacing) const
+{
+    std::vector<std::vector<float>> grid(gridSize, std::vector<float>(gridSize, NO_HIT));
+    if (m_Heights.empty())
+        return grid;
+
+    const float half = (gridSize - 1) / 2.0f;
+    for (int i = 0; i < gridSize; i++)
+    {
+        for (int j = 0; j < gridSize; j++)
+        {
+            const float dx = (j - half) * spacing, dz = (i - half) * spacing;
+            const int column = (int)std::floor((dx / m_Extent + 0.5f) * m_Resolution);
+            const int row = (int)std::floor((0.5f - dz / m_Extent) * m_Resolution);
+            if (column >= 0 && column < m_Resolution && row >= 0 && row < m_Resolution)
+                grid[i][j] = m_Heights[(size_t)row * m_Resolution + column];
+        }
+    }
+    return grid;
+}
@@ -0,0 +1,281 @@
+#include "FrameCapture.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#include "GLState.h"
+
+FrameCapture::FrameCapture(const std::string& directory, Format format, int width, int height)
+    : m_Directory(directory), m_Format(format), m_Width(width), m_Height(height), m_Next(0),
+      m_Encoding(0), m_Stop(false)
+{
+    std::error_code error;
+    std::filesystem::create_directories(m_Directory, error);
+    if (m_Format == Format::Raw)
+    {
+        m_RawFile.open(m_Directory + "/frames.rgba", std::ios::binary | std::ios::trunc);
+        if (!m_RawFile)
+            std::cout << "Frame capture: can't open " << m_Directory << "/frames.rgba" << std::endl;
+    }
+
+    const size_t size = (size_t)width * height * 4;
+    for (Slot& slot : m_Slots)
+    {
+        GLCall(glGenBuffers(1, &slot.buffer));
+        GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        GLCall(glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ));
+    }
+    GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_Encoder = std::thread(&FrameCapture::EncoderMain, this);
+}
+
+FrameCapture::~FrameCapture()
+{
+    Finish();
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Wake.notify_all();
+    m_Encoder.join();
+
+    for (Slot& slot : m_Slots)
+    {
+        GLState::OnDeleteBuffer(slot.buffer);
+        GLCall(glDeleteBuffers(1, &slot.buffer));
+    }
+}
+
+void FrameCapture::Capture()
+{
+    Slot& slot = m_Slots[m_Next];
+    if (slot.fence && !Collect(false))
+    {
+        // The GPU is a whole ring behind
+        m_Stats.stalls++;
+        Collect(true);
+    }
+
+    // With a pack buffer bound the pixels land in it and glReadPixels returns straight away
+    GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+    GLCall(glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+    GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    GLCall(slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    GLCall(glFlush()); // without a swap nothing else submits the fence
+    m_InFlight.push_back(m_Next);
+    m_Next = (m_Next + 1) % RING;
+    m_Stats.captured++;
+
+    // Whatever is already done goes to the encoder now rather than when its slot comes round
+    while (Collect(false))
+        ;
+}
+
+bool FrameCapture::Collect(bool wait)
+{
+    if (m_InFlight.empty())
+        return false;
+    Slot& slot = m_Slots[m_InFlight.front()];
+    GLCall(GLenum status = glClientWaitSync(slot.fence, 0, 0));
+    if (status == GL_TIMEOUT_EXPIRED)
+    {
+        if (!wait)
+            return false;
+        do
+        {
+            GLCall(status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000)); // 1 s
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    GLCall(glDeleteSync(slot.fence));
+    slot.fence = nullptr;
+    m_InFlight.pop_front();
+
+    std::vector<unsigned char> pixels;
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        if (m_Queue.size() >= MAX_QUEUED)
+        {
+            // The disk can't keep up, better to slow down than to run out of memory
+            m_Stats.stalls++;
+            m_Done.wait(lock, [this] { return m_Queue.size() < MAX_QUEUED; });
+        }
+        if (!m_Free.empty())
+        {
+            pixels = std::move(m_Free.back());
+            m_Free.pop_back();
+        }
+    }
+
+    const size_t size = (size_t)m_Width * m_Height * 4;
+    pixels.resize(size);
+    GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    GLCall(const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+    if (mapped)
+    {
+        std::memcpy(pixels.data(), mapped, size);
+        GLCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+    }
+    else
+    {
+        GLCall(glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, size, pixels.data()));
+    }
+    GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Queue.push_back(std::move(pixels));
+    }
+    m_Wake.notify_one();
+    return true;
+}
+
+void FrameCapture::Finish()
+{
+    while (Collect(true))
+        ;
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Done.wait(lock, [this] { return m_Queue.empty() && m_Encoding == 0; });
+    if (m_RawFile.is_open())
+        m_RawFile.flush();
+}
+
+FrameCapture::Stats FrameCapture::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void FrameCapture::EncoderMain()
+{
+    while (true)
+    {
+        std::vector<unsigned char> pixels;
+        unsigned int index;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Wake.wait(lock, [this] { return m_Stop || !m_Queue.empty(); });
+            if (m_Queue.empty())
+                return; // stopping, and everything is written
+            pixels = std::move(m_Queue.front());
+            m_Queue.pop_front();
+            m_Encoding++;
+            index = m_Stats.written; // the one encoder writes in queue order
+        }
+        m_Done.notify_all(); // room in the queue
+
+        Write(pixels, index);
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Encoding--;
+            m_Stats.written++;
+            m_Free.push_back(std::move(pixels));
+        }
+        m_Done.notify_all();
+    }
+}
+
+// Standard PNG/zlib CRC, continued from crc
+static uint32_t Crc32(const unsigned char* data, size_t size, uint32_t crc = 0)
+{
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> entries;
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entries[i] = c;
+        }
+        return entries;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void PutBigEndian(std::vector<unsigned char>& out, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back((value >> shift) & 0xFF);
+}
+
+static void WriteChunk(std::ofstream& file, const char* type, const unsigned char* data, size_t size)
+{
+    std::vector<unsigned char> header;
+    PutBigEndian(header, (uint32_t)size);
+    header.insert(header.end(), type, type + 4);
+    std::vector<unsigned char> footer;
+    PutBigEndian(footer, Crc32(data, size, Crc32(header.data() + 4, 4)));
+    file.write((const char*)header.data(), header.size());
+    file.write((const char*)data, size);
+    file.write((const char*)footer.data(), footer.size());
+}
+
+void FrameCapture::Write(const std::vector<unsigned char>& pixels, unsigned int index)
+{
+    const size_t rowBytes = (size_t)m_Width * 4;
+    if (m_Format == Format::Raw)
+    {
+        // GL reads bottom up, video is top down
+        for (int y = m_Height - 1; y >= 0; y--)
+            m_RawFile.write((const char*)pixels.data() + rowBytes * y, rowBytes);
+        return;
+    }
+
+    // The image data as a zlib stream of stored (uncompressed) deflate blocks: the encoder
+    // thread keeps up with rendering, frames can be compressed later. Each row starts with
+    // filter type 0
+    const size_t rawSize = (rowBytes + 1) * m_Height;
+    m_Encoded.clear();
+    m_Encoded.reserve(rawSize + rawSize / 65535 * 5 + 16);
+    m_Encoded.push_back(0x78);
+    m_Encoded.push_back(0x01);
+    uint32_t a = 1, b = 0; // Adler-32
+    size_t blockLeft = 0, remaining = rawSize;
+    for (int y = m_Height - 1; y >= 0; y--)
+    {
+        const unsigned char* row = pixels.data() + rowBytes * y;
+        for (size_t i = 0; i <= rowBytes; i++)
+        {
+            if (blockLeft == 0)
+            {
+                blockLeft = std::min<size_t>(remaining, 65535);
+                m_Encoded.push_back(remaining == blockLeft ? 1 : 0); // last block
+                m_Encoded.push_back(blockLeft & 0xFF);
+                m_Encoded.push_back(blockLeft >> 8);
+                m_Encoded.push_back(~blockLeft & 0xFF);
+                m_Encoded.push_back((~blockLeft >> 8) & 0xFF);
+            }
+            const unsigned char byte = i == 0 ? 0 : row[i - 1];
+            m_Encoded.push_back(byte);
+            a = (a + byte) % 65521;
+            b = (b + a) % 65521;
+            blockLeft--;
+            remaining--;
+        }
+    }
+    PutBigEndian(m_Encoded, (b << 16) | a);
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "/frame_%06u.png", index);
+    std::ofstream file(m_Directory + name, std::ios::binary);
+    const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    file.write((const char*)signature, sizeof(signature));
+    std::vector<unsigned char> header;
+    PutBigEndian(header, (uint32_t)m_Width);
+    PutBigEndian(header, (uint32_t)m_Height);
+    header.insert(header.end(), {8, 6, 0, 0, 0}); // 8 bit RGBA, deflate, no filter set, no interlace
+    WriteChunk(file, "IHDR", header.data(), header.size());
+    WriteChunk(file, "IDAT", m_Encoded.data(), m_Encoded.size());
+    WriteChunk(file, "IEND", nullptr, 0);
+    if (!file)
+        std::cout << "Frame capture: can't write " << m_Directory << name << std::endl;
+}
@@ -0,0 +1,58 @@
+#include "FrameUniforms.h"
+
+#include <algorithm>
+#include <cstring>
+
+FrameUniforms::FrameUniforms(unsigned int objectsPerFrame)
+    : m_Capacity(std::max(1u, objectsPerFrame)), m_Frame(0), m_Count(0)
+{
+    const unsigned int alignment = UniformBuffer::GetOffsetAlignment();
+    m_Stride = (sizeof(ObjectData) + alignment - 1) / alignment * alignment;
+
+    m_CameraBuffer = std::make_unique<UniformBuffer>(sizeof(CameraData));
+    m_CameraBuffer->BindBase(CameraBinding);
+    m_ObjectBuffer = std::make_unique<UniformBuffer>(m_Stride * m_Capacity * FRAMES);
+}
+
+void FrameUniforms::SetCamera(const glm::mat4& view, const glm::mat4& proj, const glm::vec3& position)
+{
+    CameraData camera;
+    camera.view = view;
+    camera.proj = proj;
+    camera.viewProj = proj * view;
+    camera.position = glm::vec4(position, 1.0f);
+    m_CameraBuffer->SetData(&camera, sizeof(camera));
+    m_CameraBuffer->BindBase(CameraBinding);
+}
+
+void FrameUniforms::BeginFrame()
+{
+    m_Frame = (m_Frame + 1) % FRAMES;
+    m_Count = 0;
+}
+
+unsigned int FrameUniforms::PushObject(const ObjectData& object)
+{
+    if ((m_Count + 1) * m_Stride > m_Staging.size())
+        m_Staging.resize((m_Count + 1) * m_Stride);
+    std::memcpy(&m_Staging[m_Count * m_Stride], &object, sizeof(ObjectData));
+    return m_Count++;
+}
+
+void FrameUniforms::Commit()
+{
+    if (m_Count == 0)
+        return;
+    if (m_Count > m_Capacity)
+    {
+        // Reallocating orphans the old storage, so regions in flight are safe
+        m_Capacity = std::max(m_Count, m_Capacity * 2);
+        m_ObjectBuffer->Resize(m_Stride * m_Capacity * FRAMES);
+    }
+    m_ObjectBuffer->SetData(m_Staging.data(), m_Count * m_Stride, m_Frame * m_Capacity * m_Stride);
+}
+
+void FrameUniforms::BindObject(unsigned int index) const
+{
+    m_ObjectBuffer->BindRange(ObjectBinding, (m_Frame * m_Capacity + index) * m_Stride, sizeof(ObjectData));
+}
@@ -0,0 +1,68 @@
+#include "Framebuffer.h"
+
+#include <iostream>
+
+#include "GLState.h"
+
+static unsigned int CreateAttachment(int width, int height, GLenum internalFormat, GLenum format, GLenum type)
+{
+    unsigned int texture = 0;
+    GLCall(glGenTextures(1, &texture));
+    GLState::BindTexture(GL_TEXTURE_2D, texture);
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr));
+    return texture;
+}
+
+Framebuffer::Framebuffer(int width, int height, bool color)
+    : m_RendererID(0), m_ColorAttachment(0), m_DepthAttachment(0), m_Width(width), m_Height(height)
+{
+    GLCall(glGenFramebuffers(1, &m_RendererID));
+    GLState::BindFramebuffer(m_RendererID);
+    if (color)
+    {
+        m_ColorAttachment = CreateAttachment(width, height, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+        GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_ColorAttachment, 0));
+    }
+    else
+    {
+        // Depth only, nothing to draw or read color from
+        GLCall(glDrawBuffer(GL_NONE));
+        GLCall(glReadBuffer(GL_NONE));
+    }
+    m_DepthAttachment = CreateAttachment(width, height, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT);
+    GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_DepthAttachment, 0));
+
+    GLCall(GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Framebuffer " << width << "x" << height << " is incomplete: 0x" << std::hex << status << std::dec << std::endl;
+    GLState::BindFramebuffer(0);
+}
+
+Framebuffer::~Framebuffer()
+{
+    GLState::OnDeleteFramebuffer(m_RendererID);
+    GLCall(glDeleteFramebuffers(1, &m_RendererID));
+    for (unsigned int texture : {m_ColorAttachment, m_DepthAttachment})
+    {
+        if (texture)
+        {
+            GLState::OnDeleteTexture(texture);
+            GLCall(glDeleteTextures(1, &texture));
+        }
+    }
+}
+
+void Framebuffer::Bind() const
+{
+    GLState::BindFramebuffer(m_RendererID);
+    GLCall(glViewport(0, 0, m_Width, m_Height));
+}
+
+void Framebuffer::Unbind() const
+{
+    GLState::BindFramebuffer(0);
+}
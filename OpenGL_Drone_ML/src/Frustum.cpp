@@ -0,0 +1,57 @@
+#include "Frustum.h"
+
+#include <limits>
+
+AABB::AABB()
+    : min(std::numeric_limits<float>::max()), max(-std::numeric_limits<float>::max())
+{
+}
+
+void AABB::Expand(const glm::vec3& point)
+{
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+}
+
+void AABB::Expand(const AABB& box)
+{
+    min = glm::min(min, box.min);
+    max = glm::max(max, box.max);
+}
+
+Frustum::Frustum(const glm::mat4& viewProj)
+{
+    Update(viewProj);
+}
+
+void Frustum::Update(const glm::mat4& viewProj)
+{
+    // glm is column major so row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; i++)
+        row[i] = glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+
+    m_Planes[0] = row[3] + row[0]; // left
+    m_Planes[1] = row[3] - row[0]; // right
+    m_Planes[2] = row[3] + row[1]; // bottom
+    m_Planes[3] = row[3] - row[1]; // top
+    m_Planes[4] = row[3] + row[2]; // near
+    m_Planes[5] = row[3] - row[2]; // far
+
+    for (auto& plane : m_Planes)
+        plane /= glm::length(glm::vec3(plane));
+}
+
+bool Frustum::IsVisible(const AABB& box) const
+{
+    for (const auto& plane : m_Planes)
+    {
+        // test the corner furthest along the plane normal, if even that is behind the box is out
+        glm::vec3 corner(plane.x >= 0.0f ? box.max.x : box.min.x,
+                         plane.y >= 0.0f ? box.max.y : box.min.y,
+                         plane.z >= 0.0f ? box.max.z : box.min.z);
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+            return false;
+    }
+    return true;
+}
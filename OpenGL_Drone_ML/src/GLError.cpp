@@ -1,6 +1,17 @@
 #include "GLError.h"
 #include <iostream>
 
+namespace glerror
+{
+    GLErrorMode g_Mode = GL_ERRORS_COMPILED ? GLErrorMode::Poll : GLErrorMode::Off;
+    unsigned int g_SampleRate = 64;
+    thread_local GLCallSite t_Site = {nullptr, nullptr, 0};
+    thread_local unsigned int t_Counter = 0;
+    thread_local bool t_Check = false;
+}
+
+static bool s_HasDebugOutput = false;
+
 void GLClearError()
 {
     while (glGetError() != GL_NO_ERROR);
@@ -10,9 +21,94 @@ bool GLLogCall(const char* function, const char* file, int line)
 {
     while (GLenum error = glGetError())
     {
-        std::cout << "[OpenGL Error] (" << error << "): " << function << 
-            " " << file << ":" << line << std::endl;
+        std::cout << "[OpenGL Error] (" << error << "): " << function <<
+            " " << file << ":" << line;
+        if (glerror::g_Mode == GLErrorMode::Sampled)
+            std::cout << " (sampled, raised at or before this call)";
+        std::cout << std::endl;
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
+
+static void GLAPIENTRY GLDebugCallback(GLenum /*source*/, GLenum type, GLuint id, GLenum /*severity*/,
+    GLsizei /*length*/, const GLchar* message, const void* /*userParam*/)
+{
+    const GLCallSite& site = glerror::t_Site;
+    std::cout << (type == GL_DEBUG_TYPE_ERROR ? "[OpenGL Error] (" : "[OpenGL Debug] (") << id << "): " << message;
+    // Synchronous output runs the callback inside the offending call, so the site is exact
+    if (site.function)
+        std::cout << " at " << site.function << " " << site.file << ":" << site.line;
+    std::cout << std::endl;
+
+    if (type == GL_DEBUG_TYPE_ERROR)
+        DEBUG_BREAK();
+}
+
+void GLEnableDebugOutput()
+{
+    s_HasDebugOutput = GLEW_KHR_debug || GLEW_VERSION_4_3;
+    if (!s_HasDebugOutput)
+    {
+        std::cout << "KHR_debug not supported, polling glGetError" << std::endl;
+        return;
+    }
+
+    glDebugMessageCallback(GLDebugCallback, nullptr);
+    // Notifications are buffer placement chatter from the driver, not worth the console
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+    GLSetErrorMode(GLErrorMode::Callback);
+}
+
+GLErrorMode GLSetErrorMode(GLErrorMode mode)
+{
+    if (!GL_ERRORS_COMPILED)
+        mode = GLErrorMode::Off; // GLCall is compiled out, only the callback could still fire
+    if (mode == GLErrorMode::Callback && !s_HasDebugOutput)
+        mode = GLErrorMode::Poll;
+
+    // Not GLCall, these run while the mode is changing
+    if (s_HasDebugOutput)
+    {
+        if (mode == GLErrorMode::Callback)
+        {
+            glEnable(GL_DEBUG_OUTPUT);
+            glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        }
+        else
+        {
+            glDisable(GL_DEBUG_OUTPUT);
+        }
+    }
+    GLClearError(); // start the new mode from a clean queue
+    glerror::g_Mode = mode;
+    glerror::t_Counter = 0;
+    return mode;
+}
+
+GLErrorMode GLGetErrorMode()
+{
+    return glerror::g_Mode;
+}
+
+void GLSetErrorSampleRate(unsigned int everyNthCall)
+{
+    glerror::g_SampleRate = everyNthCall > 0 ? everyNthCall : 1;
+}
+
+unsigned int GLGetErrorSampleRate()
+{
+    return glerror::g_SampleRate;
+}
+
+const char* GLErrorModeName(GLErrorMode mode)
+{
+    switch (mode)
+    {
+        case GLErrorMode::Off:      return "Off";
+        case GLErrorMode::Poll:     return "Poll";
+        case GLErrorMode::Sampled:  return "Sampled";
+        case GLErrorMode::Callback: return "Callback";
+    }
+    return "";
+}
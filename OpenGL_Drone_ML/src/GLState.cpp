@@ -0,0 +1,273 @@
+#include "GLState.h"
+
+// Starts out matching a fresh context, Invalidate() switches to "unknown"
+unsigned int GLState::s_Program = 0;
+unsigned int GLState::s_VertexArray = 0;
+unsigned int GLState::s_Buffers[GLState::BUFFER_TARGETS] = {};
+std::unordered_map<unsigned int, unsigned int> GLState::s_ElementBuffers;
+GLState::Range GLState::s_UniformRanges[GLState::UNIFORM_BINDINGS] = {};
+unsigned int GLState::s_ActiveTexture = 0;
+unsigned int GLState::s_Textures[GLState::MAX_TEXTURE_UNITS][GLState::TEXTURE_TARGETS] = {};
+unsigned int GLState::s_Framebuffer = 0;
+GLState::TriState GLState::s_Blend, GLState::s_DepthTest, GLState::s_DepthMask;
+GLenum GLState::s_BlendSrc = GLState::UNKNOWN, GLState::s_BlendDst = GLState::UNKNOWN, GLState::s_DepthFunc = GLState::UNKNOWN;
+GLState::Stats GLState::s_Frame, GLState::s_LastFrame;
+
+static const GLenum s_BufferTargets[] = {
+    GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_TEXTURE_BUFFER, GL_PIXEL_PACK_BUFFER,
+    GL_PIXEL_UNPACK_BUFFER, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, GL_DRAW_INDIRECT_BUFFER
+};
+static_assert(sizeof(s_BufferTargets) / sizeof(GLenum) == 8, "BUFFER_TARGETS out of date");
+
+int GLState::BufferIndex(GLenum target)
+{
+    for (int i = 0; i < (int)BUFFER_TARGETS; i++)
+        if (s_BufferTargets[i] == target)
+            return i;
+    return -1;
+}
+
+int GLState::TextureIndex(GLenum target)
+{
+    switch (target)
+    {
+        case GL_TEXTURE_2D:       return 0;
+        case GL_TEXTURE_2D_ARRAY: return 1;
+        case GL_TEXTURE_BUFFER:   return 2;
+    }
+    return -1;
+}
+
+void GLState::UseProgram(unsigned int program)
+{
+    if (Changed(s_Program, program))
+    {
+        GLCall(glUseProgram(program));
+    }
+}
+
+void GLState::BindVertexArray(unsigned int vao)
+{
+    if (Changed(s_VertexArray, vao))
+    {
+        GLCall(glBindVertexArray(vao));
+    }
+}
+
+void GLState::BindBuffer(GLenum target, unsigned int buffer)
+{
+    unsigned int* cached = nullptr;
+    if (target == GL_ELEMENT_ARRAY_BUFFER)
+    {
+        // The EBO binding belongs to the VAO, so it is only known for a known VAO
+        if (s_VertexArray != UNKNOWN)
+            cached = &s_ElementBuffers.emplace(s_VertexArray, UNKNOWN).first->second;
+    }
+    else
+    {
+        int index = BufferIndex(target);
+        if (index >= 0)
+            cached = &s_Buffers[index];
+    }
+
+    if (!cached)
+    {
+        s_Frame.issued++;
+        GLCall(glBindBuffer(target, buffer));
+    }
+    else if (Changed(*cached, buffer))
+    {
+        GLCall(glBindBuffer(target, buffer));
+    }
+}
+
+void GLState::BindBufferRange(GLenum target, unsigned int index, unsigned int buffer, GLintptr offset, GLsizeiptr size)
+{
+    if (target == GL_UNIFORM_BUFFER && index < UNIFORM_BINDINGS)
+    {
+        Range& bound = s_UniformRanges[index];
+        if (bound.buffer == buffer && bound.offset == offset && bound.size == size)
+        {
+            s_Frame.elided++;
+            return;
+        }
+        bound = {buffer, offset, size};
+    }
+    s_Frame.issued++;
+    GLCall(glBindBufferRange(target, index, buffer, offset, size));
+
+    int generic = BufferIndex(target);
+    if (generic >= 0)
+        s_Buffers[generic] = buffer;
+}
+
+void GLState::ActiveTexture(unsigned int slot)
+{
+    if (Changed(s_ActiveTexture, slot))
+    {
+        GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+    }
+}
+
+void GLState::BindTexture(unsigned int slot, GLenum target, unsigned int texture)
+{
+    int index = TextureIndex(target);
+    if (index >= 0 && slot < MAX_TEXTURE_UNITS && s_Textures[slot][index] == texture)
+    {
+        s_Frame.elided++; // no need to even switch units
+        return;
+    }
+    ActiveTexture(slot);
+    BindTexture(target, texture);
+}
+
+void GLState::BindTexture(GLenum target, unsigned int texture)
+{
+    int index = TextureIndex(target);
+    if (index < 0 || s_ActiveTexture >= MAX_TEXTURE_UNITS)
+    {
+        s_Frame.issued++;
+        GLCall(glBindTexture(target, texture));
+    }
+    else if (Changed(s_Textures[s_ActiveTexture][index], texture))
+    {
+        GLCall(glBindTexture(target, texture));
+    }
+}
+
+void GLState::BindFramebuffer(unsigned int framebuffer)
+{
+    if (Changed(s_Framebuffer, framebuffer))
+    {
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+    }
+}
+
+void GLState::SetCap(TriState& cached, GLenum cap, bool enabled)
+{
+    if (cached.value == (signed char)enabled)
+    {
+        s_Frame.elided++;
+        return;
+    }
+    cached.value = enabled;
+    s_Frame.issued++;
+    if (enabled)
+    {
+        GLCall(glEnable(cap));
+    }
+    else
+    {
+        GLCall(glDisable(cap));
+    }
+}
+
+void GLState::SetBlend(bool enabled)
+{
+    SetCap(s_Blend, GL_BLEND, enabled);
+}
+
+void GLState::SetBlendFunc(GLenum src, GLenum dst)
+{
+    if (s_BlendSrc == src && s_BlendDst == dst)
+    {
+        s_Frame.elided++;
+        return;
+    }
+    s_BlendSrc = src;
+    s_BlendDst = dst;
+    s_Frame.issued++;
+    GLCall(glBlendFunc(src, dst));
+}
+
+void GLState::SetDepthTest(bool enabled)
+{
+    SetCap(s_DepthTest, GL_DEPTH_TEST, enabled);
+}
+
+void GLState::SetDepthMask(bool write)
+{
+    if (s_DepthMask.value == (signed char)write)
+    {
+        s_Frame.elided++;
+        return;
+    }
+    s_DepthMask.value = write;
+    s_Frame.issued++;
+    GLCall(glDepthMask(write ? GL_TRUE : GL_FALSE));
+}
+
+void GLState::SetDepthFunc(GLenum func)
+{
+    if (Changed(s_DepthFunc, func))
+    {
+        GLCall(glDepthFunc(func));
+    }
+}
+
+void GLState::OnDeleteProgram(unsigned int program)
+{
+    // A deleted program stays in use until replaced, but its name can be reused after that
+    if (s_Program == program)
+        s_Program = UNKNOWN;
+}
+
+void GLState::OnDeleteVertexArray(unsigned int vao)
+{
+    if (s_VertexArray == vao)
+        s_VertexArray = 0;
+    s_ElementBuffers.erase(vao);
+}
+
+void GLState::OnDeleteBuffer(unsigned int buffer)
+{
+    for (unsigned int& bound : s_Buffers)
+        if (bound == buffer)
+            bound = 0;
+    for (Range& range : s_UniformRanges)
+        if (range.buffer == buffer)
+            range = {0, 0, 0};
+    // Other VAOs keep the orphaned buffer attached, so a reused name must not look current
+    for (auto& entry : s_ElementBuffers)
+        if (entry.second == buffer)
+            entry.second = entry.first == s_VertexArray ? 0 : UNKNOWN;
+}
+
+void GLState::OnDeleteTexture(unsigned int texture)
+{
+    for (auto& unit : s_Textures)
+        for (unsigned int& bound : unit)
+            if (bound == texture)
+                bound = 0;
+}
+
+void GLState::OnDeleteFramebuffer(unsigned int framebuffer)
+{
+    if (s_Framebuffer == framebuffer)
+        s_Framebuffer = 0;
+}
+
+void GLState::Invalidate()
+{
+    s_Program = UNKNOWN;
+    s_VertexArray = UNKNOWN;
+    for (unsigned int& bound : s_Buffers)
+        bound = UNKNOWN;
+    s_ElementBuffers.clear();
+    for (Range& range : s_UniformRanges)
+        range = {UNKNOWN, 0, 0};
+    s_ActiveTexture = UNKNOWN;
+    for (auto& unit : s_Textures)
+        for (unsigned int& bound : unit)
+            bound = UNKNOWN;
+    s_Framebuffer = UNKNOWN;
+    s_Blend = s_DepthTest = s_DepthMask = TriState();
+    s_BlendSrc = s_BlendDst = s_DepthFunc = UNKNOWN;
+}
+
+GLState::Stats GLState::NewFrame()
+{
+    s_LastFrame = s_Frame;
+    s_Frame = Stats();
+    return s_LastFrame;
+}
@@ -0,0 +1,201 @@
+#include "GPUProfiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#include "imgui.h"
+
+static const unsigned int NOT_ENDED = 0xFFFFFFFF;
+
+GPUProfiler::Frame GPUProfiler::s_Frames[FRAMES];
+unsigned int GPUProfiler::s_Current = 0;
+std::vector<unsigned int> GPUProfiler::s_Open;
+bool GPUProfiler::s_Enabled = true, GPUProfiler::s_PendingEnabled = true;
+std::vector<GPUProfiler::History> GPUProfiler::s_History;
+std::vector<GPUProfiler::Result> GPUProfiler::s_Results;
+unsigned int GPUProfiler::s_Resolved = 0;
+unsigned int GPUProfiler::s_Dropped = 0;
+
+void GPUProfiler::NewFrame()
+{
+    s_Open.clear(); // scopes left open are skipped when resolved
+    s_Current = (s_Current + 1) % FRAMES;
+    Frame& frame = s_Frames[s_Current];
+    Resolve(frame);
+    frame.used = 0;
+    frame.records.clear();
+    s_Enabled = s_PendingEnabled;
+}
+
+void GPUProfiler::Begin(const char* name)
+{
+    if (!s_Enabled)
+        return;
+    Frame& frame = s_Frames[s_Current];
+    Record record = {name, (unsigned int)s_Open.size(), Query(frame), NOT_ENDED};
+    GLCall(glQueryCounter(frame.queries[record.begin], GL_TIMESTAMP));
+    s_Open.push_back((unsigned int)frame.records.size());
+    frame.records.push_back(record);
+}
+
+void GPUProfiler::End()
+{
+    if (!s_Enabled || s_Open.empty())
+        return;
+    Frame& frame = s_Frames[s_Current];
+    Record& record = frame.records[s_Open.back()];
+    s_Open.pop_back();
+    record.end = Query(frame);
+    GLCall(glQueryCounter(frame.queries[record.end], GL_TIMESTAMP));
+}
+
+void GPUProfiler::SetEnabled(bool enabled)
+{
+    s_PendingEnabled = enabled;
+}
+
+unsigned int GPUProfiler::Query(Frame& frame)
+{
+    if (frame.used == frame.queries.size())
+    {
+        const unsigned int grow = 16;
+        frame.queries.resize(frame.queries.size() + grow);
+        GLCall(glGenQueries(grow, &frame.queries[frame.used]));
+    }
+    return frame.used++;
+}
+
+void GPUProfiler::Resolve(Frame& frame)
+{
+    if (frame.records.empty())
+        return;
+
+    // Queries complete in order, if the last one is ready they all are
+    GLint available = 0;
+    GLCall(glGetQueryObjectiv(frame.queries[frame.used - 1], GL_QUERY_RESULT_AVAILABLE, &available));
+    if (!available)
+    {
+        s_Dropped++;
+        return;
+    }
+
+    const unsigned int slot = s_Resolved % HISTORY;
+    for (History& history : s_History)
+        history.samples[slot] = 0.0f;
+    s_Results.clear();
+
+    // A name used more than once in a frame adds up
+    for (const Record& record : frame.records)
+    {
+        if (record.end == NOT_ENDED)
+            continue;
+        GLuint64 begin = 0, end = 0;
+        GLCall(glGetQueryObjectui64v(frame.queries[record.begin], GL_QUERY_RESULT, &begin));
+        GLCall(glGetQueryObjectui64v(frame.queries[record.end], GL_QUERY_RESULT, &end));
+        const float ms = end > begin ? (float)(end - begin) / 1000000.0f : 0.0f;
+
+        FindHistory(record.name).samples[slot] += ms;
+        auto result = std::find_if(s_Results.begin(), s_Results.end(),
+            [&](const Result& r) { return r.name == record.name; });
+        if (result == s_Results.end())
+        {
+            s_Results.push_back({record.name, record.depth, 0.0f, 0.0f, 0.0f});
+            result = s_Results.end() - 1;
+        }
+        result->ms += ms;
+    }
+    s_Resolved++;
+
+    const unsigned int count = std::min(s_Resolved, HISTORY);
+    for (Result& result : s_Results)
+    {
+        const History& history = FindHistory(result.name.c_str());
+        float sum = 0.0f;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            sum += history.samples[i];
+            result.peak = std::max(result.peak, history.samples[i]);
+        }
+        result.average = sum / count;
+    }
+}
+
+GPUProfiler::History& GPUProfiler::FindHistory(const char* name)
+{
+    for (History& history : s_History)
+        if (history.name == name)
+            return history;
+    s_History.push_back({name, std::vector<float>(HISTORY, 0.0f)});
+    return s_History.back();
+}
+
+bool GPUProfiler::ExportCSV(const std::string& filepath)
+{
+    std::ofstream file(filepath);
+    if (!file)
+        return false;
+
+    file << "frame";
+    for (const History& history : s_History)
+        file << "," << history.name;
+    file << "\n";
+
+    const unsigned int first = s_Resolved > HISTORY ? s_Resolved - HISTORY : 0;
+    for (unsigned int frame = first; frame < s_Resolved; frame++)
+    {
+        file << frame;
+        for (const History& history : s_History)
+            file << "," << history.samples[frame % HISTORY];
+        file << "\n";
+    }
+    return (bool)file;
+}
+
+void GPUProfiler::OnImGuiRender()
+{
+    static std::string s_ExportStatus;
+
+    bool enabled = s_PendingEnabled;
+    if (ImGui::Checkbox("Enabled", &enabled))
+        SetEnabled(enabled);
+    ImGui::SameLine();
+    if (ImGui::Button("Export CSV"))
+    {
+        const char* path = "gpu_profile.csv";
+        s_ExportStatus = ExportCSV(path) ? std::string("Wrote ") + path : std::string("Could not write ") + path;
+    }
+    if (!s_ExportStatus.empty())
+    {
+        ImGui::SameLine();
+        ImGui::TextUnformatted(s_ExportStatus.c_str());
+    }
+    ImGui::Text("Dropped frames: %u (queries not ready after %u frames)", s_Dropped, FRAMES);
+
+    for (const Result& result : s_Results)
+    {
+        const History& history = FindHistory(result.name.c_str());
+        char overlay[64];
+        std::snprintf(overlay, sizeof(overlay), "%.3f ms  avg %.3f  peak %.3f", result.ms, result.average, result.peak);
+        const float indent = result.depth * 12.0f;
+        if (indent > 0.0f)
+            ImGui::Indent(indent);
+        ImGui::PlotLines(result.name.c_str(), history.samples.data(), (int)HISTORY, (int)(s_Resolved % HISTORY),
+            overlay, 0.0f, std::max(result.peak, 0.001f), ImVec2(0.0f, 40.0f));
+        if (indent > 0.0f)
+            ImGui::Unindent(indent);
+    }
+}
+
+void GPUProfiler::Shutdown()
+{
+    for (Frame& frame : s_Frames)
+    {
+        if (!frame.queries.empty())
+        {
+            GLCall(glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data()));
+        }
+        frame = Frame();
+    }
+    s_Open.clear();
+}
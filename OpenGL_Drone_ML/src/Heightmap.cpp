@@ -0,0 +1,235 @@
+#include "Heightmap.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+Heightmap::Heightmap(unsigned int width, unsigned int height, float spacing, const float* heights)
+    : m_Width(width), m_Height(height), m_Spacing(spacing), m_Format(HeightFormat::UInt16),
+      m_Scale(1.0f), m_Offset(0.0f), m_MinHeight(0.0f), m_MaxHeight(0.0f), m_Data(nullptr)
+{
+    const std::size_t count = (std::size_t)width * height;
+    m_Storage.resize(count * sizeof(std::uint16_t));
+    m_Data = m_Storage.data();
+    if (count == 0)
+        return;
+
+    auto range = std::minmax_element(heights, heights + count);
+    m_MinHeight = *range.first;
+    m_MaxHeight = std::max(*range.second, m_MinHeight + 1e-3f); // flat maps still need a non-zero step
+    m_Scale = (m_MaxHeight - m_MinHeight) / 65535.0f;
+    m_Offset = m_MinHeight;
+
+    std::uint16_t* samples = reinterpret_cast<std::uint16_t*>(m_Storage.data());
+    for (std::size_t i = 0; i < count; i++)
+        samples[i] = (std::uint16_t)std::lround((heights[i] - m_Offset) / m_Scale);
+}
+
+Heightmap::Heightmap(unsigned int width, unsigned int height, float spacing, HeightFormat format, float scale, float offset, std::vector<unsigned char> samples)
+    : m_Width(width), m_Height(height), m_Spacing(spacing), m_Format(format), m_Scale(scale), m_Offset(offset),
+      m_MinHeight(0.0f), m_MaxHeight(0.0f), m_Storage(std::move(samples))
+{
+    m_Storage.resize((std::size_t)width * height * GetBytesPerSample());
+    m_Data = m_Storage.data();
+    ComputeRange();
+}
+
+Heightmap::Heightmap(unsigned int width, unsigned int height, float spacing, HeightFormat format, float scale, float offset,
+    std::unique_ptr<MappedFile> file, std::size_t dataOffset)
+    : m_Width(width), m_Height(height), m_Spacing(spacing), m_Format(format), m_Scale(scale), m_Offset(offset),
+      m_MinHeight(0.0f), m_MaxHeight(0.0f), m_Data(file->GetData() + dataOffset), m_File(std::move(file))
+{
+}
+
+void Heightmap::ComputeRange()
+{
+    m_MinHeight = FLT_MAX;
+    m_MaxHeight = -FLT_MAX;
+    for (unsigned int z = 0; z < m_Height; z++)
+    {
+        for (unsigned int x = 0; x < m_Width; x++)
+        {
+            float h = GetSample(x, z);
+            m_MinHeight = std::min(m_MinHeight, h);
+            m_MaxHeight = std::max(m_MaxHeight, h);
+        }
+    }
+    if (m_MinHeight > m_MaxHeight)
+        m_MinHeight = m_MaxHeight = m_Offset;
+}
+
+void Heightmap::SetMappedRange(float minHeight, float maxHeight, const std::string& path)
+{
+    if (minHeight <= maxHeight)
+    {
+        m_MinHeight = minHeight;
+        m_MaxHeight = maxHeight;
+    }
+    else if (m_Format == HeightFormat::UInt16)
+    {
+        // Everything 16 bits can hold, loose but it costs no reads
+        const float low = m_Offset, high = 65535.0f * m_Scale + m_Offset;
+        m_MinHeight = std::min(low, high);
+        m_MaxHeight = std::max(low, high);
+    }
+    else
+    {
+        // Floats have no bound, every page has to be read once
+        std::cout << "Heightmap: " << path << " has no height range, reading all of it. Set the import range, "
+            << "or convert it once to .dhm with Heightmap::Write" << std::endl;
+        ComputeRange();
+    }
+}
+
+// Skips whitespace and # comments between PGM header fields
+static bool ReadPGMField(const unsigned char* data, std::size_t size, std::size_t& pos, unsigned int& value)
+{
+    while (pos < size && (std::isspace(data[pos]) || data[pos] == '#'))
+    {
+        if (data[pos] == '#')
+            while (pos < size && data[pos] != '\n')
+                pos++;
+        else
+            pos++;
+    }
+    if (pos >= size || !std::isdigit(data[pos]))
+        return false;
+    value = 0;
+    while (pos < size && std::isdigit(data[pos]))
+        value = value * 10 + (data[pos++] - '0');
+    return true;
+}
+
+std::unique_ptr<Heightmap> Heightmap::Load(const std::string& path, const HeightmapImport& import)
+{
+    auto file = std::make_unique<MappedFile>(path);
+    if (!file->IsOpen())
+    {
+        std::cout << "Heightmap: could not open " << path << std::endl;
+        return nullptr;
+    }
+    const unsigned char* data = file->GetData();
+    const std::size_t size = file->GetSize();
+
+    // DHM1: everything in the header, samples mapped as they are
+    if (size >= sizeof(DHMHeader) && std::memcmp(data, "DHM1", 4) == 0)
+    {
+        DHMHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        HeightFormat format = header.format == 1 ? HeightFormat::Float32 : HeightFormat::UInt16;
+        std::uint64_t bytes = (std::uint64_t)header.width * header.height * (format == HeightFormat::UInt16 ? 2 : 4);
+        if (header.width < 2 || header.height < 2 || header.dataOffset % 4 != 0 || header.dataOffset + bytes > size)
+        {
+            std::cout << "Heightmap: " << path << " is truncated or corrupt" << std::endl;
+            return nullptr;
+        }
+
+        auto heightmap = std::make_unique<Heightmap>(header.width, header.height, header.spacing, format, header.scale, header.offset, std::move(file), header.dataOffset);
+        heightmap->SetMappedRange(header.minHeight, header.maxHeight, path);
+        return heightmap;
+    }
+
+    // PGM: big endian samples, so 16 bit maps are swapped into memory rather than mapped
+    if (size >= 2 && data[0] == 'P' && data[1] == '5')
+    {
+        std::size_t pos = 2;
+        unsigned int width, height, maxValue;
+        if (!ReadPGMField(data, size, pos, width) || !ReadPGMField(data, size, pos, height) || !ReadPGMField(data, size, pos, maxValue))
+        {
+            std::cout << "Heightmap: bad PGM header in " << path << std::endl;
+            return nullptr;
+        }
+        pos++; // single whitespace before the raster
+
+        const unsigned int bytesPerSample = maxValue > 255 ? 2 : 1;
+        const std::size_t count = (std::size_t)width * height;
+        if (width < 2 || height < 2 || pos + count * bytesPerSample > size)
+        {
+            std::cout << "Heightmap: " << path << " is truncated" << std::endl;
+            return nullptr;
+        }
+
+        std::vector<unsigned char> samples(count * sizeof(std::uint16_t));
+        std::uint16_t* out = reinterpret_cast<std::uint16_t*>(samples.data());
+        const unsigned char* raster = data + pos;
+        for (std::size_t i = 0; i < count; i++)
+            out[i] = bytesPerSample == 2 ? (std::uint16_t)((raster[i * 2] << 8) | raster[i * 2 + 1]) : raster[i];
+        return std::make_unique<Heightmap>(width, height, import.spacing, HeightFormat::UInt16, import.scale, import.offset, std::move(samples));
+    }
+
+    // RAW: headerless little endian samples, dimensions come from the import settings
+    std::string extension = path.substr(path.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    HeightFormat format = (extension == "r32" || extension == "f32") ? HeightFormat::Float32 : HeightFormat::UInt16;
+    const std::size_t bytesPerSample = format == HeightFormat::UInt16 ? 2 : 4;
+
+    unsigned int width = import.width, height = import.height;
+    if (width == 0 || height == 0)
+    {
+        width = height = (unsigned int)std::llround(std::sqrt((double)(size / bytesPerSample)));
+        if ((std::size_t)width * height * bytesPerSample != size)
+        {
+            std::cout << "Heightmap: " << path << " is not square, set the RAW width and height" << std::endl;
+            return nullptr;
+        }
+    }
+    if (width < 2 || height < 2 || (std::size_t)width * height * bytesPerSample > size)
+    {
+        std::cout << "Heightmap: " << path << " is smaller than " << width << "x" << height << std::endl;
+        return nullptr;
+    }
+
+    auto heightmap = std::make_unique<Heightmap>(width, height, import.spacing, format, import.scale, import.offset, std::move(file), 0);
+    heightmap->SetMappedRange(import.minHeight, import.maxHeight, path);
+    return heightmap;
+}
+
+bool Heightmap::Write(const std::string& path, const Heightmap& heightmap)
+{
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream)
+        return false;
+
+    DHMHeader header = {};
+    std::memcpy(header.magic, "DHM1", 4);
+    header.width = heightmap.m_Width;
+    header.height = heightmap.m_Height;
+    header.format = (std::uint32_t)heightmap.m_Format;
+    header.spacing = heightmap.m_Spacing;
+    header.scale = heightmap.m_Scale;
+    header.offset = heightmap.m_Offset;
+    header.minHeight = heightmap.m_MinHeight;
+    header.maxHeight = heightmap.m_MaxHeight;
+    header.dataOffset = sizeof(DHMHeader);
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(static_cast<const char*>(heightmap.m_Data), (std::streamsize)heightmap.m_Width * heightmap.m_Height * heightmap.GetBytesPerSample());
+    return stream.good();
+}
+
+float Heightmap::Sample(float worldX, float worldZ) const
+{
+    if (!m_Data || m_Width == 0 || m_Height == 0)
+        return 0.0f;
+
+    float fx = std::clamp(worldX / m_Spacing, 0.0f, (float)(m_Width - 1));
+    float fz = std::clamp(worldZ / m_Spacing, 0.0f, (float)(m_Height - 1));
+    unsigned int x0 = std::min((unsigned int)fx, m_Width > 1 ? m_Width - 2 : 0);
+    unsigned int z0 = std::min((unsigned int)fz, m_Height > 1 ? m_Height - 2 : 0);
+    unsigned int x1 = std::min(x0 + 1, m_Width - 1);
+    unsigned int z1 = std::min(z0 + 1, m_Height - 1);
+    float tx = fx - x0, tz = fz - z0;
+
+    float a = GetSample(x0, z0), b = GetSample(x1, z0);
+    float c = GetSample(x0, z1), d = GetSample(x1, z1);
+    return (a + (b - a) * tx) + ((c + (d - c) * tx) - (a + (b - a) * tx)) * tz;
+}
+
+bool Heightmap::Contains(float worldX, float worldZ) const
+{
+    return worldX >= 0.0f && worldZ >= 0.0f && worldX <= GetWorldWidth() && worldZ <= GetWorldDepth();
+}
@@ -0,0 +1,73 @@
+#include "HeightmapTileSource.h"
+
+#include <algorithm>
+
+HeightmapTileSource::HeightmapTileSource(std::shared_ptr<const Heightmap> heightmap, unsigned int resolution)
+    : m_Heightmap(std::move(heightmap)), m_Resolution(std::max(1u, resolution))
+{
+    m_TilesX = (int)((m_Heightmap->GetWidth() - 1 + m_Resolution - 1) / m_Resolution);
+    m_TilesZ = (int)((m_Heightmap->GetHeight() - 1 + m_Resolution - 1) / m_Resolution);
+}
+
+bool HeightmapTileSource::HasTile(int gridX, int gridZ) const
+{
+    return gridX >= 0 && gridZ >= 0 && gridX < m_TilesX && gridZ < m_TilesZ;
+}
+
+bool HeightmapTileSource::LoadTile(int gridX, int gridZ, TerrainTile& out) const
+{
+    if (!HasTile(gridX, gridZ))
+        return false;
+
+    const Heightmap& map = *m_Heightmap;
+    const unsigned int lastX = map.GetWidth() - 1, lastZ = map.GetHeight() - 1;
+    const unsigned int firstX = gridX * m_Resolution, firstZ = gridZ * m_Resolution;
+    const unsigned int sideX = std::min(m_Resolution, lastX - firstX) + 1; // edge tiles can be smaller
+    const unsigned int sideZ = std::min(m_Resolution, lastZ - firstZ) + 1;
+    const float spacing = map.GetSpacing();
+    const float range = std::max(map.GetMaxHeight() - map.GetMinHeight(), 1e-3f);
+
+    out.gridX = gridX;
+    out.gridZ = gridZ;
+    out.bounds = AABB();
+    out.vertices.resize(sideX * sideZ * sizeof(TerrainVertex));
+    TerrainVertex* vertices = reinterpret_cast<TerrainVertex*>(out.vertices.data());
+
+    for (unsigned int z = 0; z < sideZ; z++)
+    {
+        for (unsigned int x = 0; x < sideX; x++)
+        {
+            // Central differences, clamped at the map border, so normals agree across tiles
+            unsigned int sx = firstX + x, sz = firstZ + z;
+            float h = map.GetSample(sx, sz);
+            float dx = map.GetSample(sx > 0 ? sx - 1 : sx, sz) - map.GetSample(std::min(sx + 1, lastX), sz);
+            float dz = map.GetSample(sx, sz > 0 ? sz - 1 : sz) - map.GetSample(sx, std::min(sz + 1, lastZ));
+            glm::vec3 normal = glm::normalize(glm::vec3(dx, 2.0f * spacing, dz));
+            glm::vec3 color = TerrainColor((h - map.GetMinHeight()) / range, normal);
+
+            TerrainVertex& v = vertices[z * sideX + x];
+            v.x = sx * spacing;
+            v.y = h;
+            v.z = sz * spacing;
+            v.r = color.r;
+            v.g = color.g;
+            v.b = color.b;
+            v.u = (float)x / m_Resolution;
+            v.v = (float)z / m_Resolution;
+            v.texSlot = -1.0f;
+            out.bounds.Expand(glm::vec3(v.x, v.y, v.z));
+        }
+    }
+
+    out.indices.clear();
+    out.indices.reserve((sideX - 1) * (sideZ - 1) * 6);
+    for (unsigned int z = 0; z + 1 < sideZ; z++)
+    {
+        for (unsigned int x = 0; x + 1 < sideX; x++)
+        {
+            unsigned int a = z * sideX + x;
+            out.indices.insert(out.indices.end(), {a, a + sideX, a + sideX + 1, a + sideX + 1, a + 1, a});
+        }
+    }
+    return true;
+}
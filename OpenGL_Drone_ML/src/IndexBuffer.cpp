@@ -1,37 +1,100 @@
 #include "IndexBuffer.h"
-#include "GLError.h"
+#include "GLState.h"
+#include "VertexBuffer.h"
+
+#include <algorithm>
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
-    : m_Count(count)
+    : m_Count(count), m_Capacity(count), m_Usage(GL_STATIC_DRAW)
 {
     ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
     GLCall(glGenBuffers(1, &m_RendererID));
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+    GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
     GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
 }
 
-IndexBuffer::IndexBuffer(unsigned int count)
-    : m_Count(count)
+IndexBuffer::IndexBuffer(unsigned int capacity)
+    : m_Count(0), m_Capacity(capacity), m_Usage(GL_DYNAMIC_DRAW)
 {
     ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
     GLCall(glGenBuffers(1, &m_RendererID));
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
-    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), nullptr, GL_DYNAMIC_DRAW));
+    GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, capacity * sizeof(unsigned int), nullptr, GL_DYNAMIC_DRAW));
 }
 
 IndexBuffer::~IndexBuffer()
 {
+    Release();
+}
+
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_Count(other.m_Count), m_Capacity(other.m_Capacity), m_Usage(other.m_Usage)
+{
+    other.m_RendererID = 0;
+    other.m_Count = other.m_Capacity = 0;
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        m_RendererID = other.m_RendererID;
+        m_Count = other.m_Count;
+        m_Capacity = other.m_Capacity;
+        m_Usage = other.m_Usage;
+        other.m_RendererID = 0;
+        other.m_Count = other.m_Capacity = 0;
+    }
+    return *this;
+}
+
+void IndexBuffer::Release()
+{
+    if (!m_RendererID)
+        return; // moved from
+    GLState::OnDeleteBuffer(m_RendererID);
     GLCall(glDeleteBuffers(1, &m_RendererID));
+    m_RendererID = 0;
+}
+
+void IndexBuffer::SetData(const unsigned int* data, unsigned int count, unsigned int offset)
+{
+    if (offset + count > m_Capacity)
+    {
+        unsigned int newCapacity = std::max(offset + count, m_Capacity * 2);
+        ReallocateBuffer(m_RendererID, newCapacity * sizeof(unsigned int),
+            std::min(offset, m_Capacity) * sizeof(unsigned int), m_Usage);
+        m_Capacity = newCapacity;
+    }
+    // Through the copy target, binding GL_ELEMENT_ARRAY_BUFFER would change the bound VAO
+    GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+    GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, offset * sizeof(unsigned int), count * sizeof(unsigned int), data));
+    m_Count = offset + count;
+}
+
+void IndexBuffer::Reserve(unsigned int capacity)
+{
+    if (capacity <= m_Capacity)
+        return;
+    unsigned int newCapacity = std::max(capacity, m_Capacity * 2);
+    ReallocateBuffer(m_RendererID, newCapacity * sizeof(unsigned int), m_Capacity * sizeof(unsigned int), m_Usage);
+    m_Capacity = newCapacity;
+}
+
+void IndexBuffer::SetCount(unsigned int count)
+{
+    m_Count = std::min(count, m_Capacity);
 }
 
 void IndexBuffer::Bind() const
 {
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+    GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
 }
 
 void IndexBuffer::Unbind() const
 {
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
-}
\ No newline at end of file
+    GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
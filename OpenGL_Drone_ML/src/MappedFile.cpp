@@ -0,0 +1,88 @@
+#include "MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+    : m_FilePath(path), m_Data(nullptr), m_Size(0), m_FileHandle(INVALID_HANDLE_VALUE), m_MappingHandle(nullptr)
+{
+    m_FileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (m_FileHandle == INVALID_HANDLE_VALUE)
+    {
+        std::cout << "MappedFile: could not open " << path << std::endl;
+        return;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_FileHandle, &size) || size.QuadPart == 0)
+        return;
+    m_Size = (std::size_t)size.QuadPart;
+
+    m_MappingHandle = CreateFileMappingA(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_MappingHandle)
+    {
+        std::cout << "MappedFile: could not map " << path << std::endl;
+        return;
+    }
+    m_Data = static_cast<const unsigned char*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_Data)
+        UnmapViewOfFile(m_Data);
+    if (m_MappingHandle)
+        CloseHandle(m_MappingHandle);
+    if (m_FileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(m_FileHandle);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+    : m_FilePath(path), m_Data(nullptr), m_Size(0), m_FileDescriptor(-1)
+{
+    m_FileDescriptor = open(path.c_str(), O_RDONLY);
+    if (m_FileDescriptor < 0)
+    {
+        std::cout << "MappedFile: could not open " << path << std::endl;
+        return;
+    }
+
+    struct stat info;
+    if (fstat(m_FileDescriptor, &info) != 0 || info.st_size == 0)
+        return;
+    m_Size = (std::size_t)info.st_size;
+
+    void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0);
+    if (data == MAP_FAILED)
+    {
+        std::cout << "MappedFile: could not map " << path << std::endl;
+        return;
+    }
+    madvise(data, m_Size, MADV_RANDOM); // tiles are visited in flight order, not file order
+    m_Data = static_cast<const unsigned char*>(data);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_Data)
+        munmap(const_cast<unsigned char*>(m_Data), m_Size);
+    if (m_FileDescriptor >= 0)
+        close(m_FileDescriptor);
+}
+
+#endif
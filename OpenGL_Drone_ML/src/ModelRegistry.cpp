@@ -0,0 +1,60 @@
+#include "ModelRegistry.h"
+
+unsigned int ModelRegistry::AddModel(const std::string& name, const void* vertices, unsigned int vertexCount, unsigned int stride,
+    const std::vector<unsigned int>& indices, const VertexBufferLayout& layout)
+{
+    auto it = m_Lookup.find(name);
+    if (it != m_Lookup.end())
+        return it->second;
+
+    Model model;
+    model.va = std::make_unique<VertexArray>();
+    model.vb = std::make_unique<VertexBuffer>(vertices, vertexCount * stride);
+    model.va->AddBuffer(*model.vb, layout);
+    model.ib = std::make_unique<IndexBuffer>(indices.data(), indices.size());
+    model.attributeCount = (unsigned int)layout.GetElements().size();
+    // Grows on its own in Upload, the attributes keep pointing at it
+    model.instanceBuffer = std::make_unique<VertexBuffer>(64 * sizeof(InstanceData));
+    model.va->AddBuffer(*model.instanceBuffer, InstanceData::Format::Layout(), model.attributeCount, 1);
+    model.dirty = false;
+
+    m_Models.push_back(std::move(model));
+    m_Lookup[name] = (unsigned int)m_Models.size() - 1;
+    return (unsigned int)m_Models.size() - 1;
+}
+
+void ModelRegistry::AddInstance(unsigned int model, const glm::mat4& transform, const glm::vec4& color)
+{
+    m_Models[model].instances.push_back({transform, color});
+    m_Models[model].dirty = true;
+}
+
+void ModelRegistry::ClearInstances(unsigned int model)
+{
+    m_Models[model].instances.clear();
+    m_Models[model].dirty = true;
+}
+
+void ModelRegistry::Upload(Model& model)
+{
+    const unsigned int count = (unsigned int)model.instances.size();
+    if (count > 0)
+        model.instanceBuffer->SetData(model.instances.data(), count * sizeof(InstanceData));
+    model.dirty = false;
+}
+
+void ModelRegistry::Draw(const Renderer& renderer, Shader& shader)
+{
+    m_DrawCalls = 0;
+    shader.Bind();
+    for (Model& model : m_Models)
+    {
+        if (model.dirty)
+            Upload(model);
+        if (model.instances.empty())
+            continue;
+
+        renderer.DrawInstanced(*model.va, *model.ib, shader, (unsigned int)model.instances.size());
+        m_DrawCalls++;
+    }
+}
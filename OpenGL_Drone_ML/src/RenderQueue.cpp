@@ -0,0 +1,163 @@
+#include "RenderQueue.h"
+
+#include <cstring>
+
+#include "GPUProfiler.h"
+
+// Key layout, most significant first
+//   Opaque:      pass 2 | shader 12 | textures 8 | vao 14 | depth 24 | 4 unused
+//   Transparent: pass 2 | far-to-near depth 24 | shader 12 | textures 8 | vao 14 | 4 unused
+//   UI:          pass 2 | 0, the stable sort keeps submission order
+static const unsigned int SHADER_BITS = 12, TEXTURE_BITS = 8, VAO_BITS = 14, DEPTH_BITS = 24;
+
+static const char* PASS_NAMES[] = {"Opaque pass", "Transparent pass", "UI pass"};
+
+static uint64_t Field(unsigned int value, unsigned int bits)
+{
+    return value & ((1u << bits) - 1);
+}
+
+// Non-negative floats order the same as their bit patterns, the top 24 bits keep
+// the exponent and most of the mantissa
+static uint64_t DepthBits(float depth)
+{
+    if (!(depth > 0.0f))
+        depth = 0.0f;
+    uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    return bits >> (31 - DEPTH_BITS);
+}
+
+uint64_t RenderQueue::MakeKey(RenderPass pass, unsigned int shader, unsigned int textureSet, unsigned int vao, float depth)
+{
+    uint64_t key = (uint64_t)pass << 62;
+    const uint64_t state = (Field(shader, SHADER_BITS) << (TEXTURE_BITS + VAO_BITS))
+                         | (Field(textureSet, TEXTURE_BITS) << VAO_BITS)
+                         | Field(vao, VAO_BITS);
+    const unsigned int stateBits = SHADER_BITS + TEXTURE_BITS + VAO_BITS;
+    switch (pass)
+    {
+        case RenderPass::Opaque:
+            key |= state << (DEPTH_BITS + 4);
+            key |= DepthBits(depth) << 4;
+            break;
+        case RenderPass::Transparent:
+            key |= (((1ull << DEPTH_BITS) - 1) - DepthBits(depth)) << (stateBits + 4);
+            key |= state << 4;
+            break;
+        case RenderPass::UI:
+            break;
+    }
+    return key;
+}
+
+RenderQueue::RenderQueue()
+{
+    m_TextureSets.emplace_back(); // set 0, binds nothing
+}
+
+unsigned int RenderQueue::AddTextureSet(const std::vector<const Texture*>& textures)
+{
+    m_TextureSets.push_back(textures);
+    return (unsigned int)m_TextureSets.size() - 1;
+}
+
+void RenderQueue::Submit(RenderPass pass, const DrawCommand& command, float depth)
+{
+    uint64_t key = MakeKey(pass, command.shader->GetRendererID(), command.textureSet, command.va->GetRendererID(), depth);
+    m_Entries.push_back({key, (unsigned int)m_Commands.size()});
+    m_Commands.push_back(command);
+}
+
+// LSD radix sort, one byte per pass. Stable, so equal keys stay in submission order,
+// and a byte that is the same in every key (most of them in a small scene) is skipped
+void RenderQueue::Sort()
+{
+    const size_t count = m_Entries.size();
+    m_Scratch.resize(count);
+    for (unsigned int shift = 0; shift < 64; shift += 8)
+    {
+        size_t histogram[256] = {};
+        for (const Entry& entry : m_Entries)
+            histogram[(entry.key >> shift) & 0xFF]++;
+        if (histogram[(m_Entries[0].key >> shift) & 0xFF] == count)
+            continue;
+
+        size_t offset = 0;
+        for (size_t& bucket : histogram)
+        {
+            size_t n = bucket;
+            bucket = offset;
+            offset += n;
+        }
+        for (const Entry& entry : m_Entries)
+            m_Scratch[histogram[(entry.key >> shift) & 0xFF]++] = entry;
+        m_Entries.swap(m_Scratch);
+    }
+}
+
+void RenderQueue::Flush(const Renderer& renderer, FrameUniforms* uniforms)
+{
+    m_LastDrawCount = 0;
+    if (m_Entries.empty())
+        return;
+    Sort();
+
+    if (uniforms)
+    {
+        // Stage every draw's block in sorted order so the ring is read front to back
+        m_Objects.assign(m_Commands.size(), 0);
+        for (const Entry& entry : m_Entries)
+        {
+            const DrawCommand& command = m_Commands[entry.command];
+            if (!command.shader->HasObjectBlock())
+                continue;
+            ObjectData object;
+            object.mvp = command.mvp;
+            object.model = command.model;
+            object.material = command.material;
+            m_Objects[entry.command] = uniforms->PushObject(object);
+        }
+        uniforms->Commit();
+    }
+
+    unsigned int pass = 0xFFFFFFFF;
+    for (const Entry& entry : m_Entries)
+    {
+        unsigned int entryPass = (unsigned int)(entry.key >> 62);
+        if (entryPass != pass)
+        {
+            if (pass != 0xFFFFFFFF)
+                GPUProfiler::End();
+            GPUProfiler::Begin(PASS_NAMES[entryPass]);
+            pass = entryPass;
+            GLState::SetDepthTest(pass != (unsigned int)RenderPass::UI);
+            GLState::SetDepthMask(pass == (unsigned int)RenderPass::Opaque);
+        }
+
+        DrawCommand& command = m_Commands[entry.command];
+        const std::vector<const Texture*>& textures = m_TextureSets[command.textureSet];
+        for (unsigned int slot = 0; slot < textures.size(); slot++)
+            textures[slot]->Bind(slot);
+
+        command.shader->Bind();
+        if (uniforms && command.shader->HasObjectBlock())
+            uniforms->BindObject(m_Objects[entry.command]);
+        else
+            command.shader->Set(command.shader->GetMVPUniform(), command.mvp);
+        if (command.instanceCount > 0)
+            renderer.DrawInstanced(*command.va, *command.ib, *command.shader, command.instanceCount);
+        else if (command.firstIndex || command.baseVertex)
+            renderer.Draw(*command.va, *command.ib, *command.shader, command.count, command.firstIndex, command.baseVertex);
+        else
+            renderer.Draw(*command.va, *command.ib, *command.shader, command.count ? command.count : command.ib->GetCount());
+        m_LastDrawCount++;
+    }
+    GPUProfiler::End();
+
+    // Leave the defaults the scenes expect
+    GLState::SetDepthTest(true);
+    GLState::SetDepthMask(true);
+    m_Entries.clear();
+    m_Commands.clear();
+}
@@ -0,0 +1,128 @@
+#include "RenderThread.h"
+
+#include <GLFW/glfw3.h>
+
+void RenderCommandList::Execute()
+{
+    for (auto& command : m_Commands)
+        command();
+}
+
+RenderThread::RenderThread(GLFWwindow* window, int swapInterval)
+    : m_Window(window), m_SwapInterval(swapInterval), m_Record(0), m_Pending(false), m_Present(false),
+      m_Stop(false), m_HandoffsRecorded(0), m_HandoffsDone(0)
+{
+    // A context is current on one thread at a time
+    glfwMakeContextCurrent(nullptr);
+    m_Thread = std::thread(&RenderThread::ThreadMain, this);
+}
+
+RenderThread::~RenderThread()
+{
+    Finish();
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Wake.notify_all();
+    m_Thread.join(); // releases the context on its way out
+    glfwMakeContextCurrent(m_Window);
+}
+
+void RenderThread::Submit(bool present)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Done.wait(lock, [this]() { return !m_Pending; });
+    m_Present = present;
+    m_Pending = true;
+    m_Record ^= 1;
+    lock.unlock();
+    m_Wake.notify_one();
+}
+
+void RenderThread::Finish()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Done.wait(lock, [this]() { return !m_Pending; });
+}
+
+void RenderThread::RecordHandoff()
+{
+    GetList().Record([this]()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_HandoffsDone++;
+        }
+        m_Done.notify_all();
+    });
+    m_HandoffsRecorded++;
+}
+
+void RenderThread::WaitForHandoff()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Done.wait(lock, [this]() { return m_HandoffsDone == m_HandoffsRecorded; });
+}
+
+void RenderThread::Run(std::function<void()> command)
+{
+    GetList().Record(std::move(command));
+    Submit(false);
+    Finish();
+}
+
+void RenderThread::Borrow(const std::function<void()>& fn)
+{
+    Run([]() { glfwMakeContextCurrent(nullptr); });
+    glfwMakeContextCurrent(m_Window);
+    fn();
+    glfwMakeContextCurrent(nullptr);
+    Run([this]() { glfwMakeContextCurrent(m_Window); });
+}
+
+RenderThread::Stats RenderThread::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void RenderThread::ThreadMain()
+{
+    glfwMakeContextCurrent(m_Window);
+    glfwSwapInterval(m_SwapInterval); // belongs to the context, so it is set again here
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true)
+    {
+        m_Wake.wait(lock, [this]() { return m_Pending || m_Stop; });
+        if (!m_Pending)
+            break;
+
+        // The update thread has moved on to the other list and does not touch this one
+        RenderCommandList& list = m_Lists[m_Record ^ 1];
+        const bool present = m_Present;
+        lock.unlock();
+
+        const double start = glfwGetTime();
+        list.Execute();
+        const double executed = glfwGetTime();
+        if (present)
+            glfwSwapBuffers(m_Window);
+        const double presented = glfwGetTime();
+        const unsigned int commands = (unsigned int)list.GetCount();
+        list.Clear();
+
+        lock.lock();
+        if (present)
+        {
+            m_Stats.executeMs = (float)(executed - start) * 1000.0f;
+            m_Stats.presentMs = (float)(presented - executed) * 1000.0f;
+            m_Stats.commands = commands;
+        }
+        m_Pending = false;
+        m_Done.notify_all();
+    }
+    lock.unlock();
+    glfwMakeContextCurrent(nullptr);
+}
@@ -12,3 +12,51 @@ void Renderer::Draw(const VertexArray &va, const IndexBuffer &ib, const Shader &
         ib.Bind();
         GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
 }
+
+void Renderer::Draw(const VertexArray &va, const IndexBuffer &ib, const Shader &shader, unsigned int count) const
+{
+        shader.Bind();
+        va.Bind();
+        ib.Bind();
+        GLCall(glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr));
+}
+
+void Renderer::Draw(const VertexArray &va, const IndexBuffer &ib, const Shader &shader, unsigned int count, unsigned int firstIndex, int baseVertex) const
+{
+        shader.Bind();
+        va.Bind();
+        ib.Bind();
+        GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_INT, (void*)(firstIndex * sizeof(unsigned int)), baseVertex));
+}
+
+void Renderer::DrawInstanced(const VertexArray &va, const IndexBuffer &ib, const Shader &shader, unsigned int instanceCount) const
+{
+        shader.Bind();
+        va.Bind();
+        ib.Bind();
+        GLCall(glDrawElementsInstanced(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr, instanceCount));
+}
+
+void Renderer::DrawMulti(const VertexArray &va, const IndexBuffer &ib, const Shader &shader,
+        GLsizei *counts, void **offsets, GLint *baseVertices, unsigned int drawCount) const
+{
+        shader.Bind();
+        va.Bind();
+        ib.Bind();
+        GLCall(glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts, GL_UNSIGNED_INT, offsets, drawCount, baseVertices));
+}
+
+void Renderer::DrawBaseVertex(const VertexArray &va, const Shader &shader, unsigned int count, unsigned int indexOffset, int baseVertex) const
+{
+        shader.Bind();
+        va.Bind();
+        GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_INT, (void*)(size_t)indexOffset, baseVertex));
+}
+
+void Renderer::DrawIndirect(const VertexArray &va, const IndexBuffer &ib, const Shader &shader, unsigned int drawCount) const
+{
+        shader.Bind();
+        va.Bind();
+        ib.Bind();
+        GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, drawCount, 0));
+}
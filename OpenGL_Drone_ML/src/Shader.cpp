@@ -1,32 +1,143 @@
 #include "Shader.h"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
 
-#include "GLError.h"
+#include "GLState.h"
+#include "ShaderCache.h"
+#include "UniformBuffer.h"
 
-Shader::Shader(const std::string &filepath)
-    : m_FilePath(filepath), m_RendererID(0)
+std::unordered_map<std::string, std::weak_ptr<Shader>> Shader::s_Permutations;
+
+Shader::Shader(const std::string &filepath, const ShaderDefines& defines)
+    : m_FilePath(filepath), m_RendererID(0), m_HasObjectBlock(false)
 {
-    ShaderProgramSource source = ParseShader(filepath);
+    ShaderProgramSource source = ParseShader(filepath, defines);
+
+    // A cached binary skips compilation, otherwise build from source and cache the result
+    const uint64_t key = ShaderCache::Key(source.VertexSource, source.FragmentSource);
+    m_RendererID = ShaderCache::Load(key);
+    if (!m_RendererID)
+    {
+        m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+        ShaderCache::OnCompiled(false);
+        if (FinishProgram(m_RendererID, filepath))
+            ShaderCache::Store(key, m_RendererID);
+    }
+    Reflect();
+    BindUniformBlocks();
 
-    std::cout << source.VertexSource << std::endl;
-    std::cout << source.FragmentSource << std:: endl;
+}
+
+std::shared_ptr<Shader> Shader::Get(const std::string& filepath, const ShaderDefines& defines)
+{
+    // The order defines are given in doesn't change the program
+    ShaderDefines sorted = defines;
+    std::sort(sorted.begin(), sorted.end());
+    std::string key = filepath;
+    for (const std::string& define : sorted)
+        key += "|" + define;
+
+    std::weak_ptr<Shader>& slot = s_Permutations[key];
+    std::shared_ptr<Shader> shader = slot.lock();
+    if (!shader)
+    {
+        shader = std::make_shared<Shader>(filepath, sorted);
+        slot = shader;
+    }
+    return shader;
+}
+
+void Shader::Precompile(const std::vector<ShaderPermutation>& permutations)
+{
+    if (!ShaderCache::IsSupported())
+        return; // nothing to keep the results in
 
-    m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+    struct Pending
+    {
+        std::string filepath;
+        uint64_t key;
+        unsigned int program;
+    };
+    std::vector<Pending> pending;
+    for (const ShaderPermutation& permutation : permutations)
+    {
+        // Sorted like Get does, so the source and with it the key match what Get builds
+        ShaderDefines sorted = permutation.defines;
+        std::sort(sorted.begin(), sorted.end());
+        ShaderProgramSource source = ParseShader(permutation.filepath, sorted);
+        const uint64_t key = ShaderCache::Key(source.VertexSource, source.FragmentSource);
+        if (!ShaderCache::Contains(key))
+        {
+            pending.push_back({permutation.filepath, key, CreateShader(source.VertexSource, source.FragmentSource)});
+            ShaderCache::OnCompiled(true);
+        }
+    }
 
+    // Only now wait on any of them
+    for (const Pending& p : pending)
+    {
+        if (FinishProgram(p.program, p.filepath))
+            ShaderCache::Store(p.key, p.program);
+        GLCall(glDeleteProgram(p.program));
+    }
 }
 
 Shader::~Shader()
 {
+    GLState::OnDeleteProgram(m_RendererID);
     GLCall(glDeleteProgram(m_RendererID));
 }
 
-ShaderProgramSource Shader::ParseShader(const std::string& filepath)
+// Directory part of filepath including the separator, empty for a bare file name
+static std::string DirectoryOf(const std::string& filepath)
+{
+    size_t slash = filepath.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : filepath.substr(0, slash + 1);
+}
+
+// Copies filepath into out, replacing every #include "file" (relative to the including file)
+// with that file's contents
+bool Shader::AppendFile(const std::string& filepath, std::stringstream& out, unsigned int depth)
 {
     std::ifstream stream(filepath);
+    if (!stream || depth > 16) // deeper than any real chain, so most likely a cycle
+    {
+        std::cout << "Can't include " << filepath << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (getline(stream, line))
+    {
+        size_t directive = line.find("#include");
+        if (directive != std::string::npos && line.find_first_not_of(" \t") == directive)
+        {
+            size_t open = line.find('"', directive);
+            size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+            if (close == std::string::npos)
+            {
+                std::cout << "Malformed " << line << " in " << filepath << std::endl;
+                return false;
+            }
+            if (!AppendFile(DirectoryOf(filepath) + line.substr(open + 1, close - open - 1), out, depth + 1))
+                return false;
+        }
+        else
+        {
+            out << line << '\n';
+        }
+    }
+    return true;
+}
+
+ShaderProgramSource Shader::ParseShader(const std::string& filepath, const ShaderDefines& defines)
+{
+    std::stringstream file;
+    AppendFile(filepath, file, 0);
 
     enum class ShaderType
     {
@@ -36,7 +147,7 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
     std::string line;
     std::stringstream ss [2];
     ShaderType type = ShaderType::NONE;
-    while (getline(stream, line))
+    while (getline(file, line))
     {
         if (line.find("#shader") != std::string::npos)
         {
@@ -45,9 +156,13 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
             else if (line.find("fragment") != std::string::npos)
                 type = ShaderType::FRAGMENT;
         }
-        else
+        else if (type != ShaderType::NONE)
         {
             ss[int(type)] << line << '\n';
+            // #version has to stay the first statement, the defines follow it
+            if (line.find("#version") != std::string::npos)
+                for (const std::string& define : defines)
+                    ss[int(type)] << "#define " << define << '\n';
         }
     }
 
@@ -61,22 +176,8 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
     glShaderSource(id, 1, &src, nullptr);
     glCompileShader(id);
 
-    // TODO: Error handling
-    int result;
-    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
-    if (result == GL_FALSE)
-    {
-        // Shader did not compile successfully
-        int length;
-        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
-        char* message = (char*)alloca(length * sizeof(char)); // dynamic stack allocate
-        glGetShaderInfoLog(id, length, &length, message);
-        std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << std::endl;
-        std::cout << message << std::endl;
-        glDeleteShader(id);
-        return 0;
-    }
-
+    // The status is checked by FinishProgram, asking now would wait for a compile that may be
+    // running on a driver thread
     return id;
 }
 
@@ -85,31 +186,66 @@ unsigned int Shader::CreateShader(const std::string& vertexShader, const std::st
 {
     // Provide OpenGL with our shader source code / text and compile the two shaders into program
     GLCall(unsigned int program = glCreateProgram());
+    ShaderCache::PrepareProgram(program);
     unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
     unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
 
     GLCall(glAttachShader(program, vs));
     GLCall(glAttachShader(program, fs));
     GLCall(glLinkProgram(program));
-    GLCall(glValidateProgram(program)); // review docs
 
     GLCall(glDeleteShader(vs)); // Once compiled we can delete intermediates (.obj files)
     GLCall(glDeleteShader(fs));
-    // Technically should call glDetachShader after linking, but leaving the shader source code
-    // can be useful for debugging
+    // Technically should call glDetachShader after linking, but leaving the shaders attached
+    // keeps their compile logs around for FinishProgram
 
     return program;
 }
 
+// Waits for the link CreateShader started. On failure prints the logs of the shaders that did
+// not compile, then the link log
+bool Shader::FinishProgram(unsigned int program, const std::string& filepath)
+{
+    int result;
+    GLCall(glGetProgramiv(program, GL_LINK_STATUS, &result));
+    if (result == GL_TRUE)
+        return true;
+
+    std::cout << "Failed to link " << filepath << std::endl;
+    GLuint shaders[2];
+    GLsizei count = 0;
+    GLCall(glGetAttachedShaders(program, 2, &count, shaders));
+    for (GLsizei i = 0; i < count; i++)
+    {
+        int type, length;
+        GLCall(glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &result));
+        if (result == GL_TRUE)
+            continue;
+        GLCall(glGetShaderiv(shaders[i], GL_SHADER_TYPE, &type));
+        GLCall(glGetShaderiv(shaders[i], GL_INFO_LOG_LENGTH, &length));
+        std::vector<char> message(std::max(length, 1));
+        GLCall(glGetShaderInfoLog(shaders[i], (GLsizei)message.size(), &length, message.data()));
+        std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << std::endl;
+        std::cout << message.data() << std::endl;
+    }
+
+    int length;
+    GLCall(glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length));
+    std::vector<char> message(std::max(length, 1));
+    GLCall(glGetProgramInfoLog(program, (GLsizei)message.size(), &length, message.data()));
+    std::cout << message.data() << std::endl;
+    return false;
+}
+
 
 void Shader::Bind() const
 {
-    GLCall(glUseProgram(m_RendererID));
+    GLState::UseProgram(m_RendererID);
 }
 
 void Shader::Unbind() const
 {
-    GLCall(glUseProgram(0));
+    GLState::UseProgram(0);
 }
 
 void Shader::SetUniform1i(const std::string &name, int value)
@@ -127,6 +263,16 @@ void Shader::SetUniform1f(const std::string &name, float value)
     GLCall(glUniform1f(GetUniformLocation(name), value));
 }
 
+void Shader::SetUniform2f(const std::string& name, float v0, float v1)
+{
+    GLCall(glUniform2f(GetUniformLocation(name), v0, v1));
+}
+
+void Shader::SetUniform3f(const std::string& name, float v0, float v1, float v2)
+{
+    GLCall(glUniform3f(GetUniformLocation(name), v0, v1, v2));
+}
+
 void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
 {
     GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
@@ -137,16 +283,118 @@ void Shader::SetUniformMat4f(const std::string& name, const glm::mat4& matrix)
     GLCall(glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &matrix[0][0]));
 }
 
+void Shader::Set(Uniform<int> uniform, int value)
+{
+    GLCall(glUniform1i(uniform.location, value));
+}
+
+void Shader::Set(Uniform<int> uniform, int count, const int* values)
+{
+    GLCall(glUniform1iv(uniform.location, count, values));
+}
+
+void Shader::Set(Uniform<float> uniform, float value)
+{
+    GLCall(glUniform1f(uniform.location, value));
+}
+
+void Shader::Set(Uniform<glm::vec2> uniform, const glm::vec2& value)
+{
+    GLCall(glUniform2f(uniform.location, value.x, value.y));
+}
+
+void Shader::Set(Uniform<glm::vec3> uniform, const glm::vec3& value)
+{
+    GLCall(glUniform3f(uniform.location, value.x, value.y, value.z));
+}
+
+void Shader::Set(Uniform<glm::vec4> uniform, const glm::vec4& value)
+{
+    GLCall(glUniform4f(uniform.location, value.x, value.y, value.z, value.w));
+}
+
+void Shader::Set(Uniform<glm::mat4> uniform, const glm::mat4& value)
+{
+    GLCall(glUniformMatrix4fv(uniform.location, 1, GL_FALSE, &value[0][0]));
+}
+
+// Every active uniform outside a block, so lookups never have to ask the driver
+void Shader::Reflect()
+{
+    m_Uniforms.clear();
+    GLint count = 0, maxLength = 0;
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &count));
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+
+    std::vector<char> name(std::max(maxLength, 1));
+    for (GLint i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        UniformInfo info;
+        GLCall(glGetActiveUniform(m_RendererID, (GLuint)i, (GLsizei)name.size(), &length, &info.size, &info.type, name.data()));
+        info.name.assign(name.data(), length);
+        GLCall(info.location = glGetUniformLocation(m_RendererID, info.name.c_str()));
+        if (info.location < 0)
+            continue; // member of a uniform block
+
+        if (info.name.size() > 3 && info.name.compare(info.name.size() - 3, 3, "[0]") == 0)
+            info.name.resize(info.name.size() - 3);
+        m_Uniforms.push_back(info);
+    }
+    std::sort(m_Uniforms.begin(), m_Uniforms.end(),
+        [](const UniformInfo& a, const UniformInfo& b) { return a.name < b.name; });
+
+    m_MissingUniforms.clear();
+    m_MVP.location = -1;
+    for (const UniformInfo& info : m_Uniforms)
+        if (info.name == "u_MVP" && info.type == GL_FLOAT_MAT4)
+            m_MVP.location = info.location;
+}
+
 GLint Shader::GetUniformLocation(const std::string &name) const
 {
-    if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
-        return m_UniformLocationCache[name];
+    auto it = std::lower_bound(m_Uniforms.begin(), m_Uniforms.end(), name,
+        [](const UniformInfo& info, const std::string& key) { return info.name < key; });
+    if (it != m_Uniforms.end() && it->name == name)
+        return it->location;
 
-    GLCall(GLint location = glGetUniformLocation(m_RendererID, name.c_str()));
-    if (location == -1) 
+    // Only the first miss is reported, setting it every frame would flood the console
+    if (m_MissingUniforms.insert(name).second)
         std::cout << "Warning: uniform '" << name << "' doesn't exist!" << std::endl;
-        
-    m_UniformLocationCache[name] = location;
+    return -1;
+}
 
+GLint Shader::ResolveUniform(const std::string& name, GLenum type) const
+{
+    GLint location = GetUniformLocation(name);
+    if (location < 0)
+        return -1;
+
+    const UniformInfo& info = *std::lower_bound(m_Uniforms.begin(), m_Uniforms.end(), name,
+        [](const UniformInfo& info, const std::string& key) { return info.name < key; });
+    bool sampler = info.type == GL_SAMPLER_2D || info.type == GL_SAMPLER_2D_ARRAY || info.type == GL_SAMPLER_BUFFER;
+    if (info.type != type && !(type == GL_INT && sampler))
+    {
+        std::cout << "Warning: uniform '" << name << "' in " << m_FilePath << " has GL type " << info.type
+            << ", the handle expects " << type << std::endl;
+        return -1;
+    }
     return location;
-}
\ No newline at end of file
+}
+
+void Shader::BindUniformBlocks()
+{
+    // Blocks are matched by name, so every program reads the same buffers
+    GLCall(GLuint camera = glGetUniformBlockIndex(m_RendererID, "Camera"));
+    if (camera != GL_INVALID_INDEX)
+    {
+        GLCall(glUniformBlockBinding(m_RendererID, camera, CameraBinding));
+    }
+
+    GLCall(GLuint object = glGetUniformBlockIndex(m_RendererID, "Object"));
+    m_HasObjectBlock = object != GL_INVALID_INDEX;
+    if (m_HasObjectBlock)
+    {
+        GLCall(glUniformBlockBinding(m_RendererID, object, ObjectBinding));
+    }
+}
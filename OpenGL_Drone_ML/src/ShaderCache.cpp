@@ -0,0 +1,174 @@
+#include "ShaderCache.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+std::string ShaderCache::s_Directory;
+uint64_t ShaderCache::s_DriverHash = 0;
+bool ShaderCache::s_Supported = false;
+bool ShaderCache::s_Parallel = false;
+ShaderCache::Stats ShaderCache::s_Stats;
+
+static const uint32_t BINARY_MAGIC = 0x42504C47; // "GLPB"
+
+struct BinaryHeader
+{
+    uint32_t magic;
+    uint32_t format;  // as reported by glGetProgramBinary
+    uint64_t key;     // guards against a renamed or truncated file
+    uint32_t length;
+};
+
+// FNV-1a, continued from hash
+static uint64_t Hash(const char* data, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static uint64_t HashString(GLenum name, uint64_t hash)
+{
+    const char* value = (const char*)glGetString(name);
+    return value ? Hash(value, std::char_traits<char>::length(value) + 1, hash) : hash;
+}
+
+void ShaderCache::Init(const std::string& directory)
+{
+    s_Directory = directory;
+
+    s_DriverHash = HashString(GL_VENDOR, 14695981039346656037ull);
+    s_DriverHash = HashString(GL_RENDERER, s_DriverHash);
+    s_DriverHash = HashString(GL_VERSION, s_DriverHash);
+    s_DriverHash = HashString(GL_SHADING_LANGUAGE_VERSION, s_DriverHash);
+
+    GLint formats = 0;
+    if (GLEW_ARB_get_program_binary || GLEW_VERSION_4_1)
+    {
+        GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+    }
+    s_Supported = formats > 0;
+    if (s_Supported)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(s_Directory, error);
+        if (error)
+        {
+            std::cout << "Shader cache: can't create " << s_Directory << ", " << error.message() << std::endl;
+            s_Supported = false;
+        }
+    }
+
+    // 0xFFFFFFFF lets the driver pick how many threads
+    if (GLEW_KHR_parallel_shader_compile)
+    {
+        GLCall(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF));
+        s_Parallel = true;
+    }
+    else if (GLEW_ARB_parallel_shader_compile)
+    {
+        GLCall(glMaxShaderCompilerThreadsARB(0xFFFFFFFF));
+        s_Parallel = true;
+    }
+}
+
+uint64_t ShaderCache::Key(const std::string& vertexSource, const std::string& fragmentSource)
+{
+    uint64_t hash = Hash(vertexSource.data(), vertexSource.size() + 1, s_DriverHash);
+    return Hash(fragmentSource.data(), fragmentSource.size(), hash);
+}
+
+std::string ShaderCache::PathFor(uint64_t key)
+{
+    char name[24];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return s_Directory + "/" + name;
+}
+
+bool ShaderCache::Contains(uint64_t key)
+{
+    return s_Supported && std::filesystem::exists(PathFor(key));
+}
+
+unsigned int ShaderCache::Load(uint64_t key)
+{
+    if (!s_Supported)
+        return 0;
+    const std::string path = PathFor(key);
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream)
+        return 0;
+
+    BinaryHeader header;
+    std::vector<char> binary;
+    bool valid = stream.read((char*)&header, sizeof(header)) && header.magic == BINARY_MAGIC && header.key == key;
+    if (valid)
+    {
+        binary.resize(header.length);
+        valid = (bool)stream.read(binary.data(), header.length);
+    }
+    stream.close();
+
+    unsigned int program = 0;
+    GLint linked = GL_FALSE;
+    if (valid)
+    {
+        GLCall(program = glCreateProgram());
+        // A binary the driver no longer accepts just fails to link
+        GLCall(glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size()));
+        GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+    }
+    if (linked != GL_TRUE)
+    {
+        if (program)
+        {
+            GLCall(glDeleteProgram(program));
+        }
+        std::remove(path.c_str());
+        s_Stats.rejected++;
+        return 0;
+    }
+    s_Stats.hits++;
+    return program;
+}
+
+void ShaderCache::PrepareProgram(unsigned int program)
+{
+    if (s_Supported)
+    {
+        GLCall(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    }
+}
+
+void ShaderCache::OnCompiled(bool precompiled)
+{
+    if (precompiled)
+        s_Stats.precompiled++;
+    else
+        s_Stats.misses++;
+}
+
+void ShaderCache::Store(uint64_t key, unsigned int program)
+{
+    if (!s_Supported)
+        return;
+    GLint length = 0;
+    GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLCall(glGetProgramBinary(program, length, &length, &format, binary.data()));
+
+    BinaryHeader header = {BINARY_MAGIC, format, key, (uint32_t)length};
+    std::ofstream stream(PathFor(key), std::ios::binary | std::ios::trunc);
+    stream.write((const char*)&header, sizeof(header));
+    stream.write(binary.data(), length);
+}
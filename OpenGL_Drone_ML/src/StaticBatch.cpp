@@ -0,0 +1,182 @@
+#include "StaticBatch.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "VertexFormat.h"
+
+using DrawIDFormat = VertexFormat<Attr<float, 1>>; // float holds ids exactly up to 2^24
+
+static AABB TransformBounds(const AABB& box, const glm::mat4& transform)
+{
+    AABB result;
+    for (unsigned int corner = 0; corner < 8; corner++)
+    {
+        glm::vec3 p((corner & 1) ? box.max.x : box.min.x,
+                    (corner & 2) ? box.max.y : box.min.y,
+                    (corner & 4) ? box.max.z : box.min.z);
+        result.Expand(glm::vec3(transform * glm::vec4(p, 1.0f)));
+    }
+    return result;
+}
+
+StaticBatch::StaticBatch(unsigned int stride, const VertexBufferLayout& layout)
+    : m_Stride(stride), m_Layout(layout), m_DirtyBegin(0), m_DirtyEnd(0),
+      m_TransformBuffer(0), m_RendererID(0), m_IndirectBuffer(0), m_VisibleCount(0)
+{
+}
+
+StaticBatch::~StaticBatch()
+{
+    if (m_RendererID)
+    {
+        GLState::OnDeleteTexture(m_RendererID);
+        GLCall(glDeleteTextures(1, &m_RendererID));
+        GLState::OnDeleteBuffer(m_TransformBuffer);
+        GLCall(glDeleteBuffers(1, &m_TransformBuffer));
+    }
+    if (m_IndirectBuffer)
+    {
+        GLState::OnDeleteBuffer(m_IndirectBuffer);
+        GLCall(glDeleteBuffers(1, &m_IndirectBuffer));
+    }
+}
+
+unsigned int StaticBatch::AddMesh(const void* vertices, unsigned int vertexCount, const std::vector<unsigned int>& indices,
+    const glm::mat4& transform)
+{
+    const unsigned int id = (unsigned int)m_Meshes.size();
+    const unsigned char* bytes = (const unsigned char*)vertices;
+
+    Mesh mesh;
+    mesh.firstIndex = (unsigned int)m_Indices.size();
+    mesh.indexCount = (unsigned int)indices.size();
+    mesh.baseVertex = (int)(m_Vertices.size() / m_Stride);
+    for (unsigned int i = 0; i < vertexCount; i++)
+    {
+        glm::vec3 p;
+        std::memcpy(&p, bytes + (size_t)i * m_Stride, sizeof(p));
+        mesh.localBounds.Expand(p);
+    }
+    mesh.bounds = TransformBounds(mesh.localBounds, transform);
+
+    // Indices stay local to the mesh, the base vertex moves them at draw time
+    m_Vertices.insert(m_Vertices.end(), bytes, bytes + (size_t)vertexCount * m_Stride);
+    m_Indices.insert(m_Indices.end(), indices.begin(), indices.end());
+    m_DrawIDs.insert(m_DrawIDs.end(), vertexCount, (float)id);
+
+    m_Meshes.push_back(mesh);
+    m_Transforms.push_back(transform);
+    return id;
+}
+
+void StaticBatch::Build()
+{
+    if (m_Meshes.empty())
+        return;
+
+    m_VAO = std::make_unique<VertexArray>();
+    m_VertexBuffer = std::make_unique<VertexBuffer>(m_Vertices.data(), m_Vertices.size());
+    m_VAO->AddBuffer(*m_VertexBuffer, m_Layout);
+    m_DrawIDBuffer = std::make_unique<VertexBuffer>(m_DrawIDs.data(), m_DrawIDs.size() * sizeof(float));
+    m_VAO->AddBuffer(*m_DrawIDBuffer, DrawIDFormat::Layout(), (unsigned int)m_Layout.GetElements().size());
+    m_IndexBuffer = std::make_unique<IndexBuffer>(m_Indices.data(), m_Indices.size());
+
+    // Transform table, four RGBA32F texels per matrix
+    GLCall(glGenBuffers(1, &m_TransformBuffer));
+    GLState::BindBuffer(GL_TEXTURE_BUFFER, m_TransformBuffer);
+    GLCall(glBufferData(GL_TEXTURE_BUFFER, m_Transforms.size() * sizeof(glm::mat4), m_Transforms.data(), GL_DYNAMIC_DRAW));
+    GLCall(glGenTextures(1, &m_RendererID));
+    GLState::BindTexture(TRANSFORM_SLOT, GL_TEXTURE_BUFFER, m_RendererID);
+    GLCall(glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_TransformBuffer));
+    m_DirtyBegin = m_DirtyEnd = 0;
+
+    if (GLEW_ARB_multi_draw_indirect && GLEW_ARB_draw_indirect)
+    {
+        GLCall(glGenBuffers(1, &m_IndirectBuffer));
+        GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer);
+        GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, m_Meshes.size() * sizeof(IndirectCommand), nullptr, GL_STREAM_DRAW));
+    }
+
+    m_Vertices = std::vector<unsigned char>();
+    m_Indices = std::vector<unsigned int>();
+    m_DrawIDs = std::vector<float>();
+}
+
+void StaticBatch::SetTransform(unsigned int mesh, const glm::mat4& transform)
+{
+    m_Transforms[mesh] = transform;
+    m_Meshes[mesh].bounds = TransformBounds(m_Meshes[mesh].localBounds, transform);
+    if (m_DirtyBegin == m_DirtyEnd)
+    {
+        m_DirtyBegin = mesh;
+        m_DirtyEnd = mesh + 1;
+    }
+    else
+    {
+        m_DirtyBegin = std::min(m_DirtyBegin, mesh);
+        m_DirtyEnd = std::max(m_DirtyEnd, mesh + 1);
+    }
+}
+
+void StaticBatch::UploadTransforms()
+{
+    if (m_DirtyBegin == m_DirtyEnd)
+        return;
+    GLState::BindBuffer(GL_TEXTURE_BUFFER, m_TransformBuffer);
+    GLCall(glBufferSubData(GL_TEXTURE_BUFFER, m_DirtyBegin * sizeof(glm::mat4),
+        (m_DirtyEnd - m_DirtyBegin) * sizeof(glm::mat4), &m_Transforms[m_DirtyBegin]));
+    m_DirtyBegin = m_DirtyEnd = 0;
+}
+
+unsigned int StaticBatch::Draw(const Renderer& renderer, Shader& shader, const glm::mat4& viewProj)
+{
+    m_VisibleCount = 0;
+    if (!m_VAO)
+        return 0;
+    UploadTransforms();
+
+    Frustum frustum(viewProj);
+    m_Counts.clear();
+    m_Offsets.clear();
+    m_BaseVertices.clear();
+    m_Commands.clear();
+    for (const Mesh& mesh : m_Meshes)
+    {
+        if (!frustum.IsVisible(mesh.bounds))
+            continue;
+        if (m_IndirectBuffer)
+        {
+            m_Commands.push_back({mesh.indexCount, 1, mesh.firstIndex, mesh.baseVertex, 0});
+        }
+        else
+        {
+            m_Counts.push_back(mesh.indexCount);
+            m_Offsets.push_back((void*)(mesh.firstIndex * sizeof(unsigned int)));
+            m_BaseVertices.push_back(mesh.baseVertex);
+        }
+        m_VisibleCount++;
+    }
+    if (m_VisibleCount == 0)
+        return 0;
+
+    GLState::BindTexture(TRANSFORM_SLOT, GL_TEXTURE_BUFFER, m_RendererID);
+    shader.Bind();
+    if (m_UniformProgram != shader.GetRendererID())
+    {
+        m_UniformProgram = shader.GetRendererID();
+        m_TransformsUniform = shader.GetUniform<int>("u_Transforms");
+    }
+    shader.Set(m_TransformsUniform, (int)TRANSFORM_SLOT);
+    if (m_IndirectBuffer)
+    {
+        GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer);
+        GLCall(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, m_Commands.size() * sizeof(IndirectCommand), m_Commands.data()));
+        renderer.DrawIndirect(*m_VAO, *m_IndexBuffer, shader, m_VisibleCount);
+    }
+    else
+    {
+        renderer.DrawMulti(*m_VAO, *m_IndexBuffer, shader, m_Counts.data(), m_Offsets.data(), m_BaseVertices.data(), m_VisibleCount);
+    }
+    return m_VisibleCount;
+}
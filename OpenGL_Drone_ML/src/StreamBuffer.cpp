@@ -0,0 +1,146 @@
+#include "StreamBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "GLState.h"
+
+StreamBuffer::Stats StreamBuffer::s_Frame, StreamBuffer::s_LastFrame;
+
+StreamBuffer::StreamBuffer(GLenum target, unsigned int regionSize)
+    : m_Target(target), m_RendererID(0), m_RegionSize(std::max(1u, regionSize)), m_Region(0), m_Size(0),
+      m_Mapped(nullptr), m_Fences()
+{
+    Allocate();
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    Release();
+}
+
+// Uploads go through GL_COPY_WRITE_BUFFER, binding an element buffer would change whichever
+// VAO happens to be bound
+void StreamBuffer::Allocate()
+{
+    const GLsizeiptr total = (GLsizeiptr)m_RegionSize * FRAMES;
+    GLCall(glGenBuffers(1, &m_RendererID));
+    GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+    if (GLEW_ARB_buffer_storage || GLEW_VERSION_4_4)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLCall(glBufferStorage(GL_COPY_WRITE_BUFFER, total, nullptr, flags));
+        GLCall(m_Mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, total, flags));
+    }
+    else
+    {
+        GLCall(glBufferData(GL_COPY_WRITE_BUFFER, total, nullptr, GL_STREAM_DRAW));
+    }
+    m_Region = 0;
+    m_Size = 0;
+}
+
+void StreamBuffer::Release()
+{
+    for (GLsync& fence : m_Fences)
+    {
+        if (fence)
+        {
+            GLCall(glDeleteSync(fence));
+        }
+        fence = nullptr;
+    }
+    if (m_Mapped)
+    {
+        GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+        GLCall(glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+        m_Mapped = nullptr;
+    }
+    GLState::OnDeleteBuffer(m_RendererID);
+    GLCall(glDeleteBuffers(1, &m_RendererID));
+    m_RendererID = 0;
+}
+
+void StreamBuffer::WaitForRegion(unsigned int region)
+{
+    GLsync& fence = m_Fences[region];
+    if (!fence)
+        return;
+    GLCall(GLenum status = glClientWaitSync(fence, 0, 0));
+    if (status == GL_TIMEOUT_EXPIRED)
+    {
+        s_Frame.stalls++;
+        do
+        {
+            GLCall(status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000)); // 1 s
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    GLCall(glDeleteSync(fence));
+    fence = nullptr;
+}
+
+bool StreamBuffer::Write(const void* data, unsigned int size)
+{
+    if (size == m_Size && std::memcmp(m_Last.data(), data, size) == 0)
+    {
+        s_Frame.skipped++;
+        return false;
+    }
+
+    if (size > m_RegionSize)
+    {
+        Release();
+        m_RegionSize = std::max(size, m_RegionSize * 2);
+        Allocate();
+    }
+    else
+    {
+        m_Region = (m_Region + 1) % FRAMES;
+    }
+
+    if (m_Mapped)
+    {
+        WaitForRegion(m_Region);
+        std::memcpy(m_Mapped + GetOffset(), data, size);
+    }
+    else
+    {
+        GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+        // Wrapping around orphans the storage, the driver keeps the old one until draws finish
+        if (m_Region == 0)
+        {
+            GLCall(glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)m_RegionSize * FRAMES, nullptr, GL_STREAM_DRAW));
+        }
+        GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, GetOffset(), size, data));
+    }
+
+    m_Last.assign((const unsigned char*)data, (const unsigned char*)data + size);
+    m_Size = size;
+    s_Frame.writes++;
+    s_Frame.bytes += size;
+    return true;
+}
+
+void StreamBuffer::Fence()
+{
+    if (!m_Mapped)
+        return; // orphaning needs no fences
+    GLsync& fence = m_Fences[m_Region];
+    if (fence)
+    {
+        GLCall(glDeleteSync(fence));
+    }
+    GLCall(fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+}
+
+void StreamBuffer::Bind() const
+{
+    GLState::BindBuffer(m_Target, m_RendererID);
+}
+
+StreamBuffer::Stats StreamBuffer::NewFrame()
+{
+    s_LastFrame = s_Frame;
+    s_Frame = Stats();
+    return s_LastFrame;
+}
@@ -0,0 +1,35 @@
+#include "StreamingMesh.h"
+
+StreamingMesh::StreamingMesh(unsigned int stride, const VertexBufferLayout& layout, unsigned int maxVertices, unsigned int maxIndices)
+    : m_Stride(stride), m_Layout(layout), m_VertexBufferID(0), m_IndexCount(0)
+{
+    m_VAO = std::make_unique<VertexArray>();
+    m_Vertices = std::make_unique<StreamBuffer>(GL_ARRAY_BUFFER, maxVertices * stride);
+    m_Indices = std::make_unique<StreamBuffer>(GL_ELEMENT_ARRAY_BUFFER, maxIndices * sizeof(unsigned int));
+}
+
+bool StreamingMesh::Update(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+    bool changed = m_Vertices->Write(vertices, vertexCount * m_Stride);
+    changed |= m_Indices->Write(indices, indexCount * sizeof(unsigned int));
+    m_IndexCount = indexCount;
+
+    // The vertex ring grew into a new buffer, point the attributes at it
+    if (m_VertexBufferID != m_Vertices->GetRendererID())
+    {
+        m_VertexBufferID = m_Vertices->GetRendererID();
+        m_VAO->AddBuffer(*m_Vertices, m_Layout);
+    }
+    return changed;
+}
+
+void StreamingMesh::Draw(const Renderer& renderer, const Shader& shader)
+{
+    if (m_IndexCount == 0)
+        return;
+    m_VAO->Bind();
+    m_Indices->Bind();
+    renderer.DrawBaseVertex(*m_VAO, shader, m_IndexCount, m_Indices->GetOffset(), (int)(m_Vertices->GetOffset() / m_Stride));
+    m_Vertices->Fence();
+    m_Indices->Fence();
+}
@@ -0,0 +1,286 @@
+#include "TerrainGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TERRAIN_NOISE_SSE2
+#include <emmintrin.h>
+#endif
+
+// ------------------------
+// Scalar noise
+// ------------------------
+
+static inline std::uint32_t HashLattice(std::int32_t x, std::int32_t z, std::uint32_t seed)
+{
+    std::uint32_t h = seed + (std::uint32_t)x * 0x27d4eb2du + (std::uint32_t)z * 0x165667b1u;
+    h ^= h >> 15;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static inline float LatticeValue(std::int32_t x, std::int32_t z, std::uint32_t seed)
+{
+    return (float)(std::int32_t)(HashLattice(x, z, seed) & 0xffffff) * (2.0f / 16777215.0f) - 1.0f;
+}
+
+// Value noise in [-1, 1] with analytic derivatives (quintic fade)
+static inline void ValueNoise(float x, float z, std::uint32_t seed, float& value, float& dx, float& dz)
+{
+    float fx = std::floor(x), fz = std::floor(z);
+    std::int32_t ix = (std::int32_t)fx, iz = (std::int32_t)fz;
+    float tx = x - fx, tz = z - fz;
+
+    float ux = tx * tx * tx * (tx * (tx * 6.0f - 15.0f) + 10.0f);
+    float uz = tz * tz * tz * (tz * (tz * 6.0f - 15.0f) + 10.0f);
+    float dux = 30.0f * tx * tx * (tx * (tx - 2.0f) + 1.0f);
+    float duz = 30.0f * tz * tz * (tz * (tz - 2.0f) + 1.0f);
+
+    float a = LatticeValue(ix, iz, seed);
+    float b = LatticeValue(ix + 1, iz, seed);
+    float c = LatticeValue(ix, iz + 1, seed);
+    float d = LatticeValue(ix + 1, iz + 1, seed);
+    float k = a - b - c + d;
+
+    value = a + (b - a) * ux + (c - a) * uz + k * ux * uz;
+    dx = dux * ((b - a) + k * uz);
+    dz = duz * ((c - a) + k * ux);
+}
+
+// fBm with a ridged blend and derivative based erosion (detail fades where the slope so far is steep)
+static float Fbm(float x, float z, const TerrainNoiseSettings& s)
+{
+    float px = x * s.frequency, pz = z * s.frequency;
+    float sum = 0.0f, norm = 0.0f, amplitude = 1.0f;
+    float slopeX = 0.0f, slopeZ = 0.0f;
+    for (int o = 0; o < s.octaves; o++)
+    {
+        float n, dx, dz;
+        ValueNoise(px, pz, s.seed + (std::uint32_t)o * 1013u, n, dx, dz);
+
+        float ridge = 1.0f - std::fabs(n);
+        ridge = ridge * ridge * 2.0f - 1.0f;
+        float octave = n + (ridge - n) * s.ridged;
+
+        slopeX += dx;
+        slopeZ += dz;
+        float damping = 1.0f / (1.0f + s.erosion * (slopeX * slopeX + slopeZ * slopeZ));
+
+        sum += amplitude * octave * damping;
+        norm += amplitude;
+        amplitude *= s.gain;
+
+        // rotate each octave so lattice artifacts do not line up
+        float rx = (0.8f * px - 0.6f * pz) * s.lacunarity;
+        float rz = (0.6f * px + 0.8f * pz) * s.lacunarity;
+        px = rx;
+        pz = rz;
+    }
+    return sum / norm * s.heightScale;
+}
+
+// ------------------------
+// SSE2 noise, 4 samples per call, mirrors the scalar path operation for operation
+// ------------------------
+
+#ifdef TERRAIN_NOISE_SSE2
+
+static inline __m128i MulLo32(__m128i a, __m128i b)
+{
+    // SSE2 has no 32 bit mullo, multiply even and odd lanes separately and interleave
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static inline __m128 LatticeValue4(__m128i x, __m128i z, __m128i seed)
+{
+    __m128i h = _mm_add_epi32(seed, _mm_add_epi32(MulLo32(x, _mm_set1_epi32((int)0x27d4eb2du)), MulLo32(z, _mm_set1_epi32((int)0x165667b1u))));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+    h = MulLo32(h, _mm_set1_epi32((int)0x85ebca6bu));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 13));
+    h = MulLo32(h, _mm_set1_epi32((int)0xc2b2ae35u));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 16));
+    __m128 v = _mm_cvtepi32_ps(_mm_and_si128(h, _mm_set1_epi32(0xffffff)));
+    return _mm_sub_ps(_mm_mul_ps(v, _mm_set1_ps(2.0f / 16777215.0f)), _mm_set1_ps(1.0f));
+}
+
+static inline __m128 Floor4(__m128 x)
+{
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f)));
+}
+
+static inline void ValueNoise4(__m128 x, __m128 z, std::uint32_t seed, __m128& value, __m128& dx, __m128& dz)
+{
+    const __m128 c6 = _mm_set1_ps(6.0f), c15 = _mm_set1_ps(15.0f), c10 = _mm_set1_ps(10.0f);
+    const __m128 c30 = _mm_set1_ps(30.0f), c2 = _mm_set1_ps(2.0f), c1 = _mm_set1_ps(1.0f);
+
+    __m128 fx = Floor4(x), fz = Floor4(z);
+    __m128i ix = _mm_cvttps_epi32(fx), iz = _mm_cvttps_epi32(fz);
+    __m128 tx = _mm_sub_ps(x, fx), tz = _mm_sub_ps(z, fz);
+
+    __m128 ux = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(tx, tx), tx), _mm_add_ps(_mm_mul_ps(tx, _mm_sub_ps(_mm_mul_ps(tx, c6), c15)), c10));
+    __m128 uz = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(tz, tz), tz), _mm_add_ps(_mm_mul_ps(tz, _mm_sub_ps(_mm_mul_ps(tz, c6), c15)), c10));
+    __m128 dux = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(c30, tx), tx), _mm_add_ps(_mm_mul_ps(tx, _mm_sub_ps(tx, c2)), c1));
+    __m128 duz = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(c30, tz), tz), _mm_add_ps(_mm_mul_ps(tz, _mm_sub_ps(tz, c2)), c1));
+
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i s = _mm_set1_epi32((int)seed);
+    __m128 a = LatticeValue4(ix, iz, s);
+    __m128 b = LatticeValue4(_mm_add_epi32(ix, one), iz, s);
+    __m128 c = LatticeValue4(ix, _mm_add_epi32(iz, one), s);
+    __m128 d = LatticeValue4(_mm_add_epi32(ix, one), _mm_add_epi32(iz, one), s);
+    __m128 k = _mm_add_ps(_mm_sub_ps(_mm_sub_ps(a, b), c), d);
+
+    __m128 ba = _mm_sub_ps(b, a), ca = _mm_sub_ps(c, a);
+    value = _mm_add_ps(_mm_add_ps(_mm_add_ps(a, _mm_mul_ps(ba, ux)), _mm_mul_ps(ca, uz)), _mm_mul_ps(_mm_mul_ps(k, ux), uz));
+    dx = _mm_mul_ps(dux, _mm_add_ps(ba, _mm_mul_ps(k, uz)));
+    dz = _mm_mul_ps(duz, _mm_add_ps(ca, _mm_mul_ps(k, ux)));
+}
+
+static __m128 Fbm4(__m128 x, __m128 z, const TerrainNoiseSettings& s)
+{
+    const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 ridged = _mm_set1_ps(s.ridged), erosion = _mm_set1_ps(s.erosion), lacunarity = _mm_set1_ps(s.lacunarity);
+    const __m128 c08 = _mm_set1_ps(0.8f), c06 = _mm_set1_ps(0.6f);
+
+    __m128 px = _mm_mul_ps(x, _mm_set1_ps(s.frequency)), pz = _mm_mul_ps(z, _mm_set1_ps(s.frequency));
+    __m128 sum = _mm_setzero_ps(), slopeX = _mm_setzero_ps(), slopeZ = _mm_setzero_ps();
+    float norm = 0.0f, amplitude = 1.0f;
+    for (int o = 0; o < s.octaves; o++)
+    {
+        __m128 n, dx, dz;
+        ValueNoise4(px, pz, s.seed + (std::uint32_t)o * 1013u, n, dx, dz);
+
+        __m128 ridge = _mm_sub_ps(one, _mm_and_ps(n, absMask));
+        ridge = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(ridge, ridge), two), one);
+        __m128 octave = _mm_add_ps(n, _mm_mul_ps(_mm_sub_ps(ridge, n), ridged));
+
+        slopeX = _mm_add_ps(slopeX, dx);
+        slopeZ = _mm_add_ps(slopeZ, dz);
+        __m128 slope2 = _mm_add_ps(_mm_mul_ps(slopeX, slopeX), _mm_mul_ps(slopeZ, slopeZ));
+        __m128 damping = _mm_div_ps(one, _mm_add_ps(one, _mm_mul_ps(erosion, slope2)));
+
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(amplitude), octave), damping));
+        norm += amplitude;
+        amplitude *= s.gain;
+
+        __m128 rx = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(c08, px), _mm_mul_ps(c06, pz)), lacunarity);
+        __m128 rz = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(c06, px), _mm_mul_ps(c08, pz)), lacunarity);
+        px = rx;
+        pz = rz;
+    }
+    return _mm_mul_ps(_mm_div_ps(sum, _mm_set1_ps(norm)), _mm_set1_ps(s.heightScale));
+}
+
+#endif
+
+// ------------------------
+// TerrainGenerator
+// ------------------------
+
+glm::vec3 TerrainColor(float t, const glm::vec3& normal)
+{
+    static const glm::vec3 sun = glm::normalize(glm::vec3(0.4f, 1.0f, 0.3f));
+    t = std::clamp(t, 0.0f, 1.0f);
+    float rock = std::clamp((0.85f - normal.y) * 4.0f, 0.0f, 1.0f);
+    float snow = std::clamp((t - 0.75f) * 6.0f, 0.0f, 1.0f) * (1.0f - rock);
+    glm::vec3 color = glm::mix(glm::vec3(0.22f, 0.42f, 0.16f), glm::vec3(0.45f, 0.40f, 0.35f), rock);
+    color = glm::mix(color, glm::vec3(0.95f, 0.95f, 0.97f), snow);
+    return color * (0.35f + 0.65f * std::max(0.0f, glm::dot(normal, sun)));
+}
+
+TerrainGenerator::TerrainGenerator(const TerrainNoiseSettings& settings, float tileSize, unsigned int resolution)
+    : m_Settings(settings), m_TileSize(tileSize), m_Resolution(std::max(1u, resolution))
+{
+}
+
+float TerrainGenerator::Height(float x, float z) const
+{
+    return Fbm(x, z, m_Settings);
+}
+
+void TerrainGenerator::HeightRow(int sampleX, int sampleZ, float spacing, unsigned int count, float* out) const
+{
+    const float z = (float)sampleZ * spacing;
+    unsigned int i = 0;
+#ifdef TERRAIN_NOISE_SSE2
+    const __m128 zs = _mm_set1_ps(z);
+    const __m128 sp = _mm_set1_ps(spacing);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i sx = _mm_add_epi32(_mm_set1_epi32(sampleX + (int)i), _mm_set_epi32(3, 2, 1, 0));
+        _mm_storeu_ps(out + i, Fbm4(_mm_mul_ps(_mm_cvtepi32_ps(sx), sp), zs, m_Settings));
+    }
+#endif
+    for (; i < count; i++)
+        out[i] = Fbm((float)(sampleX + (int)i) * spacing, z, m_Settings);
+}
+
+bool TerrainGenerator::LoadTile(int gridX, int gridZ, TerrainTile& out) const
+{
+    const unsigned int n = m_Resolution;
+    const unsigned int side = n + 1;
+    const float spacing = m_TileSize / n;
+    const int firstX = gridX * (int)n, firstZ = gridZ * (int)n;
+
+    // Heights with a one sample apron so normals at the border match the neighbouring tile
+    const unsigned int apron = side + 2;
+    std::vector<float> heights(apron * apron);
+    for (unsigned int row = 0; row < apron; row++)
+        HeightRow(firstX - 1, firstZ - 1 + (int)row, spacing, apron, &heights[row * apron]);
+    auto H = [&](unsigned int x, unsigned int z) { return heights[(z + 1) * apron + (x + 1)]; };
+
+    out.gridX = gridX;
+    out.gridZ = gridZ;
+    out.bounds = AABB();
+    out.vertices.resize(side * side * sizeof(TerrainVertex));
+    TerrainVertex* vertices = reinterpret_cast<TerrainVertex*>(out.vertices.data());
+
+    for (unsigned int z = 0; z < side; z++)
+    {
+        for (unsigned int x = 0; x < side; x++)
+        {
+            float h = H(x, z);
+            glm::vec3 normal = glm::normalize(glm::vec3(H(x - 1, z) - H(x + 1, z), 2.0f * spacing, H(x, z - 1) - H(x, z + 1)));
+
+            glm::vec3 color = TerrainColor(h / m_Settings.heightScale * 0.5f + 0.5f, normal);
+
+            TerrainVertex& v = vertices[z * side + x];
+            v.x = (float)(firstX + (int)x) * spacing;
+            v.y = h;
+            v.z = (float)(firstZ + (int)z) * spacing;
+            v.r = color.r;
+            v.g = color.g;
+            v.b = color.b;
+            v.u = (float)x / n;
+            v.v = (float)z / n;
+            v.texSlot = -1.0f; // vertex colour only
+            out.bounds.Expand(glm::vec3(v.x, v.y, v.z));
+        }
+    }
+
+    out.indices.resize(n * n * 6);
+    unsigned int* index = out.indices.data();
+    for (unsigned int z = 0; z < n; z++)
+    {
+        for (unsigned int x = 0; x < n; x++)
+        {
+            unsigned int a = z * side + x;
+            *index++ = a;
+            *index++ = a + side;
+            *index++ = a + side + 1;
+            *index++ = a + side + 1;
+            *index++ = a + 1;
+            *index++ = a;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,331 @@
+#include "TerrainStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+static bool RayIntersectsAABB(const glm::vec3& orig, const glm::vec3& dir, const AABB& box, float maxT)
+{
+    float tMin = 0.0f, tMax = maxT;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (std::fabs(dir[axis]) < 1e-8f)
+        {
+            if (orig[axis] < box.min[axis] || orig[axis] > box.max[axis])
+                return false;
+            continue;
+        }
+        float inv = 1.0f / dir[axis];
+        float t0 = (box.min[axis] - orig[axis]) * inv;
+        float t1 = (box.max[axis] - orig[axis]) * inv;
+        if (t0 > t1)
+            std::swap(t0, t1);
+        tMin = std::max(tMin, t0);
+        tMax = std::min(tMax, t1);
+        if (tMin > tMax)
+            return false;
+    }
+    return true;
+}
+
+// Moller-Trumbore, same test the 3D tests use against m_Terrain
+static bool RayIntersectsTriangle(const glm::vec3& orig, const glm::vec3& dir,
+    const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, float& outT)
+{
+    const float EPSILON = 1e-8f;
+    glm::vec3 edge1 = v1 - v0;
+    glm::vec3 edge2 = v2 - v0;
+    glm::vec3 h = glm::cross(dir, edge2);
+    float a = glm::dot(edge1, h);
+    if (std::fabs(a) < EPSILON)
+        return false; // ray parallel
+
+    float f = 1.0f / a;
+    glm::vec3 s = orig - v0;
+    float u = f * glm::dot(s, h);
+    if (u < 0.0f || u > 1.0f)
+        return false;
+
+    glm::vec3 q = glm::cross(s, edge1);
+    float v = f * glm::dot(dir, q);
+    if (v < 0.0f || u + v > 1.0f)
+        return false;
+
+    float t = f * glm::dot(edge2, q);
+    if (t > EPSILON)
+    {
+        outT = t;
+        return true;
+    }
+    return false;
+}
+
+TerrainStreamer::TerrainStreamer(std::unique_ptr<TileSource> source, const VertexBufferLayout& layout,
+    unsigned int poolSize, float loadRadius, unsigned int workerCount)
+    : m_Source(std::move(source)), m_LoadRadius(loadRadius), m_UploadBudget(4), m_Frame(0), m_Stop(false),
+      m_UploadsLastFrame(0), m_BytesUploadedLastFrame(0), m_Evictions(0), m_VisibleCount(0)
+{
+    if (layout.GetStride() != m_Source->GetStride())
+    {
+        // Tiles baked for another vertex format, their bytes would be read as garbage
+        std::cout << "TerrainStreamer: source stride " << m_Source->GetStride() << " does not match the layout's "
+            << layout.GetStride() << ", nothing will stream" << std::endl;
+        return;
+    }
+
+    // Fixed pool, every slot is big enough for the largest tile the source can produce
+    const unsigned int vertexBytes = m_Source->GetMaxVertexCount() * m_Source->GetStride();
+    const unsigned int indexCount = m_Source->GetMaxIndexCount();
+    m_Slots.resize(poolSize);
+    for (auto& slot : m_Slots)
+    {
+        slot.va = std::make_unique<VertexArray>();
+        slot.vb = std::make_unique<VertexBuffer>(vertexBytes);
+        slot.va->AddBuffer(*slot.vb, layout);
+        slot.ib = std::make_unique<IndexBuffer>(indexCount);
+    }
+
+    for (unsigned int i = 0; i < std::max(1u, workerCount); i++)
+        m_Workers.emplace_back(&TerrainStreamer::WorkerThreadFunc, this);
+}
+
+TerrainStreamer::~TerrainStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_cv.notify_all();
+    for (auto& worker : m_Workers)
+        worker.join();
+}
+
+void TerrainStreamer::WorkerThreadFunc()
+{
+    const unsigned int stride = m_Source->GetStride();
+    while (true)
+    {
+        std::int64_t key;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_cv.wait(lock, [this]() { return m_Stop || !m_Requests.empty(); });
+            if (m_Stop)
+                return;
+            key = m_Requests.front();
+            m_Requests.pop_front();
+            m_Loading.insert(key);
+        }
+
+        LoadedTile loaded;
+        int gridX = (int)(key >> 32), gridZ = (int)(std::int32_t)(key & 0xffffffff);
+        bool ok = m_Source->LoadTile(gridX, gridZ, loaded.tile);
+        if (ok)
+        {
+            // Build the collision soup here so the main thread only has to swap it in
+            const TerrainTile& tile = loaded.tile;
+            loaded.triangles.resize(tile.indices.size());
+            for (size_t i = 0; i < tile.indices.size(); i++)
+            {
+                float p[3];
+                std::memcpy(p, tile.vertices.data() + (size_t)tile.indices[i] * stride, sizeof(p));
+                loaded.triangles[i] = glm::vec3(p[0], p[1], p[2]);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (ok)
+            m_Loaded.push(std::move(loaded));
+        else
+            m_Loading.erase(key);
+    }
+}
+
+float TerrainStreamer::DistanceToFocus(const AABB& bounds) const
+{
+    float best = std::numeric_limits<float>::max();
+    for (const auto& focus : m_FocusPoints)
+    {
+        // horizontal distance from the focus to the closest point of the box
+        float dx = std::max({ bounds.min.x - focus.x, 0.0f, focus.x - bounds.max.x });
+        float dz = std::max({ bounds.min.z - focus.z, 0.0f, focus.z - bounds.max.z });
+        best = std::min(best, std::sqrt(dx * dx + dz * dz));
+    }
+    return best;
+}
+
+int TerrainStreamer::FindSlotForUpload() const
+{
+    int victim = -1;
+    std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+    float furthest = -1.0f;
+    for (unsigned int i = 0; i < m_Slots.size(); i++)
+    {
+        const Slot& slot = m_Slots[i];
+        if (!slot.resident)
+            return i;
+        if (m_Desired.count(TileFile::PackCoords(slot.gridX, slot.gridZ)))
+            continue; // still wanted this frame, never evict
+
+        // LRU first, distance breaks ties between tiles dropped on the same frame
+        float distance = DistanceToFocus(slot.bounds);
+        if (slot.lastUsedFrame < oldest || (slot.lastUsedFrame == oldest && distance > furthest))
+        {
+            victim = i;
+            oldest = slot.lastUsedFrame;
+            furthest = distance;
+        }
+    }
+    return victim;
+}
+
+void TerrainStreamer::Upload(LoadedTile& loaded)
+{
+    int index = FindSlotForUpload();
+    if (index < 0)
+        return; // every slot holds a wanted tile, drop it and ask again later
+
+    Slot& slot = m_Slots[index];
+    if (slot.resident)
+    {
+        m_Resident.erase(TileFile::PackCoords(slot.gridX, slot.gridZ));
+        m_Evictions++;
+    }
+
+    const TerrainTile& tile = loaded.tile;
+    slot.vb->SetData(tile.vertices.data(), (unsigned int)tile.vertices.size());
+    slot.ib->SetData(tile.indices.data(), (unsigned int)tile.indices.size());
+
+    slot.resident = true;
+    slot.gridX = tile.gridX;
+    slot.gridZ = tile.gridZ;
+    slot.bounds = tile.bounds;
+    slot.lastUsedFrame = m_Frame;
+    slot.triangles = std::move(loaded.triangles);
+    m_Resident[TileFile::PackCoords(tile.gridX, tile.gridZ)] = index;
+
+    m_UploadsLastFrame++;
+    m_BytesUploadedLastFrame += tile.vertices.size() + tile.indices.size() * sizeof(unsigned int);
+}
+
+void TerrainStreamer::Update(const std::vector<glm::vec3>& focusPoints)
+{
+    m_Frame++;
+    m_FocusPoints = focusPoints;
+    m_UploadsLastFrame = 0;
+    m_BytesUploadedLastFrame = 0;
+
+    // Tiles within the load radius of any focus point, closest first, trimmed to the pool size
+    const float tileSize = m_Source->GetTileSize();
+    std::vector<std::pair<float, std::int64_t>> wanted;
+    std::unordered_set<std::int64_t> seen;
+    for (const auto& focus : m_FocusPoints)
+    {
+        int x0 = (int)std::floor((focus.x - m_LoadRadius) / tileSize), x1 = (int)std::floor((focus.x + m_LoadRadius) / tileSize);
+        int z0 = (int)std::floor((focus.z - m_LoadRadius) / tileSize), z1 = (int)std::floor((focus.z + m_LoadRadius) / tileSize);
+        for (int z = z0; z <= z1; z++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                std::int64_t key = TileFile::PackCoords(x, z);
+                if (seen.count(key) || !m_Source->HasTile(x, z))
+                    continue;
+                seen.insert(key);
+
+                AABB cell;
+                cell.Expand(glm::vec3(x * tileSize, 0.0f, z * tileSize));
+                cell.Expand(glm::vec3((x + 1) * tileSize, 0.0f, (z + 1) * tileSize));
+                float distance = DistanceToFocus(cell);
+                if (distance <= m_LoadRadius)
+                    wanted.push_back({ distance, key });
+            }
+        }
+    }
+    std::sort(wanted.begin(), wanted.end());
+    if (wanted.size() > m_Slots.size())
+        wanted.resize(m_Slots.size());
+
+    m_Desired.clear();
+    for (const auto& entry : wanted)
+    {
+        m_Desired.insert(entry.second);
+        auto it = m_Resident.find(entry.second);
+        if (it != m_Resident.end())
+            m_Slots[it->second].lastUsedFrame = m_Frame;
+    }
+
+    std::vector<LoadedTile> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (unsigned int i = 0; i < m_UploadBudget && !m_Loaded.empty(); i++)
+        {
+            finished.push_back(std::move(m_Loaded.front()));
+            m_Loaded.pop();
+        }
+    }
+
+    // Swap in finished tiles, skipping ones the drone already flew away from. The GL uploads run
+    // unlocked so the I/O threads never wait on them
+    for (LoadedTile& loaded : finished)
+    {
+        std::int64_t key = TileFile::PackCoords(loaded.tile.gridX, loaded.tile.gridZ);
+        if (m_Desired.count(key) && !m_Resident.count(key))
+            Upload(loaded);
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    // Still in m_Loading until now, so they were not asked for again while uploading
+    for (const LoadedTile& loaded : finished)
+        m_Loading.erase(TileFile::PackCoords(loaded.tile.gridX, loaded.tile.gridZ));
+
+    // Replace the request queue so stale requests never reach the disk
+    m_Requests.clear();
+    for (const auto& entry : wanted)
+    {
+        if (!m_Resident.count(entry.second) && !m_Loading.count(entry.second))
+            m_Requests.push_back(entry.second);
+    }
+    if (!m_Requests.empty())
+        m_cv.notify_all();
+}
+
+unsigned int TerrainStreamer::Draw(const Renderer& renderer, const Shader& shader, const glm::mat4& viewProj)
+{
+    Frustum frustum(viewProj);
+    m_VisibleCount = 0;
+    for (const auto& slot : m_Slots)
+    {
+        if (!slot.resident || !frustum.IsVisible(slot.bounds))
+            continue;
+        renderer.Draw(*slot.va, *slot.ib, shader);
+        m_VisibleCount++;
+    }
+    return m_VisibleCount;
+}
+
+bool TerrainStreamer::Raycast(const glm::vec3& origin, const glm::vec3& dir, float& outT) const
+{
+    float closest = std::numeric_limits<float>::max();
+    for (const auto& slot : m_Slots)
+    {
+        if (!slot.resident || !RayIntersectsAABB(origin, dir, slot.bounds, closest))
+            continue;
+        for (size_t i = 0; i + 2 < slot.triangles.size(); i += 3)
+        {
+            float t;
+            if (RayIntersectsTriangle(origin, dir, slot.triangles[i], slot.triangles[i + 1], slot.triangles[i + 2], t) && t < closest)
+                closest = t;
+        }
+    }
+    if (closest == std::numeric_limits<float>::max())
+        return false;
+    outT = closest;
+    return true;
+}
+
+unsigned int TerrainStreamer::GetPendingCount()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Requests.size() + m_Loading.size();
+}
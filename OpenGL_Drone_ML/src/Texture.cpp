@@ -1,40 +1,33 @@
 #include "Texture.h"
-#include "stb_image/stb_image.h"
 
 Texture::Texture(const std::string &path)
-    : m_RendererID(0), m_FilePath(path), m_LocalBuffer(nullptr), 
-    m_Width(0), m_Height(0), m_BPP(0)
+    : m_RendererID(TextureLoader::CreateTexture()), m_FilePath(path),
+    m_Width(0), m_Height(0), m_BPP(4)
 {
-    stbi_set_flip_vertically_on_load(1); // makes texture upside down
-    m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
-
-    GLCall(glGenTextures(1, &m_RendererID));
-    GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID))
-
-    // Must specify these parameters to tell system how to handle texture
-    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE)); // s is x coord
-    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE)); // t is y coord
-
-    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
-
-    if (m_LocalBuffer)
-        stbi_image_free(m_LocalBuffer); // frees image data on CPU
+    m_Job = TextureLoader::Load(path, this);
 }
 
 Texture::~Texture()
 {
+    if (m_Job)
+        m_Job->texture = nullptr; // the loader drops it
+    GLState::OnDeleteTexture(m_RendererID);
     GLCall(glDeleteTextures(1, &m_RendererID)); // Delete textures from GPU
 }
 
+void Texture::OnLoaded(int width, int height)
+{
+    m_Width = width;
+    m_Height = height;
+    m_Job.reset();
+}
+
 void Texture::Bind(unsigned int slot) const
 {
-    GLCall(glActiveTexture(GL_TEXTURE0 + slot)); // GL_TEXTURE0 thru GL_TEXTURE31
-    GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID))
+    GLState::BindTexture(slot, GL_TEXTURE_2D, m_RendererID); // GL_TEXTURE0 thru GL_TEXTURE31
 }
 
 void Texture::Unbind() const
 {
-    GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+    GLState::BindTexture(GL_TEXTURE_2D, 0);
 }
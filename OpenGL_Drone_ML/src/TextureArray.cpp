@@ -0,0 +1,124 @@
+#include "TextureArray.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "GLState.h"
+#include "TextureCache.h"
+
+TextureArray::TextureArray(int width, int height, int layers)
+    : m_RendererID(0), m_Width(width), m_Height(height), m_Layers(layers),
+      m_Format(TextureCache::IsSupported() ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : 0), m_Pending(0)
+{
+    GLint maxLayers = 0;
+    GLCall(glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers));
+    if (layers > maxLayers)
+        std::cout << "Texture array of " << layers << " layers exceeds GL_MAX_ARRAY_TEXTURE_LAYERS " << maxLayers << std::endl;
+
+    GLCall(glGenTextures(1, &m_RendererID));
+    GLState::BindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID);
+    GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
+    GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+    GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+    if (GLEW_EXT_texture_filter_anisotropic)
+    {
+        GLfloat maxAnisotropy = 1.0f;
+        GLCall(glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy));
+        GLCall(glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min(maxAnisotropy, 8.0f)));
+    }
+
+    // Grey until loaded, with mips so the array is complete from the first draw
+    const unsigned char greyTexel[4] = {128, 128, 128, 255};
+    if (m_Format)
+    {
+        // One grey block repeated over every level, compressed images can't be mipmapped by GL
+        std::vector<unsigned char> greyTexels(4 * 4 * 4);
+        for (size_t i = 0; i < greyTexels.size(); i += 4)
+            std::copy(greyTexel, greyTexel + 4, &greyTexels[i]);
+        CompressedImage block;
+        TextureCache::Compress(greyTexels.data(), 4, 4, m_Format, block);
+
+        const int levels = TextureCache::LevelCount(width, height);
+        GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1));
+        std::vector<unsigned char> grey;
+        for (int level = 0, w = width, h = height; level < levels; level++, w = std::max(1, w / 2), h = std::max(1, h / 2))
+        {
+            const size_t size = TextureCache::LevelSize(m_Format, w, h) * layers;
+            for (size_t offset = grey.size(); offset < size; offset += block.levels[0].size)
+                grey.insert(grey.end(), block.GetData(), block.GetData() + block.levels[0].size);
+            GLCall(glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, m_Format, w, h, layers, 0, (GLsizei)size, grey.data()));
+        }
+        return;
+    }
+    std::vector<unsigned char> grey((size_t)width * height * layers * 4);
+    for (size_t i = 0; i < grey.size(); i += 4)
+        std::copy(greyTexel, greyTexel + 4, &grey[i]);
+    GLCall(glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey.data()));
+    GLCall(glGenerateMipmap(GL_TEXTURE_2D_ARRAY));
+}
+
+TextureArray::~TextureArray()
+{
+    for (auto& job : m_Jobs)
+        job->array = nullptr; // the loader drops it
+    GLState::OnDeleteTexture(m_RendererID);
+    GLCall(glDeleteTextures(1, &m_RendererID));
+}
+
+void TextureArray::Load(int layer, const std::string& path)
+{
+    m_Jobs.push_back(TextureLoader::Load(path, this, layer));
+    m_Pending++;
+}
+
+void TextureArray::SetLayer(int layer, const unsigned char* pixels, int width, int height)
+{
+    std::vector<unsigned char> scaled;
+    if (width != m_Width || height != m_Height)
+    {
+        scaled.resize((size_t)m_Width * m_Height * 4);
+        TextureLoader::Resample(pixels, width, height, scaled.data(), m_Width, m_Height);
+        pixels = scaled.data();
+    }
+    GLState::BindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID);
+    if (m_Format)
+    {
+        CompressedImage image;
+        TextureCache::Compress(pixels, m_Width, m_Height, m_Format, image);
+        for (size_t i = 0; i < image.levels.size(); i++)
+        {
+            const CompressedImage::Level& level = image.levels[i];
+            GLCall(glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, (GLint)i, 0, 0, layer, level.width, level.height, 1,
+                m_Format, (GLsizei)level.size, image.GetData() + level.offset));
+        }
+        return;
+    }
+    GLCall(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, m_Width, m_Height, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+    GLCall(glGenerateMipmap(GL_TEXTURE_2D_ARRAY));
+}
+
+// Also called when the file failed to load, the layer then stays grey. Mips are rebuilt for
+// the whole array each time, there are only ever a few layers. A compressed layer came with
+// its mips
+void TextureArray::OnLayerLoaded(int layer)
+{
+    for (auto it = m_Jobs.begin(); it != m_Jobs.end(); ++it)
+    {
+        if ((*it)->layer == layer)
+        {
+            m_Jobs.erase(it);
+            break;
+        }
+    }
+    m_Pending--;
+    if (m_Format)
+        return;
+    GLState::BindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID);
+    GLCall(glGenerateMipmap(GL_TEXTURE_2D_ARRAY));
+}
+
+void TextureArray::Bind(unsigned int slot) const
+{
+    GLState::BindTexture(slot, GL_TEXTURE_2D_ARRAY, m_RendererID);
+}
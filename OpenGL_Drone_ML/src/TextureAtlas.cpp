@@ -0,0 +1,83 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "TextureLoader.h"
+#include "stb_image/stb_image.h"
+
+TextureAtlas::TextureAtlas(int size, int padding)
+    : m_Size(size), m_Padding(padding), m_Pixels((size_t)size * size * 4, 0),
+      m_ShelfX(0), m_ShelfY(0), m_ShelfHeight(0)
+{
+}
+
+bool TextureAtlas::Add(const std::string& name, const std::string& path, int maxSize)
+{
+    int width = 0, height = 0, channels = 0;
+    stbi_set_flip_vertically_on_load_thread(1);
+    unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+    if (!pixels)
+    {
+        std::cout << "Failed to load atlas image " << path << ": " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+
+    bool added;
+    if (width > maxSize || height > maxSize)
+    {
+        const float scale = (float)maxSize / std::max(width, height);
+        const int scaledWidth = std::max(1, (int)(width * scale)), scaledHeight = std::max(1, (int)(height * scale));
+        std::vector<unsigned char> scaled((size_t)scaledWidth * scaledHeight * 4);
+        TextureLoader::Resample(pixels, width, height, scaled.data(), scaledWidth, scaledHeight);
+        added = Add(name, scaled.data(), scaledWidth, scaledHeight);
+    }
+    else
+    {
+        added = Add(name, pixels, width, height);
+    }
+    stbi_image_free(pixels);
+    return added;
+}
+
+bool TextureAtlas::Add(const std::string& name, const unsigned char* pixels, int width, int height)
+{
+    const int cellWidth = width + 2 * m_Padding, cellHeight = height + 2 * m_Padding;
+    if (m_ShelfX + cellWidth > m_Size)
+    {
+        // Next shelf
+        m_ShelfY += m_ShelfHeight;
+        m_ShelfX = 0;
+        m_ShelfHeight = 0;
+    }
+    if (cellWidth > m_Size || m_ShelfY + cellHeight > m_Size)
+    {
+        std::cout << "Texture atlas is full, " << name << " was not added" << std::endl;
+        return false;
+    }
+
+    // Copy with the border clamped to the image edge
+    for (int y = 0; y < cellHeight; y++)
+    {
+        const int sy = std::min(std::max(y - m_Padding, 0), height - 1);
+        for (int x = 0; x < cellWidth; x++)
+        {
+            const int sx = std::min(std::max(x - m_Padding, 0), width - 1);
+            const unsigned char* source = pixels + ((size_t)sy * width + sx) * 4;
+            unsigned char* destination = &m_Pixels[((size_t)(m_ShelfY + y) * m_Size + m_ShelfX + x) * 4];
+            std::copy(source, source + 4, destination);
+        }
+    }
+
+    const float size = (float)m_Size;
+    m_Rects[name] = glm::vec4((m_ShelfX + m_Padding) / size, (m_ShelfY + m_Padding) / size, width / size, height / size);
+    m_ShelfX += cellWidth;
+    m_ShelfHeight = std::max(m_ShelfHeight, cellHeight);
+    return true;
+}
+
+glm::vec4 TextureAtlas::GetRect(const std::string& name) const
+{
+    auto it = m_Rects.find(name);
+    return it != m_Rects.end() ? it->second : glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+}
@@ -0,0 +1,398 @@
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+#include "TextureLoader.h"
+#include "stb_image/stb_image.h"
+
+std::string TextureCache::s_Directory;
+bool TextureCache::s_Supported = false;
+TextureCache::Stats TextureCache::s_Stats;
+
+static const uint32_t CACHE_MAGIC = 0x58544342; // "BCTX"
+static const uint32_t CACHE_VERSION = 1;        // bump when the encoder or layout changes
+
+struct CacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;     // guards against a renamed or truncated file
+    uint32_t format;
+    uint32_t levels;  // followed by a CacheLevel each, then the data
+};
+
+struct CacheLevel
+{
+    uint32_t width, height;
+    uint64_t offset, size; // from the end of the level table
+};
+
+// FNV-1a, continued from hash
+static uint64_t Hash(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= ((const unsigned char*)data)[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+void TextureCache::Init(const std::string& directory)
+{
+    s_Directory = directory;
+    s_Supported = GLEW_EXT_texture_compression_s3tc;
+    if (s_Supported)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(s_Directory, error);
+        if (error)
+        {
+            std::cout << "Texture cache: can't create " << s_Directory << ", " << error.message() << std::endl;
+            s_Supported = false;
+        }
+    }
+}
+
+bool TextureCache::Get(const std::string& path, int width, int height, bool forceAlpha, CompressedImage& image,
+    const char** reason)
+{
+    std::error_code error;
+    const uint64_t fileSize = std::filesystem::file_size(path, error);
+    if (error)
+    {
+        if (reason)
+            *reason = "can't open";
+        return false;
+    }
+    const int64_t writeTime = (int64_t)std::filesystem::last_write_time(path, error).time_since_epoch().count();
+
+    uint64_t key = Hash(path.data(), path.size());
+    const int64_t fields[] = {(int64_t)fileSize, writeTime, width, height, forceAlpha, CACHE_VERSION};
+    key = Hash(fields, sizeof(fields), key);
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "_%016llx.bctex", (unsigned long long)key);
+    const std::string cachePath = s_Directory + "/" + std::filesystem::path(path).stem().string() + name;
+    if (Load(cachePath, key, image))
+    {
+        s_Stats.hits++;
+        return true;
+    }
+
+    int sourceWidth = 0, sourceHeight = 0, channels = 0;
+    stbi_set_flip_vertically_on_load_thread(1); // GL wants the bottom row first
+    unsigned char* pixels = stbi_load(path.c_str(), &sourceWidth, &sourceHeight, &channels, 4);
+    if (!pixels)
+    {
+        if (reason)
+            *reason = stbi_failure_reason();
+        return false;
+    }
+
+    std::vector<unsigned char> scaled;
+    const unsigned char* source = pixels;
+    if (width && (width != sourceWidth || height != sourceHeight))
+    {
+        scaled.resize((size_t)width * height * 4);
+        TextureLoader::Resample(pixels, sourceWidth, sourceHeight, scaled.data(), width, height);
+        source = scaled.data();
+    }
+    else
+    {
+        width = sourceWidth;
+        height = sourceHeight;
+    }
+
+    bool alpha = forceAlpha;
+    for (size_t i = 3; i < (size_t)width * height * 4 && !alpha; i += 4)
+        alpha = source[i] < 255;
+
+    Compress(source, width, height, alpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT, image);
+    stbi_image_free(pixels);
+    Store(cachePath, key, image);
+    s_Stats.converted++;
+    return true;
+}
+
+bool TextureCache::Load(const std::string& cachePath, uint64_t key, CompressedImage& image)
+{
+    std::error_code error;
+    if (!std::filesystem::exists(cachePath, error))
+        return false;
+
+    auto file = std::make_unique<MappedFile>(cachePath);
+    if (!file->IsOpen())
+        return false;
+
+    const CacheHeader* header = (const CacheHeader*)file->GetData();
+    bool valid = file->GetSize() >= sizeof(CacheHeader) && header->magic == CACHE_MAGIC &&
+        header->version == CACHE_VERSION && header->key == key && header->levels > 0 && header->levels <= 32 &&
+        (header->format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || header->format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+    const uint64_t dataOffset = sizeof(CacheHeader) + (valid ? header->levels * sizeof(CacheLevel) : 0);
+    valid = valid && file->GetSize() >= dataOffset;
+
+    std::vector<CompressedImage::Level> levels;
+    for (uint32_t i = 0; valid && i < header->levels; i++)
+    {
+        const CacheLevel& level = ((const CacheLevel*)(header + 1))[i];
+        valid = level.size == LevelSize(header->format, level.width, level.height) &&
+            dataOffset + level.offset + level.size <= file->GetSize();
+        levels.push_back({(int)level.width, (int)level.height, level.offset, level.size});
+    }
+    if (!valid)
+    {
+        s_Stats.rejected++;
+        file.reset();
+        std::filesystem::remove(cachePath, error);
+        return false;
+    }
+
+    // Touch every page here on the worker, so the upload on the GL thread never waits on the disk
+    volatile unsigned char touch = 0;
+    for (size_t offset = 0; offset < file->GetSize(); offset += 4096)
+        touch += file->GetData()[offset];
+
+    image.format = header->format;
+    image.levels = std::move(levels);
+    image.data.clear();
+    image.dataOffset = dataOffset;
+    image.file = std::move(file);
+    return true;
+}
+
+// Written under a temporary name and renamed, a reader never maps a half written file
+void TextureCache::Store(const std::string& cachePath, uint64_t key, const CompressedImage& image)
+{
+    const std::string temporary = cachePath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        CacheHeader header = {CACHE_MAGIC, CACHE_VERSION, key, image.format, (uint32_t)image.levels.size()};
+        file.write((const char*)&header, sizeof(header));
+        for (const CompressedImage::Level& level : image.levels)
+        {
+            CacheLevel entry = {(uint32_t)level.width, (uint32_t)level.height, level.offset, level.size};
+            file.write((const char*)&entry, sizeof(entry));
+        }
+        file.write((const char*)image.GetData(), image.GetSize());
+        if (!file)
+        {
+            std::cout << "Texture cache: can't write " << temporary << std::endl;
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, cachePath, error);
+    if (error)
+        std::filesystem::remove(temporary, error);
+}
+
+int TextureCache::LevelCount(int width, int height)
+{
+    int levels = 1;
+    for (int size = std::max(width, height); size > 1; size /= 2)
+        levels++;
+    return levels;
+}
+
+size_t TextureCache::LevelSize(GLenum format, int width, int height)
+{
+    const size_t blockBytes = format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 8 : 16;
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+}
+
+static uint16_t Pack565(const int color[3])
+{
+    return (uint16_t)(((color[0] * 31 + 127) / 255) << 11 | ((color[1] * 63 + 127) / 255) << 5 | ((color[2] * 31 + 127) / 255));
+}
+
+static void Unpack565(uint16_t packed, int color[3])
+{
+    const int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+// Endpoints from the bounding box, inset a little since the extremes are rarely worth a
+// palette entry, along the diagonal that matches the texels' correlation. Always the four
+// color mode, BC3 only has that one and BC1 is only used for opaque images
+static void EncodeColorBlock(const unsigned char texels[64], unsigned char* out)
+{
+    int low[3] = {255, 255, 255}, high[3] = {0, 0, 0};
+    for (int i = 0; i < 16; i++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            low[c] = std::min(low[c], (int)texels[i * 4 + c]);
+            high[c] = std::max(high[c], (int)texels[i * 4 + c]);
+        }
+    }
+
+    int axis = 0;
+    for (int c = 1; c < 3; c++)
+        if (high[c] - low[c] > high[axis] - low[axis])
+            axis = c;
+    for (int c = 0; c < 3; c++)
+    {
+        if (c == axis)
+            continue;
+        int covariance = 0;
+        for (int i = 0; i < 16; i++)
+            covariance += (texels[i * 4 + axis] * 2 - low[axis] - high[axis]) * (texels[i * 4 + c] * 2 - low[c] - high[c]);
+        if (covariance < 0)
+            std::swap(low[c], high[c]);
+    }
+    for (int c = 0; c < 3; c++)
+    {
+        const int inset = (high[c] - low[c]) / 16;
+        high[c] -= inset;
+        low[c] += inset;
+    }
+
+    uint16_t color0 = Pack565(high), color1 = Pack565(low);
+    if (color0 < color1)
+        std::swap(color0, color1);
+
+    int palette[4][3];
+    Unpack565(color0, palette[0]);
+    Unpack565(color1, palette[1]);
+    for (int c = 0; c < 3; c++)
+    {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    uint32_t indices = 0;
+    if (color0 != color1)
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            int best = 0, bestDistance = 0x7FFFFFFF;
+            for (int p = 0; p < 4; p++)
+            {
+                int distance = 0;
+                for (int c = 0; c < 3; c++)
+                {
+                    const int d = texels[i * 4 + c] - palette[p][c];
+                    distance += d * d;
+                }
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            indices |= (uint32_t)best << (i * 2);
+        }
+    }
+
+    out[0] = color0 & 0xFF;
+    out[1] = color0 >> 8;
+    out[2] = color1 & 0xFF;
+    out[3] = color1 >> 8;
+    for (int i = 0; i < 4; i++)
+        out[4 + i] = (indices >> (i * 8)) & 0xFF;
+}
+
+// Min and max as endpoints, eight interpolated steps between them
+static void EncodeAlphaBlock(const unsigned char texels[64], unsigned char* out)
+{
+    int low = 255, high = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        low = std::min(low, (int)texels[i * 4 + 3]);
+        high = std::max(high, (int)texels[i * 4 + 3]);
+    }
+
+    int palette[8] = {high, low};
+    for (int p = 1; p < 7; p++)
+        palette[p + 1] = ((7 - p) * high + p * low) / 7;
+
+    uint64_t indices = 0;
+    if (high != low)
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            int best = 0;
+            for (int p = 1; p < 8; p++)
+                if (std::abs(texels[i * 4 + 3] - palette[p]) < std::abs(texels[i * 4 + 3] - palette[best]))
+                    best = p;
+            indices |= (uint64_t)best << (i * 3);
+        }
+    }
+
+    out[0] = (unsigned char)high;
+    out[1] = (unsigned char)low;
+    for (int i = 0; i < 6; i++)
+        out[2 + i] = (indices >> (i * 8)) & 0xFF;
+}
+
+void TextureCache::Compress(const unsigned char* pixels, int width, int height, GLenum format, CompressedImage& image)
+{
+    const bool alpha = format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    const size_t blockBytes = alpha ? 16 : 8;
+
+    image.format = format;
+    image.levels.clear();
+    image.file.reset();
+    image.dataOffset = 0;
+    size_t total = 0;
+    for (int level = 0, w = width, h = height; level < LevelCount(width, height); level++, w = std::max(1, w / 2), h = std::max(1, h / 2))
+    {
+        image.levels.push_back({w, h, total, LevelSize(format, w, h)});
+        total += image.levels.back().size;
+    }
+    image.data.resize(total);
+
+    std::vector<unsigned char> mip, next;
+    const unsigned char* source = pixels;
+    for (size_t i = 0; i < image.levels.size(); i++)
+    {
+        const CompressedImage::Level& level = image.levels[i];
+        if (i > 0)
+        {
+            // Each level from the one above, the box filter halves it
+            const CompressedImage::Level& above = image.levels[i - 1];
+            next.resize((size_t)level.width * level.height * 4);
+            TextureLoader::Resample(source, above.width, above.height, next.data(), level.width, level.height);
+            mip.swap(next);
+            source = mip.data();
+        }
+
+        unsigned char* out = image.data.data() + level.offset;
+        unsigned char texels[64];
+        for (int by = 0; by < level.height; by += 4)
+        {
+            for (int bx = 0; bx < level.width; bx += 4)
+            {
+                // Blocks past the edge repeat the last row and column
+                for (int y = 0; y < 4; y++)
+                {
+                    const int sy = std::min(by + y, level.height - 1);
+                    for (int x = 0; x < 4; x++)
+                    {
+                        const int sx = std::min(bx + x, level.width - 1);
+                        std::copy_n(source + ((size_t)sy * level.width + sx) * 4, 4, texels + (y * 4 + x) * 4);
+                    }
+                }
+                if (alpha)
+                {
+                    EncodeAlphaBlock(texels, out);
+                    EncodeColorBlock(texels, out + 8);
+                }
+                else
+                {
+                    EncodeColorBlock(texels, out);
+                }
+                out += blockBytes;
+            }
+        }
+    }
+}
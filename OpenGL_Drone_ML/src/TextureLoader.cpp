@@ -0,0 +1,377 @@
+#include "TextureLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "GLState.h"
+#include "Texture.h"
+#include "TextureArray.h"
+#include "stb_image/stb_image.h"
+
+std::vector<std::thread> TextureLoader::s_Workers;
+std::mutex TextureLoader::s_Mutex;
+std::condition_variable TextureLoader::s_Wake;
+std::deque<std::shared_ptr<TextureLoader::Job>> TextureLoader::s_Queue;
+std::vector<std::shared_ptr<TextureLoader::Job>> TextureLoader::s_Decoded;
+bool TextureLoader::s_Stop = false;
+std::deque<std::shared_ptr<TextureLoader::Job>> TextureLoader::s_Uploads;
+std::atomic<unsigned int> TextureLoader::s_Pending{0};
+unsigned int TextureLoader::s_PixelBuffer = 0;
+
+std::shared_ptr<TextureLoader::Job> TextureLoader::Load(const std::string& path, Texture* texture)
+{
+    auto job = std::make_shared<Job>();
+    job->path = path;
+    job->texture = texture;
+    job->rendererID = texture->m_RendererID;
+    job->compress = TextureCache::IsSupported();
+    return Queue(job);
+}
+
+std::shared_ptr<TextureLoader::Job> TextureLoader::Load(const std::string& path, TextureArray* array, int layer)
+{
+    auto job = std::make_shared<Job>();
+    job->path = path;
+    job->array = array;
+    job->layer = layer;
+    job->targetWidth = array->GetWidth();
+    job->targetHeight = array->GetHeight();
+    job->compress = array->IsCompressed();
+    job->forceAlpha = true; // the array is BC3 throughout
+    return Queue(job);
+}
+
+std::shared_ptr<TextureLoader::Job> TextureLoader::Queue(std::shared_ptr<Job> job)
+{
+    if (s_Workers.empty())
+        StartWorkers();
+
+    s_Pending++;
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        s_Queue.push_back(job);
+    }
+    s_Wake.notify_one();
+    return job;
+}
+
+void TextureLoader::StartWorkers()
+{
+    // Leave a core for the main thread, decoding a few PNGs does not need more than four
+    const unsigned int cores = std::thread::hardware_concurrency();
+    const unsigned int count = cores > 2 ? std::min(cores - 1, 4u) : 1u;
+    s_Stop = false;
+    for (unsigned int i = 0; i < count; i++)
+        s_Workers.emplace_back(WorkerMain);
+}
+
+void TextureLoader::WorkerMain()
+{
+    stbi_set_flip_vertically_on_load_thread(1); // GL wants the bottom row first
+    while (true)
+    {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(s_Mutex);
+            s_Wake.wait(lock, [] { return s_Stop || !s_Queue.empty(); });
+            if (s_Stop)
+                return;
+            job = s_Queue.front();
+            s_Queue.pop_front();
+        }
+
+        int channels = 0;
+        if (job->compress)
+        {
+            if (TextureCache::Get(job->path, job->targetWidth, job->targetHeight, job->forceAlpha, job->image, &job->failure))
+            {
+                job->width = job->image.levels[0].width;
+                job->height = job->image.levels[0].height;
+            }
+        }
+        else if (!(job->pixels = stbi_load(job->path.c_str(), &job->width, &job->height, &channels, 4)))
+            job->failure = stbi_failure_reason();
+        else if (job->targetWidth && (job->width != job->targetWidth || job->height != job->targetHeight))
+        {
+            job->scaled.resize((size_t)job->targetWidth * job->targetHeight * 4);
+            Resample(job->pixels, job->width, job->height, job->scaled.data(), job->targetWidth, job->targetHeight);
+            stbi_image_free(job->pixels);
+            job->pixels = job->scaled.data();
+            job->width = job->targetWidth;
+            job->height = job->targetHeight;
+        }
+
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        s_Decoded.push_back(job);
+    }
+}
+
+static const unsigned char s_Grey[4] = {128, 128, 128, 255};
+
+unsigned int TextureLoader::CreateTexture()
+{
+    unsigned int rendererID;
+    GLCall(glGenTextures(1, &rendererID));
+    GLState::BindTexture(GL_TEXTURE_2D, rendererID);
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE)); // s is x coord
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE)); // t is y coord
+    if (GLEW_EXT_texture_filter_anisotropic)
+    {
+        GLfloat maxAnisotropy = 1.0f;
+        GLCall(glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy));
+        GLCall(glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min(maxAnisotropy, 8.0f)));
+    }
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
+    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, s_Grey));
+    return rendererID;
+}
+
+// The grey texel moves to the 1x1 end of the chain and sampling is limited to it, so the
+// levels above can be filled over several frames without the texture ever being incomplete
+static void BeginLoading(unsigned int rendererID, int width, int height)
+{
+    const int top = TextureCache::LevelCount(width, height) - 1;
+    GLState::BindTexture(GL_TEXTURE_2D, rendererID);
+    GLCall(glTexImage2D(GL_TEXTURE_2D, top, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, s_Grey));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, top));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, top));
+}
+
+// Samples levels 0 to last from now on
+static void EndLoading(unsigned int rendererID, int last)
+{
+    GLState::BindTexture(GL_TEXTURE_2D, rendererID);
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, last));
+}
+
+void TextureLoader::Update()
+{
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        for (auto& job : s_Decoded)
+            s_Uploads.push_back(std::move(job));
+        s_Decoded.clear();
+    }
+
+    size_t budget = UPLOAD_BUDGET;
+    while (!s_Uploads.empty() && budget > 0)
+    {
+        Job& job = *s_Uploads.front();
+        const bool owned = job.texture || job.array;
+        const bool decoded = IsDecoded(job);
+        if (owned && !decoded)
+            std::cout << "Failed to load texture " << job.path << ": " << job.failure << std::endl;
+        if (owned && decoded)
+        {
+            if (job.compress)
+            {
+                budget -= std::min(budget, UploadCompressed(job, budget));
+                if (job.uploadedLevels < (int)job.image.levels.size())
+                    break;
+            }
+            else
+            {
+                budget -= std::min(budget, Upload(job, budget));
+                if (job.uploadedRows < job.height)
+                    break; // the rest goes up next frame
+            }
+        }
+        if (job.texture && decoded)
+            job.texture->OnLoaded(job.width, job.height);
+        if (job.array)
+            job.array->OnLayerLoaded(job.layer);
+        Release(job);
+        s_Uploads.pop_front();
+        s_Pending--;
+    }
+}
+
+// Copies size bytes into the unpack buffer, orphaned each time so the copy never waits on the
+// GPU reading the previous batch, and leaves it bound. Returns what to pass as the upload's
+// pixels: null for the start of the unpack buffer, or source itself if mapping failed
+const void* TextureLoader::Stage(const unsigned char* source, size_t size)
+{
+    if (!s_PixelBuffer)
+    {
+        GLCall(glGenBuffers(1, &s_PixelBuffer));
+    }
+    GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, s_PixelBuffer);
+    GLCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW));
+    GLCall(void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (!mapped)
+    {
+        // Mapping failed, fall back to a client memory upload
+        GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return source;
+    }
+    std::memcpy(mapped, source, size);
+    GLCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+    return nullptr;
+}
+
+// Rows through the unpack buffer, at least one row goes up however small the budget
+size_t TextureLoader::Upload(Job& job, size_t budget)
+{
+    if (!job.array && job.uploadedRows == 0)
+    {
+        BeginLoading(job.rendererID, job.width, job.height);
+        GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, job.width, job.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+    }
+
+    const size_t rowBytes = (size_t)job.width * 4;
+    const int rows = std::max(1, std::min(job.height - job.uploadedRows, (int)(budget / rowBytes)));
+    const size_t size = rowBytes * rows;
+
+    const void* source = Stage(job.pixels + rowBytes * job.uploadedRows, size);
+    if (job.array)
+    {
+        GLState::BindTexture(GL_TEXTURE_2D_ARRAY, job.array->GetRendererID());
+        GLCall(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, job.uploadedRows, job.layer, job.width, rows, 1,
+            GL_RGBA, GL_UNSIGNED_BYTE, source));
+    }
+    else
+    {
+        GLState::BindTexture(GL_TEXTURE_2D, job.rendererID);
+        GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, job.uploadedRows, job.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, source));
+    }
+    // With an unpack buffer bound every other texture upload would read from it
+    GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    job.uploadedRows += rows;
+    if (!job.array && job.uploadedRows == job.height)
+    {
+        EndLoading(job.rendererID, TextureCache::LevelCount(job.width, job.height) - 1);
+        GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+    }
+    return size;
+}
+
+// Whole mip levels, the mips come with the image. At least one level goes up a frame, even
+// the top level of a 4096 texture is only 16 MB as BC3
+size_t TextureLoader::UploadCompressed(Job& job, size_t budget)
+{
+    const int levels = (int)job.image.levels.size();
+    if (!job.array && job.uploadedLevels == 0)
+        BeginLoading(job.rendererID, job.width, job.height);
+
+    size_t uploaded = 0;
+    do
+    {
+        const CompressedImage::Level& level = job.image.levels[job.uploadedLevels];
+        const void* source = Stage(job.image.GetData() + level.offset, level.size);
+        if (job.array)
+        {
+            GLState::BindTexture(GL_TEXTURE_2D_ARRAY, job.array->GetRendererID());
+            GLCall(glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, job.uploadedLevels, 0, 0, job.layer, level.width, level.height, 1,
+                job.image.format, (GLsizei)level.size, source));
+        }
+        else
+        {
+            GLState::BindTexture(GL_TEXTURE_2D, job.rendererID);
+            GLCall(glCompressedTexImage2D(GL_TEXTURE_2D, job.uploadedLevels, job.image.format, level.width, level.height, 0,
+                (GLsizei)level.size, source));
+        }
+        GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        uploaded += level.size;
+        job.uploadedLevels++;
+    } while (job.uploadedLevels < levels && uploaded + job.image.levels[job.uploadedLevels].size <= budget);
+
+    if (!job.array && job.uploadedLevels == levels)
+        EndLoading(job.rendererID, levels - 1);
+    return uploaded;
+}
+
+void TextureLoader::Release(Job& job)
+{
+    if (job.pixels && job.scaled.empty())
+        stbi_image_free(job.pixels);
+    job.pixels = nullptr;
+    job.scaled = std::vector<unsigned char>();
+    job.image = CompressedImage(); // unmaps a cache file
+    job.rendererID = 0; // the texture's, which deletes it
+}
+
+void TextureLoader::Resample(const unsigned char* source, int sourceWidth, int sourceHeight,
+    unsigned char* destination, int width, int height)
+{
+    const float scaleX = (float)sourceWidth / width, scaleY = (float)sourceHeight / height;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            if (scaleX > 1.0f || scaleY > 1.0f)
+            {
+                // Box filter over the source texels this one covers
+                const int x0 = (int)(x * scaleX), x1 = std::max(x0 + 1, std::min(sourceWidth, (int)((x + 1) * scaleX)));
+                const int y0 = (int)(y * scaleY), y1 = std::max(y0 + 1, std::min(sourceHeight, (int)((y + 1) * scaleY)));
+                for (int sy = y0; sy < y1; sy++)
+                    for (int sx = x0; sx < x1; sx++)
+                        for (int c = 0; c < 4; c++)
+                            sum[c] += source[((size_t)sy * sourceWidth + sx) * 4 + c];
+                const float count = (float)((x1 - x0) * (y1 - y0));
+                for (int c = 0; c < 4; c++)
+                    sum[c] /= count;
+            }
+            else
+            {
+                const float u = std::max(0.0f, (x + 0.5f) * scaleX - 0.5f), v = std::max(0.0f, (y + 0.5f) * scaleY - 0.5f);
+                const int x0 = std::min((int)u, sourceWidth - 1), y0 = std::min((int)v, sourceHeight - 1);
+                const int x1 = std::min(x0 + 1, sourceWidth - 1), y1 = std::min(y0 + 1, sourceHeight - 1);
+                const float fx = u - x0, fy = v - y0;
+                for (int c = 0; c < 4; c++)
+                {
+                    const float top = source[((size_t)y0 * sourceWidth + x0) * 4 + c] * (1.0f - fx) + source[((size_t)y0 * sourceWidth + x1) * 4 + c] * fx;
+                    const float bottom = source[((size_t)y1 * sourceWidth + x0) * 4 + c] * (1.0f - fx) + source[((size_t)y1 * sourceWidth + x1) * 4 + c] * fx;
+                    sum[c] = top * (1.0f - fy) + bottom * fy;
+                }
+            }
+            for (int c = 0; c < 4; c++)
+                destination[((size_t)y * width + x) * 4 + c] = (unsigned char)std::min(255.0f, sum[c] + 0.5f);
+        }
+    }
+}
+
+void TextureLoader::Finish()
+{
+    while (s_Pending > 0)
+    {
+        Update();
+        if (s_Pending > 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void TextureLoader::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        s_Stop = true;
+    }
+    s_Wake.notify_all();
+    for (std::thread& worker : s_Workers)
+        worker.join();
+    s_Workers.clear();
+
+    // Workers are gone, nothing else touches the queues now
+    s_Queue.clear();
+    for (auto& job : s_Decoded)
+        s_Uploads.push_back(std::move(job));
+    s_Decoded.clear();
+    for (auto& job : s_Uploads)
+        Release(*job);
+    s_Uploads.clear();
+    s_Pending = 0;
+
+    if (s_PixelBuffer)
+    {
+        GLState::OnDeleteBuffer(s_PixelBuffer);
+        GLCall(glDeleteBuffers(1, &s_PixelBuffer));
+        s_PixelBuffer = 0;
+    }
+}
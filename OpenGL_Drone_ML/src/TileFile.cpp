@@ -0,0 +1,130 @@
+#include "TileFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static const std::uint32_t TILE_FILE_VERSION = 2; // 2 added the source key
+
+static std::uint64_t AlignUp(std::uint64_t value)
+{
+    return (value + 15) & ~(std::uint64_t)15;
+}
+
+TileFile::TileFile(const std::string& path)
+    : m_File(std::make_unique<MappedFile>(path)), m_Header(nullptr), m_Records(nullptr)
+{
+    if (!m_File->IsOpen() || m_File->GetSize() < sizeof(TileFileHeader))
+        return;
+
+    const TileFileHeader* header = reinterpret_cast<const TileFileHeader*>(m_File->GetData());
+    if (std::memcmp(header->magic, "DTIL", 4) != 0 || header->version != TILE_FILE_VERSION)
+    {
+        std::cout << "TileFile: " << path << " is not a version " << TILE_FILE_VERSION << " tile file" << std::endl;
+        return;
+    }
+    if (sizeof(TileFileHeader) + (std::uint64_t)header->tileCount * sizeof(TileRecord) > m_File->GetSize())
+    {
+        std::cout << "TileFile: " << path << " is truncated" << std::endl;
+        return;
+    }
+
+    m_Header = header;
+    m_Records = reinterpret_cast<const TileRecord*>(m_File->GetData() + sizeof(TileFileHeader));
+    for (unsigned int i = 0; i < m_Header->tileCount; i++)
+        m_Lookup[PackCoords(m_Records[i].gridX, m_Records[i].gridZ)] = i;
+}
+
+bool TileFile::HasTile(int gridX, int gridZ) const
+{
+    return m_Lookup.find(PackCoords(gridX, gridZ)) != m_Lookup.end();
+}
+
+bool TileFile::LoadTile(int gridX, int gridZ, TerrainTile& out) const
+{
+    auto it = m_Lookup.find(PackCoords(gridX, gridZ));
+    if (it == m_Lookup.end())
+        return false;
+
+    const TileRecord& record = m_Records[it->second];
+    const std::uint64_t vertexBytes = (std::uint64_t)record.vertexCount * m_Header->stride;
+    const std::uint64_t indexBytes = (std::uint64_t)record.indexCount * sizeof(unsigned int);
+    if (record.vertexOffset + vertexBytes > m_File->GetSize() || record.indexOffset + indexBytes > m_File->GetSize())
+        return false;
+
+    // Copying out of the mapping is what actually pages the tile in from disk
+    const unsigned char* data = m_File->GetData();
+    out.gridX = record.gridX;
+    out.gridZ = record.gridZ;
+    out.bounds.min = glm::vec3(record.boundsMin[0], record.boundsMin[1], record.boundsMin[2]);
+    out.bounds.max = glm::vec3(record.boundsMax[0], record.boundsMax[1], record.boundsMax[2]);
+    out.vertices.assign(data + record.vertexOffset, data + record.vertexOffset + vertexBytes);
+    out.indices.resize(record.indexCount);
+    std::memcpy(out.indices.data(), data + record.indexOffset, indexBytes);
+    return true;
+}
+
+bool TileFile::Bake(const std::string& path, const void* vertices, unsigned int vertexCount, unsigned int stride,
+    const std::vector<unsigned int>& indices, float tileSize, std::uint64_t sourceKey)
+{
+    return Write(path, ChunkedMesh::Partition(vertices, vertexCount, stride, indices, tileSize), stride, tileSize, sourceKey);
+}
+
+bool TileFile::Write(const std::string& path, const std::vector<MeshChunk>& chunks, unsigned int stride, float tileSize,
+    std::uint64_t sourceKey)
+{
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream)
+    {
+        std::cout << "TileFile: could not write " << path << std::endl;
+        return false;
+    }
+
+    TileFileHeader header = {};
+    std::memcpy(header.magic, "DTIL", 4);
+    header.version = TILE_FILE_VERSION;
+    header.stride = stride;
+    header.tileCount = chunks.size();
+    header.tileSize = tileSize;
+    header.sourceKey = sourceKey;
+
+    // Lay out the data blocks after the directory
+    std::vector<TileRecord> records(chunks.size());
+    std::uint64_t offset = AlignUp(sizeof(TileFileHeader) + chunks.size() * sizeof(TileRecord));
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        const MeshChunk& chunk = chunks[i];
+        TileRecord& record = records[i];
+        record.gridX = chunk.gridX;
+        record.gridZ = chunk.gridZ;
+        for (int k = 0; k < 3; k++)
+        {
+            record.boundsMin[k] = chunk.bounds.min[k];
+            record.boundsMax[k] = chunk.bounds.max[k];
+        }
+        record.vertexCount = chunk.vertices.size() / stride;
+        record.indexCount = chunk.indices.size();
+        record.vertexOffset = offset;
+        offset = AlignUp(offset + chunk.vertices.size());
+        record.indexOffset = offset;
+        offset = AlignUp(offset + chunk.indices.size() * sizeof(unsigned int));
+
+        header.maxVertexCount = std::max(header.maxVertexCount, record.vertexCount);
+        header.maxIndexCount = std::max(header.maxIndexCount, record.indexCount);
+    }
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(TileRecord));
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        stream.seekp(records[i].vertexOffset);
+        stream.write(reinterpret_cast<const char*>(chunks[i].vertices.data()), chunks[i].vertices.size());
+        stream.seekp(records[i].indexOffset);
+        stream.write(reinterpret_cast<const char*>(chunks[i].indices.data()), chunks[i].indices.size() * sizeof(unsigned int));
+    }
+    // pad the tail so the last block is fully inside the file
+    stream.seekp(offset - 1);
+    stream.put(0);
+    return (bool)stream;
+}
@@ -0,0 +1,51 @@
+#include "UniformBuffer.h"
+#include "GLState.h"
+
+UniformBuffer::UniformBuffer(unsigned int size)
+    : m_RendererID(0), m_Size(size)
+{
+    GLCall(glGenBuffers(1, &m_RendererID));
+    GLState::BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+    GLCall(glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    GLState::OnDeleteBuffer(m_RendererID);
+    GLCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+void UniformBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+    GLState::BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+    GLCall(glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data));
+}
+
+void UniformBuffer::Resize(unsigned int size)
+{
+    m_Size = size;
+    GLState::BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+    GLCall(glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
+}
+
+void UniformBuffer::BindBase(unsigned int binding) const
+{
+    GLState::BindBufferRange(GL_UNIFORM_BUFFER, binding, m_RendererID, 0, m_Size);
+}
+
+void UniformBuffer::BindRange(unsigned int binding, unsigned int offset, unsigned int size) const
+{
+    GLState::BindBufferRange(GL_UNIFORM_BUFFER, binding, m_RendererID, offset, size);
+}
+
+unsigned int UniformBuffer::GetOffsetAlignment()
+{
+    static GLint alignment = 0;
+    if (alignment == 0)
+    {
+        GLCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+        if (alignment <= 0)
+            alignment = 256;
+    }
+    return (unsigned int)alignment;
+}
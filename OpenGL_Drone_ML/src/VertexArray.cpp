@@ -1,5 +1,6 @@
 #include "VertexArray.h"
-#include "GLError.h"
+#include "GLState.h"
+#include "StreamBuffer.h"
 
 VertexArray::VertexArray()
 {
@@ -8,31 +9,49 @@ VertexArray::VertexArray()
 
 VertexArray::~VertexArray()
 {
+    GLState::OnDeleteVertexArray(m_RendererID);
     GLCall(glDeleteVertexArrays(1, &m_RendererID));
 }
 
-void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
+void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int firstAttribute, unsigned int divisor)
 {
     Bind();
     vb.Bind();
+    SetAttributes(layout, firstAttribute, divisor);
+}
+
+void VertexArray::AddBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout, unsigned int firstAttribute, unsigned int divisor)
+{
+    Bind();
+    sb.Bind();
+    SetAttributes(layout, firstAttribute, divisor);
+}
+
+void VertexArray::SetAttributes(const VertexBufferLayout& layout, unsigned int firstAttribute, unsigned int divisor)
+{
     const auto& elements = layout.GetElements();
     unsigned int offset = 0;
     for (unsigned int i = 0; i < elements.size(); i++)
     {
         const auto& element = elements[i];
-        GLCall(glEnableVertexAttribArray(i)); // enables vertex so it can be drawn
-        GLCall(glVertexAttribPointer(i, element.count, element.type, 
+        const unsigned int index = firstAttribute + i;
+        GLCall(glEnableVertexAttribArray(index)); // enables vertex so it can be drawn
+        GLCall(glVertexAttribPointer(index, element.count, element.type, 
             element.normalized, layout.GetStride(), (const void*)offset));
+        if (divisor)
+        {
+            GLCall(glVertexAttribDivisor(index, divisor));
+        }
         offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
     }
 }
 
 void VertexArray::Bind() const
 {
-    GLCall(glBindVertexArray(m_RendererID));
+    GLState::BindVertexArray(m_RendererID);
 }
 
 void VertexArray::Unbind() const
 {
-    GLCall(glBindVertexArray(0));
+    GLState::BindVertexArray(0);
 }
\ No newline at end of file
@@ -1,31 +1,111 @@
 #include "VertexBuffer.h"
 #include "Renderer.h"
 
+#include <algorithm>
+
+void ReallocateBuffer(unsigned int buffer, unsigned int newSize, unsigned int keepSize, unsigned int usage)
+{
+    // The old store is parked in a scratch buffer, glBufferData on the same name keeps every
+    // VAO binding valid
+    unsigned int scratch = 0;
+    if (keepSize)
+    {
+        GLCall(glGenBuffers(1, &scratch));
+        GLState::BindBuffer(GL_COPY_WRITE_BUFFER, scratch);
+        GLCall(glBufferData(GL_COPY_WRITE_BUFFER, keepSize, nullptr, GL_STREAM_COPY));
+        GLState::BindBuffer(GL_COPY_READ_BUFFER, buffer);
+        GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keepSize));
+    }
+    GLState::BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    GLCall(glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, usage));
+    if (scratch)
+    {
+        GLState::BindBuffer(GL_COPY_READ_BUFFER, scratch);
+        GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keepSize));
+        GLState::OnDeleteBuffer(scratch);
+        GLCall(glDeleteBuffers(1, &scratch));
+    }
+}
+
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+    : m_Size(size), m_Usage(GL_STATIC_DRAW)
 {
     GLCall(glGenBuffers(1, &m_RendererID));
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+    GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
     GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
 }
 
 VertexBuffer::VertexBuffer(unsigned int size)
+    : m_Size(size), m_Usage(GL_DYNAMIC_DRAW)
 {
     GLCall(glGenBuffers(1, &m_RendererID));
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+    GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
     GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
 }
 
 VertexBuffer::~VertexBuffer()
 {
+    Release();
+}
+
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_Size(other.m_Size), m_Usage(other.m_Usage)
+{
+    other.m_RendererID = 0;
+    other.m_Size = 0;
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        m_RendererID = other.m_RendererID;
+        m_Size = other.m_Size;
+        m_Usage = other.m_Usage;
+        other.m_RendererID = 0;
+        other.m_Size = 0;
+    }
+    return *this;
+}
+
+void VertexBuffer::Release()
+{
+    if (!m_RendererID)
+        return; // moved from
+    GLState::OnDeleteBuffer(m_RendererID);
     GLCall(glDeleteBuffers(1, &m_RendererID));
+    m_RendererID = 0;
+}
+
+void VertexBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+    if (offset + size > m_Size)
+    {
+        // Only what is in front of offset survives, the rest is about to be overwritten
+        unsigned int newSize = std::max(offset + size, m_Size * 2);
+        ReallocateBuffer(m_RendererID, newSize, std::min(offset, m_Size), m_Usage);
+        m_Size = newSize;
+    }
+    GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+    GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data));
+}
+
+void VertexBuffer::Reserve(unsigned int size)
+{
+    if (size <= m_Size)
+        return;
+    unsigned int newSize = std::max(size, m_Size * 2);
+    ReallocateBuffer(m_RendererID, newSize, m_Size, m_Usage);
+    m_Size = newSize;
 }
 
 void VertexBuffer::Bind() const
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+    GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
 }
 
 void VertexBuffer::Unbind() const
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
-}
\ No newline at end of file
+    GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -1,6 +1,12 @@
 #include "Test.h"
 #include "imgui.h"
 
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
 namespace test {
 
     void PushQuad(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices,
@@ -59,17 +65,153 @@ namespace test {
         PushQuad(vertices, indices, x, y+h, z, w, 0.0f, d, color, texSlot, terrain);
     }
 
+    void RemapUVs(std::vector<Vertex>& vertices, size_t first, const glm::vec4& rect)
+    {
+        for (size_t i = first; i < vertices.size(); i++)
+        {
+            vertices[i].u = rect.x + vertices[i].u * rect.z;
+            vertices[i].v = rect.y + vertices[i].v * rect.w;
+        }
+    }
+
+    bool LoadModel(
+        const std::string &path, std::vector<Vertex> &outVertices,
+        std::vector<unsigned int> &outIndices, float rotation, const glm::vec3 &position,
+        const glm::vec3 &scale, std::vector<Triangle> *terrain)
+    {
+        Assimp::Importer importer;
+
+        const aiScene *scene = importer.ReadFile(
+            path,
+            aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals);
+
+        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+        {
+            std::cerr << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
+            return false;
+        }
+
+        auto ProcessMesh = [&](aiMesh *mesh)
+        {
+            unsigned int baseIndex = outVertices.size();
+
+            // Set rotation
+            glm::mat4 rotMat = glm::rotate(glm::mat4(1.0f), glm::radians(rotation), glm::vec3(0.0f, 1.0f, 0.0f));
+
+            for (unsigned int i = 0; i < mesh->mNumVertices; ++i)
+            {
+                glm::vec3 pos(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+
+                // Apply rotation
+                glm::vec4 rotatedPos = rotMat * glm::vec4(pos, 1.0f);
+
+                Vertex vertex;
+
+                // Apply scale and translation
+                vertex.x = rotatedPos.x * scale.x + position.x;
+                vertex.y = rotatedPos.y * scale.y + position.y;
+                vertex.z = rotatedPos.z * scale.z + position.z;
+
+                if (mesh->HasNormals())
+                {
+                    glm::vec3 normal(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+                    glm::vec3 rotatedNormal = glm::mat3(rotMat) * normal; // rotation only
+                    vertex.r = (rotatedNormal.x + 1.0f) * 0.5f;
+                    vertex.g = (rotatedNormal.y + 1.0f) * 0.5f;
+                    vertex.b = (rotatedNormal.z + 1.0f) * 0.5f;
+                }
+                else
+                {
+                    vertex.r = vertex.g = vertex.b = 1.0f;
+                }
+
+                if (mesh->mTextureCoords[0])
+                {
+                    vertex.u = mesh->mTextureCoords[0][i].x;
+                    vertex.v = mesh->mTextureCoords[0][i].y;
+                }
+                else
+                {
+                    vertex.u = vertex.v = 0.0f;
+                }
+
+                vertex.texSlot = -1.0f;
+                outVertices.push_back(vertex);
+            }
+
+            for (unsigned int i = 0; i < mesh->mNumFaces; ++i)
+            {
+                aiFace face = mesh->mFaces[i];
+                if (face.mNumIndices != 3)
+                    continue; // skip non-triangular faces
+
+                unsigned int i0 = face.mIndices[0] + baseIndex;
+                unsigned int i1 = face.mIndices[1] + baseIndex;
+                unsigned int i2 = face.mIndices[2] + baseIndex;
+
+                outIndices.push_back(i0);
+                outIndices.push_back(i1);
+                outIndices.push_back(i2);
+
+                if (terrain)
+                {
+                    const Vertex &v0 = outVertices[i0];
+                    const Vertex &v1 = outVertices[i1];
+                    const Vertex &v2 = outVertices[i2];
+                    terrain->push_back({glm::vec3(v0.x, v0.y, v0.z),
+                                        glm::vec3(v1.x, v1.y, v1.z),
+                                        glm::vec3(v2.x, v2.y, v2.z)});
+                }
+            }
+        };
+
+        std::function<void(aiNode *)> ProcessNode = [&](aiNode *node)
+        {
+            for (unsigned int i = 0; i < node->mNumMeshes; ++i)
+                ProcessMesh(scene->mMeshes[node->mMeshes[i]]);
+            for (unsigned int i = 0; i < node->mNumChildren; ++i)
+                ProcessNode(node->mChildren[i]);
+        };
+
+        ProcessNode(scene->mRootNode);
+        return true;
+    }
+
     TestMenu::TestMenu(Test*& currentTestPointer)
-        : m_CurrentTest(currentTestPointer)
+        : m_CurrentTest(currentTestPointer), m_Selected(-1)
     {
     }
 
     void TestMenu::OnImGuiRender()
     {
-        for (auto& test : m_Tests) 
+        for (int i = 0; i < (int)m_Tests.size(); i++)
         {
-            if (ImGui::Button(test.first.c_str()))
-                m_CurrentTest = test.second();
+            if (ImGui::Button(m_Tests[i].first.c_str()))
+                m_Selected = i;
         }
     }
+
+    void TestMenu::CreateSelected()
+    {
+        if (m_Selected < 0)
+            return;
+        m_CurrentTest = m_Tests[m_Selected].second();
+        m_Selected = -1;
+    }
+
+    Test* TestMenu::Create(const std::string& name) const
+    {
+        for (auto& test : m_Tests)
+            if (test.first == name)
+                return test.second();
+        return nullptr;
+    }
+
+    std::string TestMenu::GetNames() const
+    {
+        std::string names;
+        for (auto& test : m_Tests)
+            names += (names.empty() ? "\"" : " \"") + test.first + "\"";
+        return names;
+    }
 }
\ No newline at end of file
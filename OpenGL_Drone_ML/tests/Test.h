@@ -10,7 +10,9 @@
 #include "imgui_impl_glfw.h"
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
+#include "VertexFormat.h"
 #include "Texture.h"
+#include "TextureArray.h"
 
 namespace test {
 
@@ -24,12 +26,27 @@ namespace test {
         float r, g, b;
         float u, v;
         float texSlot;
+
+        // position, color, tex coords, texture layer (-1 for none) -> matches the attribute locations in Basic2.shader
+        using Format = VertexFormat<Attr<float, 3>, Attr<float, 3>, Attr<float, 2>, Attr<float, 1>>;
     };
+    static_assert(Vertex::Format::Matches<Vertex>(), "Vertex is not tightly packed");
+    static_assert(offsetof(Vertex, r) == Vertex::Format::Offset(1), "Vertex color offset mismatch");
+    static_assert(offsetof(Vertex, u) == Vertex::Format::Offset(2), "Vertex tex coord offset mismatch");
+    static_assert(offsetof(Vertex, texSlot) == Vertex::Format::Offset(3), "Vertex tex slot offset mismatch");
+
+    // Layer size of the scenes' material TextureArrays, images are scaled to it
+    static constexpr int MATERIAL_SIZE = 1024;
 
     void PushQuad(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices,
             float x, float y, float z, float w, float h, float d, glm::vec3 color, float texSlot, std::vector<Triangle>* terrain = nullptr);
     void PushCube(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices,
             float x, float y, float z, float w, float h, float d, glm::vec3 color, float texSlot, std::vector<Triangle>* terrain = nullptr);
+    // Moves the UVs of vertices from first on into an atlas rect (TextureAtlas::GetRect)
+    void RemapUVs(std::vector<Vertex>& vertices, size_t first, const glm::vec4& rect);
+    // Shared Assimp loader, same behaviour as the LoadModel members of the 3D tests
+    bool LoadModel(const std::string& path, std::vector<Vertex>& outVertices, std::vector<unsigned int>& outIndices,
+            float rotation, const glm::vec3& position, const glm::vec3& scale, std::vector<Triangle>* terrain = nullptr);
 
     class Test
     {
@@ -49,6 +66,16 @@ namespace test {
 
             void OnImGuiRender() override;
 
+            // A test picked in OnImGuiRender is only constructed here, its constructor sets GLFW
+            // callbacks, which belong on the main thread
+            inline bool HasSelection() const { return m_Selected >= 0; }
+            void CreateSelected();
+
+            // The registered test called name, or null if there is none
+            Test* Create(const std::string& name) const;
+            // Space separated names, for error messages
+            std::string GetNames() const;
+
             template<typename T>
             void RegisterTest(const std::string& name)
             {
@@ -84,6 +111,7 @@ namespace test {
             
         private:
             Test*& m_CurrentTest;
+            int m_Selected;
             std::vector<std::pair<std::string, std::function<Test*()>>> m_Tests;
     };
 
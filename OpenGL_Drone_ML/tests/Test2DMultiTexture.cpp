@@ -1,4 +1,6 @@
 #include "Test2DMultiTexture.h"
+#include "GPUProfiler.h"
+#include "TextureAtlas.h"
 #include "Renderer.h"
 
 #include "glm/glm.hpp"
@@ -24,19 +26,21 @@ namespace test
         glfwSetMouseButtonCallback(window, MouseButtonCallback);
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
 
-        GLCall(glEnable(GL_BLEND));
-        GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+        GLState::SetBlend(true);
+        GLState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-        // Screen Elements
+        // Screen Elements, their images packed into one atlas that becomes material layer 2
+        TextureAtlas uiAtlas(MATERIAL_SIZE);
+        uiAtlas.Add("button", "res/textures/Em_button.png", 128);
         std::vector<Vertex> positionsScreenElements;
         std::vector<unsigned int> indicesScreenElements;
         PushQuad(positionsScreenElements, indicesScreenElements, 910.0f, 490.0f, 1.0f, 50.0f, 50.0f, 0.0f, {0.0f, 0.0f, 0.0f}, 2.0f);
+        RemapUVs(positionsScreenElements, 0, uiAtlas.GetRect("button"));
 
         m_VAO_ScreenElements = std::make_unique<VertexArray>();
 
         m_VertexBuffer_ScreenElements = std::make_unique<VertexBuffer>(positionsScreenElements.data(), positionsScreenElements.size() * sizeof(Vertex));
-        VertexBufferLayout layoutScreen;
-        layoutScreen.Push<float>(3); layoutScreen.Push<float>(3); layoutScreen.Push<float>(2); layoutScreen.Push<float>(1);
+        VertexBufferLayout layoutScreen = Vertex::Format::Layout();
         m_VAO_ScreenElements->AddBuffer(*m_VertexBuffer_ScreenElements, layoutScreen);
 
         m_IndexBuffer_ScreenElements = std::make_unique<IndexBuffer>(indicesScreenElements.data(), indicesScreenElements.size());
@@ -57,20 +61,13 @@ namespace test
         m_VAO_MapElements = std::make_unique<VertexArray>();
 
         m_VertexBuffer_MapElements = std::make_unique<VertexBuffer>(positionsMapElements.data(), positionsMapElements.size() * sizeof(Vertex));
-        VertexBufferLayout layoutMap;
-        layoutMap.Push<float>(3); layoutMap.Push<float>(3); layoutMap.Push<float>(2); layoutMap.Push<float>(1);
+        VertexBufferLayout layoutMap = Vertex::Format::Layout();
         m_VAO_MapElements->AddBuffer(*m_VertexBuffer_MapElements, layoutMap);
 
         m_IndexBuffer_MapElements = std::make_unique<IndexBuffer>(indicesMapElements.data(), indicesMapElements.size());
 
         // Pickup Zones - DYNAMIC
-        m_VAO_PickupZones = std::make_unique<VertexArray>();
-        m_VertexBuffer_PickupZones = std::make_unique<VertexBuffer>(200 * sizeof(Vertex)); // up to 50 drop points reserved
-        VertexBufferLayout layoutPickupZones;
-        layoutPickupZones.Push<float>(3); layoutPickupZones.Push<float>(3); layoutPickupZones.Push<float>(2); layoutPickupZones.Push<float>(1);
-        m_VAO_PickupZones->AddBuffer(*m_VertexBuffer_PickupZones, layoutPickupZones);
-
-        m_IndexBuffer_PickupZones = std::make_unique<IndexBuffer>(300); // up to 50 drop points
+        m_PickupZones = std::make_unique<StreamingMesh>(sizeof(Vertex), Vertex::Format::Layout(), 50 * 4, 50 * 6); // 50 drop points before it grows
 
         // Drone
         std::vector<Vertex> positionsDrone;
@@ -80,25 +77,20 @@ namespace test
         m_VAO_Drone = std::make_unique<VertexArray>();
 
         m_VertexBuffer_Drone = std::make_unique<VertexBuffer>(positionsDrone.data(), positionsDrone.size() * sizeof(Vertex));
-        VertexBufferLayout layoutDrone;
-        layoutDrone.Push<float>(3); layoutDrone.Push<float>(3); layoutDrone.Push<float>(2); layoutDrone.Push<float>(1);
+        VertexBufferLayout layoutDrone = Vertex::Format::Layout();
         m_VAO_Drone->AddBuffer(*m_VertexBuffer_Drone, layoutDrone);
 
         m_IndexBuffer_Drone = std::make_unique<IndexBuffer>(indicesDrone.data(), indicesDrone.size());
 
         // Shader and Textures setup
         m_Shader = std::make_unique<Shader>("res/shaders/Basic2.shader");
-        m_Shader->Bind();
-        int samplers[8] = { 0, 1, 2, 3, 4, 5, 6, 7 }; // allow up to 8 textures
-        m_Shader->SetUniform1iv("u_Textures", 8, samplers);
-
-        m_Texture = std::make_unique<Texture>("res/textures/alien.png");
-        m_Texture2 = std::make_unique<Texture>("res/textures/casa.png");
-        m_Texture3 = std::make_unique<Texture>("res/textures/Em_button.png");
 
-        m_Texture->Bind();
-        m_Texture2->Bind(1);
-        m_Texture3->Bind(2);
+        // Materials, one layer per vertex texture index: 0 alien, 1 casa, 2 screen elements
+        m_Materials = std::make_unique<TextureArray>(MATERIAL_SIZE, MATERIAL_SIZE, 3);
+        m_Materials->Load(0, "res/textures/alien.png");
+        m_Materials->Load(1, "res/textures/casa.png");
+        m_Materials->SetLayer(2, uiAtlas.GetPixels(), uiAtlas.GetSize(), uiAtlas.GetSize());
+        m_Materials->Bind();
 
         m_ViewToUse = &m_View;
     }
@@ -129,17 +121,12 @@ namespace test
         // set dynamic vertex buffer for PickupZones pre comms with server
         if (m_MakeThread)
         {
-            std::vector<Vertex> positionsPickupZones;
-            std::vector<unsigned int> indicesPickupZones;
-            for (auto &pos : m_Targets)
+            // Only targets added since last frame are built, uploaded in OnRender
+            for (; m_PickupTargetCount < m_Targets.size(); m_PickupTargetCount++)
             {
-                PushQuad(positionsPickupZones, indicesPickupZones, pos.x, pos.y, pos.z, 10.0f, 10.0f, 0.0f, { 0.59f, 0.29f, 0.0f }, -1.0f);
+                const glm::vec3& pos = m_Targets[m_PickupTargetCount];
+                PushQuad(m_PickupVertices, m_PickupIndices, pos.x, pos.y, pos.z, 10.0f, 10.0f, 0.0f, { 0.59f, 0.29f, 0.0f }, -1.0f);
             }
-
-            m_VertexBuffer_PickupZones->Bind();
-            GLCall(glBufferSubData(GL_ARRAY_BUFFER, 0, positionsPickupZones.size() * sizeof(Vertex), positionsPickupZones.data()));
-            m_IndexBuffer_PickupZones->Bind();
-            GLCall(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indicesPickupZones.size() * sizeof(unsigned int), indicesPickupZones.data()));
         }
         else
         {
@@ -166,6 +153,8 @@ namespace test
             m_TranslationA += (m_TargetTranslation - m_TranslationA) * smoothing * deltaTime;
             std::cout << m_TargetTranslation.x << std::endl;
         }
+
+        ProcessInput();
     }
 
     void Test2DMultiTexture::OnRender()
@@ -175,33 +164,40 @@ namespace test
 
         Renderer renderer;
 
-        ProcessInput();
+        // The upload is skipped when nothing changed
+        if (m_MakeThread)
+            m_PickupZones->Update(m_PickupVertices.data(), (unsigned int)m_PickupVertices.size(),
+                m_PickupIndices.data(), (unsigned int)m_PickupIndices.size());
 
         glm::mat4 vp = m_Proj * *m_ViewToUse;
         {
             // Map Elements
+            GPUScope scope("Map");
             m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", vp);
+            m_Shader->Set(m_Shader->GetMVPUniform(), vp);
             renderer.Draw(*m_VAO_MapElements, *m_IndexBuffer_MapElements, *m_Shader);
         }
         {
             // Screen Elements
+            GPUScope scope("UI");
             m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", m_Proj);
+            m_Shader->Set(m_Shader->GetMVPUniform(), m_Proj);
             renderer.Draw(*m_VAO_ScreenElements, *m_IndexBuffer_ScreenElements, *m_Shader);
         }
         {
             // Pickup Zones
+            GPUScope scope("Pickup zones");
             m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", vp);
-            renderer.Draw(*m_VAO_PickupZones, *m_IndexBuffer_PickupZones, *m_Shader);
+            m_Shader->Set(m_Shader->GetMVPUniform(), vp);
+            m_PickupZones->Draw(renderer, *m_Shader);
         }
         {
             // Drone
+            GPUScope scope("Drone");
             glm::mat4 model = glm::translate(glm::mat4(1.0f), m_TranslationA);
             glm::mat4 mvp = vp * model; // OpenGL col major leads to this order**
             m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", mvp);
+            m_Shader->Set(m_Shader->GetMVPUniform(), mvp);
 
             renderer.Draw(*m_VAO_Drone, *m_IndexBuffer_Drone, *m_Shader);
         }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Test.h"
+#include "StreamingMesh.h"
 
 #include <memory>
 #include <thread>
@@ -38,18 +39,17 @@ namespace test
         std::unique_ptr<VertexBuffer> m_VertexBuffer_ScreenElements;
         std::unique_ptr<IndexBuffer> m_IndexBuffer_ScreenElements;
 
-        std::unique_ptr<VertexArray> m_VAO_PickupZones;
-        std::unique_ptr<VertexBuffer> m_VertexBuffer_PickupZones;
-        std::unique_ptr<IndexBuffer> m_IndexBuffer_PickupZones;
+        std::unique_ptr<StreamingMesh> m_PickupZones;
+        std::vector<Vertex> m_PickupVertices;
+        std::vector<unsigned int> m_PickupIndices;
+        size_t m_PickupTargetCount = 0; // m_Targets already in the vectors above
 
         std::unique_ptr<VertexArray> m_VAO_Drone;
         std::unique_ptr<VertexBuffer> m_VertexBuffer_Drone;
         std::unique_ptr<IndexBuffer> m_IndexBuffer_Drone;
 
         std::unique_ptr<Shader> m_Shader;
-        std::unique_ptr<Texture> m_Texture;
-        std::unique_ptr<Texture> m_Texture2;
-        std::unique_ptr<Texture> m_Texture3;
+        std::unique_ptr<TextureArray> m_Materials;
 
         // transformation data
         glm::mat4 m_Proj, m_View, m_FreeLook;
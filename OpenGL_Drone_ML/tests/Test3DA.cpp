@@ -1,4 +1,6 @@
 #include "Test3DA.h"
+#include "GPUProfiler.h"
+#include "TextureAtlas.h"
 #include "Renderer.h"
 
 #include "glm/glm.hpp"
@@ -24,83 +26,63 @@ namespace test
         glfwSetScrollCallback(window, ScrollCallback);
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
 
-        GLCall(glEnable(GL_BLEND));
-        GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
-        GLCall(glEnable(GL_DEPTH_TEST));
+        GLState::SetBlend(true);
+        GLState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        GLState::SetDepthTest(true);
 
 
-        // Screen Elements
+        // Screen Elements, their images packed into one atlas that becomes material layer 2
+        TextureAtlas uiAtlas(MATERIAL_SIZE);
+        uiAtlas.Add("button", "res/textures/Em_button.png", 128);
         std::vector<Vertex> positionsScreenElements;
         std::vector<unsigned int> indicesScreenElements;
         PushQuad(positionsScreenElements, indicesScreenElements, 910.0f, 490.0f, 1.0f, 50.0f, 50.0f, 0.0f, {0.0f, 0.0f, 0.0f}, 2.0f);
+        RemapUVs(positionsScreenElements, 0, uiAtlas.GetRect("button"));
 
         m_VAO_ScreenElements = std::make_unique<VertexArray>();
 
         m_VertexBuffer_ScreenElements = std::make_unique<VertexBuffer>(positionsScreenElements.data(), positionsScreenElements.size() * sizeof(Vertex));
-        VertexBufferLayout layoutScreen;
-        layoutScreen.Push<float>(3); layoutScreen.Push<float>(3); layoutScreen.Push<float>(2); layoutScreen.Push<float>(1);
+        VertexBufferLayout layoutScreen = Vertex::Format::Layout();
         m_VAO_ScreenElements->AddBuffer(*m_VertexBuffer_ScreenElements, layoutScreen);
 
         m_IndexBuffer_ScreenElements = std::make_unique<IndexBuffer>(indicesScreenElements.data(), indicesScreenElements.size());
 
-        // Map Elements (Houses / Ground)
-        std::vector<Vertex> positionsMapElements;
-        std::vector<unsigned int> indicesMapElements;
-        PushCube(positionsMapElements, indicesMapElements, 500.0f, 1.0f, -500.2f, 500.0f, 2.0f, 500.0f, {0.0f, 0.5f, 0.0f}, -1.0f, &m_Terrain);
+        // Map Elements (Houses / Ground) and Drone, each its own mesh in one batch
+        m_World = std::make_unique<StaticBatch>(sizeof(Vertex), Vertex::Format::Layout());
+        auto addCube = [&](float x, float y, float z, float w, float h, float d, const glm::vec3& color, float texSlot,
+            std::vector<Triangle>* terrain)
+        {
+            std::vector<Vertex> vertices;
+            std::vector<unsigned int> indices;
+            PushCube(vertices, indices, x, y, z, w, h, d, color, texSlot, terrain);
+            return m_World->AddMesh(vertices.data(), vertices.size(), indices);
+        };
+        addCube(500.0f, 1.0f, -500.2f, 500.0f, 2.0f, 500.0f, {0.0f, 0.5f, 0.0f}, -1.0f, &m_Terrain);
         for (unsigned int i = 0; i < 5; i++)
         {
-            PushCube(positionsMapElements, indicesMapElements, 50.0f, 53.0f, i*-200.0f - 50.0f, 50.0f, 50.0f, 50.0f, {0.0f, 0.0f, 0.0f}, 1.0f, &m_Terrain);
+            addCube(50.0f, 53.0f, i*-200.0f - 50.0f, 50.0f, 50.0f, 50.0f, {0.0f, 0.0f, 0.0f}, 1.0f, &m_Terrain);
         }
         for (unsigned int i = 0; i < 5; i++)
         {
-            PushCube(positionsMapElements, indicesMapElements, i*200.0f + 100.0f, 53.0f, -900.0f, 50.0f, 50.0f, 50.0f, {0.0f, 0.0f, 0.0f}, 1.0f, &m_Terrain);
+            addCube(i*200.0f + 100.0f, 53.0f, -900.0f, 50.0f, 50.0f, 50.0f, {0.0f, 0.0f, 0.0f}, 1.0f, &m_Terrain);
         }
-
-        m_VAO_MapElements = std::make_unique<VertexArray>();
-
-        m_VertexBuffer_MapElements = std::make_unique<VertexBuffer>(positionsMapElements.data(), positionsMapElements.size() * sizeof(Vertex));
-        VertexBufferLayout layoutMap;
-        layoutMap.Push<float>(3); layoutMap.Push<float>(3); layoutMap.Push<float>(2); layoutMap.Push<float>(1);
-        m_VAO_MapElements->AddBuffer(*m_VertexBuffer_MapElements, layoutMap);
-
-        m_IndexBuffer_MapElements = std::make_unique<IndexBuffer>(indicesMapElements.data(), indicesMapElements.size());
+        m_DroneMesh = addCube(0.0f, 0.0f, 0.0f, 25.0f, 25.0f, 25.0f, {0.0f, 0.0f, 0.0f}, 0.0f, nullptr);
+        m_World->Build();
 
         // Pickup Zones - DYNAMIC
-        m_VAO_PickupZones = std::make_unique<VertexArray>();
-        m_VertexBuffer_PickupZones = std::make_unique<VertexBuffer>(200 * sizeof(Vertex) * 6); // up to 50 drop points reserved
-        VertexBufferLayout layoutPickupZones;
-        layoutPickupZones.Push<float>(3); layoutPickupZones.Push<float>(3); layoutPickupZones.Push<float>(2); layoutPickupZones.Push<float>(1);
-        m_VAO_PickupZones->AddBuffer(*m_VertexBuffer_PickupZones, layoutPickupZones);
-
-        m_IndexBuffer_PickupZones = std::make_unique<IndexBuffer>(300*6); // up to 50 drop points
-
-        // Drone
-        std::vector<Vertex> positionsDrone;
-        std::vector<unsigned int> indicesDrone;
-        PushCube(positionsDrone, indicesDrone, 0.0f, 0.0f, 0.0f, 25.0f, 25.0f, 25.0f, {0.0f, 0.0f, 0.0f}, 0.0f);
-
-        m_VAO_Drone = std::make_unique<VertexArray>();
-
-        m_VertexBuffer_Drone = std::make_unique<VertexBuffer>(positionsDrone.data(), positionsDrone.size() * sizeof(Vertex));
-        VertexBufferLayout layoutDrone;
-        layoutDrone.Push<float>(3); layoutDrone.Push<float>(3); layoutDrone.Push<float>(2); layoutDrone.Push<float>(1);
-        m_VAO_Drone->AddBuffer(*m_VertexBuffer_Drone, layoutDrone);
-
-        m_IndexBuffer_Drone = std::make_unique<IndexBuffer>(indicesDrone.data(), indicesDrone.size());
+        m_PickupZones = std::make_unique<StreamingMesh>(sizeof(Vertex), Vertex::Format::Layout(), 50 * 24, 50 * 36); // 50 drop points before it grows
 
         // Shader and Textures setup
         m_Shader = std::make_unique<Shader>("res/shaders/Basic2.shader");
-        m_Shader->Bind();
-        int samplers[8] = { 0, 1, 2, 3, 4, 5, 6, 7 }; // allow up to 8 textures
-        m_Shader->SetUniform1iv("u_Textures", 8, samplers);
+        m_Uniforms = std::make_unique<FrameUniforms>();
+        m_BatchShader = std::make_unique<Shader>("res/shaders/Batched.shader");
 
-        m_Texture = std::make_unique<Texture>("res/textures/alien.png");
-        m_Texture2 = std::make_unique<Texture>("res/textures/casa.png");
-        m_Texture3 = std::make_unique<Texture>("res/textures/Em_button.png");
-
-        m_Texture->Bind();
-        m_Texture2->Bind(1);
-        m_Texture3->Bind(2);
+        // Materials, one layer per vertex texture index: 0 alien, 1 casa, 2 screen elements
+        m_Materials = std::make_unique<TextureArray>(MATERIAL_SIZE, MATERIAL_SIZE, 3);
+        m_Materials->Load(0, "res/textures/alien.png");
+        m_Materials->Load(1, "res/textures/casa.png");
+        m_Materials->SetLayer(2, uiAtlas.GetPixels(), uiAtlas.GetSize(), uiAtlas.GetSize());
+        m_Materials->Bind();
 
         m_CameraFront = m_Drone - m_CameraPos;
         m_View = glm::lookAt(m_CameraPos + m_Drone, 
@@ -113,7 +95,7 @@ namespace test
         stopThread = true;
         if (m_ServerThread.joinable())
             {m_ServerThread.join(); std::cout << "Thread destroyed!";}
-        GLCall(glDisable(GL_DEPTH_TEST));
+        GLState::SetDepthTest(false);
 
         // Reset signal when exiting test case
         nlohmann::json state;
@@ -135,17 +117,12 @@ namespace test
         // set dynamic vertex buffer for PickupZones pre comms with server
         if (m_MakeThread)
         {
-            std::vector<Vertex> positionsPickupZones;
-            std::vector<unsigned int> indicesPickupZones;
-            for (auto &pos : m_Targets)
+            // Only targets added since last frame are built, uploaded in OnRender
+            for (; m_PickupTargetCount < m_Targets.size(); m_PickupTargetCount++)
             {
-                PushCube(positionsPickupZones, indicesPickupZones, pos.x, pos.y, pos.z, 10.0f, 10.0f, 10.0f, {0.59f, 0.29f, 0.0f}, -1.0f, &m_Terrain);
+                const glm::vec3& pos = m_Targets[m_PickupTargetCount];
+                PushCube(m_PickupVertices, m_PickupIndices, pos.x, pos.y, pos.z, 10.0f, 10.0f, 10.0f, {0.59f, 0.29f, 0.0f}, -1.0f, &m_Terrain);
             }
-
-            m_VertexBuffer_PickupZones->Bind();
-            GLCall(glBufferSubData(GL_ARRAY_BUFFER, 0, positionsPickupZones.size() * sizeof(Vertex), positionsPickupZones.data()));
-            m_IndexBuffer_PickupZones->Bind();
-            GLCall(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indicesPickupZones.size() * sizeof(unsigned int), indicesPickupZones.data()));
         }
         else
         {
@@ -179,6 +156,11 @@ namespace test
 
         Renderer renderer;
 
+        // The upload is skipped when nothing changed
+        if (m_MakeThread)
+            m_PickupZones->Update(m_PickupVertices.data(), (unsigned int)m_PickupVertices.size(),
+                m_PickupIndices.data(), (unsigned int)m_PickupIndices.size());
+
         if (m_FreeLookEnabled)
         {
             m_View = glm::lookAt(m_CameraPos, 
@@ -197,31 +179,25 @@ namespace test
         glm::mat4 vp = m_Proj * m_View;
 
         {
-            // Map Elements
-            m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", vp);
-            renderer.Draw(*m_VAO_MapElements, *m_IndexBuffer_MapElements, *m_Shader);
+            // Map Elements and Drone
+            GPUScope scope("Map and drone");
+            m_Uniforms->SetCamera(m_View, m_Proj, m_FreeLookEnabled ? m_CameraPos : m_CameraPos + m_Drone);
+            m_World->SetTransform(m_DroneMesh, glm::translate(glm::mat4(1.0f), m_Drone));
+            m_World->Draw(renderer, *m_BatchShader, vp);
         }
         {
             // Screen Elements
+            GPUScope scope("UI");
             m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", m_Ortho);
+            m_Shader->Set(m_Shader->GetMVPUniform(), m_Ortho);
             renderer.Draw(*m_VAO_ScreenElements, *m_IndexBuffer_ScreenElements, *m_Shader);
         }
         {
             // Pickup Zones
+            GPUScope scope("Pickup zones");
             m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", vp);
-            renderer.Draw(*m_VAO_PickupZones, *m_IndexBuffer_PickupZones, *m_Shader);
-        }
-        {
-            // Drone
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), m_Drone);
-            glm::mat4 mvp = vp * model;
-            m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", mvp);
-
-            renderer.Draw(*m_VAO_Drone, *m_IndexBuffer_Drone, *m_Shader);
+            m_Shader->Set(m_Shader->GetMVPUniform(), vp);
+            m_PickupZones->Draw(renderer, *m_Shader);
         }
         
     }
@@ -233,6 +209,8 @@ namespace test
         ImGui::SliderFloat3("m_Drone", &m_Drone.x, 0.0f, 960.0f);
         ImGui::SliderFloat3("m_CameraPos", &m_CameraPos.x, 0.0f, 960.0f);
         ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+        ImGui::Text("Batched meshes: %u of %u drawn in one %s call", m_World->GetVisibleCount(), m_World->GetMeshCount(),
+            m_World->IsIndirect() ? "indirect" : "multi-draw");
     }
 
     void Test3DA::ServerThreadFunc() {
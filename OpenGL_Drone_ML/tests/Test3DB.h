@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Test.h"
+#include "ModelRegistry.h"
+#include "RenderQueue.h"
 
 #include <memory>
 #include <thread>
@@ -38,18 +40,21 @@ namespace test
         std::unique_ptr<VertexBuffer> m_VertexBuffer_ScreenElements;
         std::unique_ptr<IndexBuffer> m_IndexBuffer_ScreenElements;
 
-        std::unique_ptr<VertexArray> m_VAO_PickupZones;
-        std::unique_ptr<VertexBuffer> m_VertexBuffer_PickupZones;
-        std::unique_ptr<IndexBuffer> m_IndexBuffer_PickupZones;
+        // houses and pickup zones, one instanced draw per mesh
+        std::unique_ptr<ModelRegistry> m_Models;
+        unsigned int m_HouseModel, m_PickupModel;
+        size_t m_PickupTargetCount = 0; // m_Targets already added as instances
+
+        RenderQueue m_Queue;
 
         std::unique_ptr<VertexArray> m_VAO_Drone;
         std::unique_ptr<VertexBuffer> m_VertexBuffer_Drone;
         std::unique_ptr<IndexBuffer> m_IndexBuffer_Drone;
 
         std::unique_ptr<Shader> m_Shader;
-        std::unique_ptr<Texture> m_Texture;
-        std::unique_ptr<Texture> m_Texture2;
-        std::unique_ptr<Texture> m_Texture3;
+        std::shared_ptr<Shader> m_InstancedShader;
+        std::unique_ptr<FrameUniforms> m_Uniforms; // camera and per-draw blocks for every program
+        std::unique_ptr<TextureArray> m_Materials;
 
         // transformation data
         glm::mat4 m_Ortho;
@@ -1,4 +1,6 @@
 #include "Test3DC.h"
+#include "GPUProfiler.h"
+#include "TextureAtlas.h"
 #include "Renderer.h"
 
 #include "glm/glm.hpp"
@@ -29,23 +31,22 @@ namespace test
         glfwSetScrollCallback(window, ScrollCallback);
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
 
-        GLCall(glEnable(GL_BLEND));
-        GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
-        GLCall(glEnable(GL_DEPTH_TEST));
+        GLState::SetBlend(true);
+        GLState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        GLState::SetDepthTest(true);
 
-        // Screen Elements
+        // Screen Elements, their images packed into one atlas that becomes material layer 2
+        TextureAtlas uiAtlas(MATERIAL_SIZE);
+        uiAtlas.Add("button", "res/textures/Em_button.png", 128);
         std::vector<Vertex> positionsScreenElements;
         std::vector<unsigned int> indicesScreenElements;
         PushQuad(positionsScreenElements, indicesScreenElements, 910.0f, 490.0f, 1.0f, 50.0f, 50.0f, 0.0f, {0.0f, 0.0f, 0.0f}, 2.0f);
+        RemapUVs(positionsScreenElements, 0, uiAtlas.GetRect("button"));
 
         m_VAO_ScreenElements = std::make_unique<VertexArray>();
 
         m_VertexBuffer_ScreenElements = std::make_unique<VertexBuffer>(positionsScreenElements.data(), positionsScreenElements.size() * sizeof(Vertex));
-        VertexBufferLayout layoutScreen;
-        layoutScreen.Push<float>(3);
-        layoutScreen.Push<float>(3);
-        layoutScreen.Push<float>(2);
-        layoutScreen.Push<float>(1);
+        VertexBufferLayout layoutScreen = Vertex::Format::Layout();
         m_VAO_ScreenElements->AddBuffer(*m_VertexBuffer_ScreenElements, layoutScreen);
 
         m_IndexBuffer_ScreenElements = std::make_unique<IndexBuffer>(indicesScreenElements.data(), indicesScreenElements.size());
@@ -70,29 +71,18 @@ namespace test
         // Height for mountain model is 5.98482 -> *28 gives 167.574 -> set survey height to 200
         LoadModel("res/assets/terrain_model/terrain.obj", positionsMapElements, indicesMapElements, 0.0f, {1000.0f, -2.0f, -900.0f}, {280.0f, 280.0f, 280.0f}, &m_Terrain);
 
-        m_VAO_MapElements = std::make_unique<VertexArray>();
+        // Split map into 400 x 400 chunks so OnRender only submits what the camera can see
+        m_MapChunks = std::make_unique<ChunkedMesh>(positionsMapElements.data(), positionsMapElements.size(), sizeof(Vertex),
+                                                    indicesMapElements, Vertex::Format::Layout(), 400.0f);
 
-        m_VertexBuffer_MapElements = std::make_unique<VertexBuffer>(positionsMapElements.data(), positionsMapElements.size() * sizeof(Vertex));
-        VertexBufferLayout layoutMap;
-        layoutMap.Push<float>(3);
-        layoutMap.Push<float>(3);
-        layoutMap.Push<float>(2);
-        layoutMap.Push<float>(1);
-        m_VAO_MapElements->AddBuffer(*m_VertexBuffer_MapElements, layoutMap);
-
-        m_IndexBuffer_MapElements = std::make_unique<IndexBuffer>(indicesMapElements.data(), indicesMapElements.size());
-
-        // Pickup Zones - DYNAMIC
-        m_VAO_PickupZones = std::make_unique<VertexArray>();
-        m_VertexBuffer_PickupZones = std::make_unique<VertexBuffer>(200 * sizeof(Vertex) * 6); // up to 50 drop points reserved
-        VertexBufferLayout layoutPickupZones;
-        layoutPickupZones.Push<float>(3);
-        layoutPickupZones.Push<float>(3);
-        layoutPickupZones.Push<float>(2);
-        layoutPickupZones.Push<float>(1);
-        m_VAO_PickupZones->AddBuffer(*m_VertexBuffer_PickupZones, layoutPickupZones);
-
-        m_IndexBuffer_PickupZones = std::make_unique<IndexBuffer>(300 * 6); // up to 50 drop points
+        // Pickup Zones - INSTANCED unit cube, tinted per target
+        m_Models = std::make_unique<ModelRegistry>();
+        {
+            std::vector<Vertex> positionsCube;
+            std::vector<unsigned int> indicesCube;
+            PushCube(positionsCube, indicesCube, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, {1.0f, 1.0f, 1.0f}, -1.0f);
+            m_PickupModel = m_Models->AddModel("PickupCube", positionsCube.data(), positionsCube.size(), sizeof(Vertex), indicesCube, Vertex::Format::Layout());
+        }
 
         // Drone
         std::vector<Vertex> positionsDrone;
@@ -102,28 +92,24 @@ namespace test
         m_VAO_Drone = std::make_unique<VertexArray>();
 
         m_VertexBuffer_Drone = std::make_unique<VertexBuffer>(positionsDrone.data(), positionsDrone.size() * sizeof(Vertex));
-        VertexBufferLayout layoutDrone;
-        layoutDrone.Push<float>(3);
-        layoutDrone.Push<float>(3);
-        layoutDrone.Push<float>(2);
-        layoutDrone.Push<float>(1);
+        VertexBufferLayout layoutDrone = Vertex::Format::Layout();
         m_VAO_Drone->AddBuffer(*m_VertexBuffer_Drone, layoutDrone);
 
         m_IndexBuffer_Drone = std::make_unique<IndexBuffer>(indicesDrone.data(), indicesDrone.size());
 
         // Shader and Textures setup
-        m_Shader = std::make_unique<Shader>("res/shaders/Basic2.shader");
-        m_Shader->Bind();
-        int samplers[8] = {0, 1, 2, 3, 4, 5, 6, 7}; // allow up to 8 textures
-        m_Shader->SetUniform1iv("u_Textures", 8, samplers);
+        m_Uniforms = std::make_unique<FrameUniforms>();
+        m_Shader = std::make_unique<Shader>("res/shaders/Object.shader");
 
-        m_Texture = std::make_unique<Texture>("res/textures/alien.png");
-        m_Texture2 = std::make_unique<Texture>("res/textures/touch_grass.png");
-        m_Texture3 = std::make_unique<Texture>("res/textures/Em_button.png");
+        // Every instanced model is vertex colored, the variant skips the per fragment layer branch
+        m_InstancedShader = Shader::Get("res/shaders/Instanced.shader", {"UNTEXTURED"});
 
-        m_Texture->Bind();
-        m_Texture2->Bind(1);
-        m_Texture3->Bind(2);
+        // Materials, one layer per vertex texture index: 0 alien, 1 touch grass, 2 screen elements
+        m_Materials = std::make_unique<TextureArray>(MATERIAL_SIZE, MATERIAL_SIZE, 3);
+        m_Materials->Load(0, "res/textures/alien.png");
+        m_Materials->Load(1, "res/textures/touch_grass.png");
+        m_Materials->SetLayer(2, uiAtlas.GetPixels(), uiAtlas.GetSize(), uiAtlas.GetSize());
+        m_Materials->Bind();
 
         m_CameraFront = m_Drone - m_CameraPos;
         m_View = glm::lookAt(m_CameraPos + m_Drone,
@@ -139,7 +125,7 @@ namespace test
             m_ServerThread.join();
             std::cout << "Thread destroyed!";
         }
-        GLCall(glDisable(GL_DEPTH_TEST));
+        GLState::SetDepthTest(false);
 
         // Reset signal when exiting test case
         nlohmann::json state;
@@ -158,20 +144,17 @@ namespace test
 
     void Test3DC::OnUpdate(float deltaTime)
     {
-        // set dynamic vertex buffer for PickupZones pre comms with server
+        // set pickup zone instances pre comms with server
         if (m_MakeThread)
         {
-            std::vector<Vertex> positionsPickupZones;
-            std::vector<unsigned int> indicesPickupZones;
-            for (auto &pos : m_Targets)
+            // Only targets added since last frame become instances, so the instance buffer is
+            // uploaded when a target is placed rather than every frame
+            for (; m_PickupTargetCount < m_Targets.size(); m_PickupTargetCount++)
             {
-                PushCube(positionsPickupZones, indicesPickupZones, pos.x, pos.y + 10.0, pos.z, 10.0f, 10.0f, 10.0f, {0.59f, 0.29f, 0.0f}, -1.0f);
+                const glm::vec3& pos = m_Targets[m_PickupTargetCount];
+                glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(pos.x, pos.y + 10.0f, pos.z)), glm::vec3(10.0f));
+                m_Models->AddInstance(m_PickupModel, model, glm::vec4(0.59f, 0.29f, 0.0f, 1.0f));
             }
-
-            m_VertexBuffer_PickupZones->Bind();
-            GLCall(glBufferSubData(GL_ARRAY_BUFFER, 0, positionsPickupZones.size() * sizeof(Vertex), positionsPickupZones.data()));
-            m_IndexBuffer_PickupZones->Bind();
-            GLCall(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indicesPickupZones.size() * sizeof(unsigned int), indicesPickupZones.data()));
         }
         else
         {
@@ -241,24 +224,24 @@ namespace test
         }
 
         glm::mat4 vp = m_Proj * m_View;
+        glm::vec3 eye = m_FreeLookEnabled ? m_CameraPos : m_CameraPos + m_Drone;
+        m_Uniforms->BeginFrame();
+        m_Uniforms->SetCamera(m_View, m_Proj, eye);
 
+        // Everything but the instanced models goes through the queue, map chunks are drawn
+        // front to back and the screen elements last
         {
             // Map Elements
-            m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", vp);
-            renderer.Draw(*m_VAO_MapElements, *m_IndexBuffer_MapElements, *m_Shader);
+            m_MapChunks->Submit(m_Queue, *m_Shader, vp, eye);
         }
         {
             // Screen Elements
-            m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", m_Ortho);
-            renderer.Draw(*m_VAO_ScreenElements, *m_IndexBuffer_ScreenElements, *m_Shader);
-        }
-        {
-            // Pickup Zones
-            m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", vp);
-            renderer.Draw(*m_VAO_PickupZones, *m_IndexBuffer_PickupZones, *m_Shader);
+            DrawCommand screen;
+            screen.va = m_VAO_ScreenElements.get();
+            screen.ib = m_IndexBuffer_ScreenElements.get();
+            screen.shader = m_Shader.get();
+            screen.mvp = m_Ortho;
+            m_Queue.Submit(RenderPass::UI, screen);
         }
         {
             // Drone
@@ -268,12 +251,20 @@ namespace test
             model = glm::rotate(model, m_CurrentPitch, glm::vec3(1.0f, 0.0f, 0.0f));
             model = glm::rotate(model, m_CurrentRoll, glm::vec3(0.0f, 0.0f, 1.0f));
 
-            glm::mat4 mvp = vp * model;
-            m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", mvp);
-
-            renderer.Draw(*m_VAO_Drone, *m_IndexBuffer_Drone, *m_Shader);
+            DrawCommand drone;
+            drone.va = m_VAO_Drone.get();
+            drone.ib = m_IndexBuffer_Drone.get();
+            drone.shader = m_Shader.get();
+            drone.mvp = vp * model;
+            drone.model = model;
+            m_Queue.Submit(RenderPass::Opaque, drone, glm::length(m_Drone - eye));
+        }
+        {
+            // Pickup Zones
+            GPUScope scope("Pickup zones");
+            m_Models->Draw(renderer, *m_InstancedShader);
         }
+        m_Queue.Flush(renderer, m_Uniforms.get());
     }
 
     void Test3DC::OnImGuiRender()
@@ -283,6 +274,7 @@ namespace test
         ImGui::SliderFloat3("m_Drone", &m_Drone.x, -1000.0f, 1000.0f);
         ImGui::SliderFloat3("m_CameraPos", &m_CameraPos.x, 0.0f, 960.0f);
         ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+        ImGui::Text("Map chunks drawn: %u / %u", m_MapChunks->GetVisibleCount(), m_MapChunks->GetChunkCount());
 
         if (!m_LastLidarScan.empty())
         {
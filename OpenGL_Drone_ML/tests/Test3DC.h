@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Test.h"
+#include "ChunkedMesh.h"
+#include "ModelRegistry.h"
 
 #include <memory>
 #include <thread>
@@ -30,26 +32,27 @@ namespace test
 
     private:
         // draw call data
-        std::unique_ptr<VertexArray> m_VAO_MapElements;
-        std::unique_ptr<VertexBuffer> m_VertexBuffer_MapElements;
-        std::unique_ptr<IndexBuffer> m_IndexBuffer_MapElements;
+        std::unique_ptr<ChunkedMesh> m_MapChunks; // map is split into culled chunks
 
         std::unique_ptr<VertexArray> m_VAO_ScreenElements;
         std::unique_ptr<VertexBuffer> m_VertexBuffer_ScreenElements;
         std::unique_ptr<IndexBuffer> m_IndexBuffer_ScreenElements;
 
-        std::unique_ptr<VertexArray> m_VAO_PickupZones;
-        std::unique_ptr<VertexBuffer> m_VertexBuffer_PickupZones;
-        std::unique_ptr<IndexBuffer> m_IndexBuffer_PickupZones;
+        // pickup zones, one instanced draw for all targets
+        std::unique_ptr<ModelRegistry> m_Models;
+        unsigned int m_PickupModel;
+        size_t m_PickupTargetCount = 0; // m_Targets already added as instances
+
+        RenderQueue m_Queue;
 
         std::unique_ptr<VertexArray> m_VAO_Drone;
         std::unique_ptr<VertexBuffer> m_VertexBuffer_Drone;
         std::unique_ptr<IndexBuffer> m_IndexBuffer_Drone;
 
         std::unique_ptr<Shader> m_Shader;
-        std::unique_ptr<Texture> m_Texture;
-        std::unique_ptr<Texture> m_Texture2;
-        std::unique_ptr<Texture> m_Texture3;
+        std::shared_ptr<Shader> m_InstancedShader;
+        std::unique_ptr<FrameUniforms> m_Uniforms; // camera and per-draw blocks for every program
+        std::unique_ptr<TextureArray> m_Materials;
 
         // transformation data
         glm::mat4 m_Ortho;
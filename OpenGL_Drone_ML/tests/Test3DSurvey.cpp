@@ -1,4 +1,5 @@
 #include "Test3DSurvey.h"
+#include "GPUProfiler.h"
 #include "Renderer.h"
 
 #include "glm/glm.hpp"
@@ -27,9 +28,9 @@ namespace test
         glfwSetScrollCallback(window, ScrollCallback);
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
 
-        GLCall(glEnable(GL_BLEND));
-        GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
-        GLCall(glEnable(GL_DEPTH_TEST));
+        GLState::SetBlend(true);
+        GLState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        GLState::SetDepthTest(true);
 
         // Map Elements (Houses / Ground) (Ground is 1200 x 1000)
         std::vector<Vertex> positionsMapElements;
@@ -53,8 +54,7 @@ namespace test
         m_VAO_MapElements = std::make_unique<VertexArray>();
 
         m_VertexBuffer_MapElements = std::make_unique<VertexBuffer>(positionsMapElements.data(), positionsMapElements.size() * sizeof(Vertex));
-        VertexBufferLayout layoutMap;
-        layoutMap.Push<float>(3); layoutMap.Push<float>(3); layoutMap.Push<float>(2); layoutMap.Push<float>(1);
+        VertexBufferLayout layoutMap = Vertex::Format::Layout();
         m_VAO_MapElements->AddBuffer(*m_VertexBuffer_MapElements, layoutMap);
 
         m_IndexBuffer_MapElements = std::make_unique<IndexBuffer>(indicesMapElements.data(), indicesMapElements.size());
@@ -67,21 +67,18 @@ namespace test
         m_VAO_Drone = std::make_unique<VertexArray>();
 
         m_VertexBuffer_Drone = std::make_unique<VertexBuffer>(positionsDrone.data(), positionsDrone.size() * sizeof(Vertex));
-        VertexBufferLayout layoutDrone;
-        layoutDrone.Push<float>(3); layoutDrone.Push<float>(3); layoutDrone.Push<float>(2); layoutDrone.Push<float>(1);
+        VertexBufferLayout layoutDrone = Vertex::Format::Layout();
         m_VAO_Drone->AddBuffer(*m_VertexBuffer_Drone, layoutDrone);
 
         m_IndexBuffer_Drone = std::make_unique<IndexBuffer>(indicesDrone.data(), indicesDrone.size());
 
         // Shader and Textures setup
         m_Shader = std::make_unique<Shader>("res/shaders/Basic2.shader");
-        m_Shader->Bind();
-        int samplers[8] = { 0, 1, 2, 3, 4, 5, 6, 7 }; // allow up to 8 textures
-        m_Shader->SetUniform1iv("u_Textures", 8, samplers);
 
-        m_Texture = std::make_unique<Texture>("res/textures/touch_grass.png");
-
-        m_Texture->Bind(1);
+        // Materials, one layer per vertex texture index: 1 touch grass, 0 is unused
+        m_Materials = std::make_unique<TextureArray>(MATERIAL_SIZE, MATERIAL_SIZE, 2);
+        m_Materials->Load(1, "res/textures/touch_grass.png");
+        m_Materials->Bind();
 
         m_CameraFront = m_Drone - m_CameraPos;
         m_View = glm::lookAt(m_CameraPos + m_Drone, 
@@ -96,7 +93,7 @@ namespace test
         stopThread = true;
         if (m_ServerThread.joinable())
             {m_ServerThread.join(); std::cout << "Thread destroyed!";}
-        GLCall(glDisable(GL_DEPTH_TEST));
+        GLState::SetDepthTest(false);
 
         // Reset signal when exiting test case
         nlohmann::json state;
@@ -183,12 +180,14 @@ namespace test
 
         {
             // Map Elements
+            GPUScope scope("Map");
             m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", vp);
+            m_Shader->Set(m_Shader->GetMVPUniform(), vp);
             renderer.Draw(*m_VAO_MapElements, *m_IndexBuffer_MapElements, *m_Shader);
         }
         {
             // Drone
+            GPUScope scope("Drone");
             glm::mat4 model = glm::translate(glm::mat4(1.0f), m_Drone);
 
             // Apply pitch (forward/back) and roll (sideways)
@@ -197,7 +196,7 @@ namespace test
 
             glm::mat4 mvp = vp * model;
             m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", mvp);
+            m_Shader->Set(m_Shader->GetMVPUniform(), mvp);
 
             renderer.Draw(*m_VAO_Drone, *m_IndexBuffer_Drone, *m_Shader);
         }
@@ -39,7 +39,7 @@ namespace test
         std::unique_ptr<IndexBuffer> m_IndexBuffer_Drone;
 
         std::unique_ptr<Shader> m_Shader;
-        std::unique_ptr<Texture> m_Texture;
+        std::unique_ptr<TextureArray> m_Materials;
 
         // transformation data
         glm::mat4 m_Proj, m_View;
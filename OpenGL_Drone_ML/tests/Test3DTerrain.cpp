@@ -0,0 +1,508 @@
+#include "Test3DTerrain.h"
+#include "GPUProfiler.h"
+#include "Renderer.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+namespace test
+{
+
+    static const char *TILE_CACHE_PATH = "terrain3DC.tiles";
+
+    static const char *TERRAIN_MODEL_PATH = "res/assets/terrain_model/terrain.obj";
+    static const glm::vec3 GROUND_CENTER(1600.0f, 1.0f, -1500.0f), GROUND_EXTENT(1600.0f, 2.0f, 1500.0f);
+    static const glm::vec3 MODEL_POSITION(1000.0f, -2.0f, -900.0f), MODEL_SCALE(280.0f);
+    static const float TILE_SIZE = 250.0f;
+
+    // FNV-1a, continued from hash
+    static std::uint64_t Hash(const void *data, size_t size, std::uint64_t hash = 14695981039346656037ull)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= ((const unsigned char *)data)[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // Bakes the 3DC map (ground + terrain model) into a tile file, again whenever the model file,
+    // the layout or the Vertex format changes. Otherwise nothing has to be loaded up front, tiles
+    // come straight from the mapped file.
+    static std::unique_ptr<TileFile> BakeTileCache(const std::string &path)
+    {
+        std::error_code error;
+        const std::uint64_t modelSize = std::filesystem::file_size(TERRAIN_MODEL_PATH, error);
+        const std::int64_t modelTime = error ? 0 : (std::int64_t)std::filesystem::last_write_time(TERRAIN_MODEL_PATH, error).time_since_epoch().count();
+        const std::int64_t fields[] = {(std::int64_t)modelSize, modelTime, (std::int64_t)sizeof(Vertex)};
+        const float layout[] = {GROUND_CENTER.x, GROUND_CENTER.y, GROUND_CENTER.z, GROUND_EXTENT.x, GROUND_EXTENT.y, GROUND_EXTENT.z,
+            MODEL_POSITION.x, MODEL_POSITION.y, MODEL_POSITION.z, MODEL_SCALE.x, MODEL_SCALE.y, MODEL_SCALE.z, TILE_SIZE};
+        const std::uint64_t key = Hash(layout, sizeof(layout), Hash(fields, sizeof(fields)));
+
+        {
+            auto existing = std::make_unique<TileFile>(path);
+            if (existing->IsOpen() && existing->GetSourceKey() == key && existing->GetStride() == sizeof(Vertex))
+                return existing;
+        } // unmapped before it is overwritten
+
+        std::cout << "Baking terrain tiles to " << path << std::endl;
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        PushCube(vertices, indices, GROUND_CENTER.x, GROUND_CENTER.y, GROUND_CENTER.z, GROUND_EXTENT.x, GROUND_EXTENT.y, GROUND_EXTENT.z, {0.0, 0.0, 0.0}, 1.0f);
+        LoadModel(TERRAIN_MODEL_PATH, vertices, indices, 0.0f, MODEL_POSITION, MODEL_SCALE);
+        TileFile::Bake(path, vertices.data(), vertices.size(), sizeof(Vertex), indices, TILE_SIZE, key);
+        return std::make_unique<TileFile>(path);
+    }
+
+    // Samples the generator into a size x size heightmap, rows split across a few threads
+    static std::unique_ptr<Heightmap> GenerateHeightmap(const TerrainGenerator &generator, unsigned int size, float spacing)
+    {
+        std::vector<float> heights((size_t)size * size);
+        std::vector<std::thread> threads;
+        unsigned int threadCount = std::max(1u, std::min(8u, std::thread::hardware_concurrency()));
+        for (unsigned int t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back([&, t]()
+            {
+                for (unsigned int z = t; z < size; z += threadCount)
+                    generator.HeightRow(0, (int)z, spacing, size, &heights[(size_t)z * size]);
+            });
+        }
+        for (std::thread &thread : threads)
+            thread.join();
+        return std::make_unique<Heightmap>(size, size, spacing, heights.data());
+    }
+
+    Test3DTerrain::Test3DTerrain(GLFWwindow *window)
+        : m_Proj(glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 4000.0f)),
+          m_Drone(200, 300, -200), m_Window(window), m_FreeLookEnabled(false), m_LeftClick(false),
+          m_LastX(960 / 2), m_LastY(540 / 2)
+    {
+        glfwSetWindowUserPointer(window, this);
+        glfwSetKeyCallback(window, KeyCallback);
+        glfwSetCursorPosCallback(window, MouseCallback);
+        glfwSetMouseButtonCallback(window, TestMenu::MouseButtonCallback);
+        glfwSetScrollCallback(window, ScrollCallback);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+
+        GLState::SetBlend(true);
+        GLState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        GLState::SetDepthTest(true);
+
+        // Terrain - STREAMED
+        CreateTerrain();
+
+        // Drone
+        std::vector<Vertex> positionsDrone;
+        std::vector<unsigned int> indicesDrone;
+        LoadModel("res/assets/drone_costum.obj", positionsDrone, indicesDrone, 0.0f, {0.0f, 0.0f, 0.0f}, {2.5f, 2.5f, 2.5f});
+
+        m_VAO_Drone = std::make_unique<VertexArray>();
+        m_VertexBuffer_Drone = std::make_unique<VertexBuffer>(positionsDrone.data(), positionsDrone.size() * sizeof(Vertex));
+        m_VAO_Drone->AddBuffer(*m_VertexBuffer_Drone, Vertex::Format::Layout());
+        m_IndexBuffer_Drone = std::make_unique<IndexBuffer>(indicesDrone.data(), indicesDrone.size());
+
+        // Shader and Textures setup
+        m_Shader = std::make_unique<Shader>("res/shaders/Basic2.shader");
+
+        // 64x64 samples over the LiDAR grid and a bit beyond, 2000 units down
+        m_DepthCamera = std::make_unique<DepthCamera>(64, 200.0f, 2000.0f);
+
+        // Materials, one layer per vertex texture index: 0 alien, 1 touch grass
+        m_Materials = std::make_unique<TextureArray>(MATERIAL_SIZE, MATERIAL_SIZE, 2);
+        m_Materials->Load(0, "res/textures/alien.png");
+        m_Materials->Load(1, "res/textures/touch_grass.png");
+        m_Materials->Bind();
+    }
+
+    Test3DTerrain::~Test3DTerrain()
+    {
+        GLState::SetDepthTest(false);
+    }
+
+    void Test3DTerrain::CreateTerrain()
+    {
+        m_Streamer.reset(); // joins the old workers before the new pool is allocated
+        m_CDLOD.reset();
+        m_Heightmap.reset();
+
+        TerrainNoiseSettings settings;
+        settings.seed = (std::uint32_t)m_Seed;
+
+        if (m_TerrainSource == 0)
+        {
+            auto tiles = BakeTileCache(TILE_CACHE_PATH);
+            if (tiles->IsOpen())
+                m_Streamer = std::make_unique<TerrainStreamer>(std::move(tiles), Vertex::Format::Layout(), 64, m_LoadRadius);
+        }
+        else if (m_TerrainSource == 1)
+        {
+            // Generation is CPU bound, so spread it over a few workers to stay ahead of the drone
+            auto generator = std::make_unique<TerrainGenerator>(settings, 256.0f, 64);
+            m_Streamer = std::make_unique<TerrainStreamer>(std::move(generator), TerrainVertex::Format::Layout(), 96, m_LoadRadius, 3);
+        }
+        else if (m_TerrainSource == 2)
+        {
+            TerrainGenerator generator(settings);
+            m_Heightmap = GenerateHeightmap(generator, (unsigned int)m_HeightmapSize, 4.0f);
+        }
+        else
+        {
+            m_Heightmap = Heightmap::Load(m_HeightmapPath, m_Import);
+        }
+
+        if (!m_Heightmap)
+            return;
+
+        GLint maxTextureSize = 0;
+        GLCall(glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize));
+        if ((GLint)m_Heightmap->GetWidth() <= maxTextureSize && (GLint)m_Heightmap->GetHeight() <= maxTextureSize)
+        {
+            // Whole map resident as a single channel texture, one grid mesh displaced per node
+            m_CDLOD = std::make_unique<CDLODTerrain>(*m_Heightmap, 32, 6, m_LodDistance);
+            m_LodDistance = m_CDLOD->GetLodDistance();
+            if (!m_TerrainShader)
+                m_TerrainShader = std::make_unique<Shader>("res/shaders/Terrain.shader");
+        }
+        else
+        {
+            // Too big for a texture, stream mesh tiles cut straight out of the (mapped) grid
+            auto tiles = std::make_unique<HeightmapTileSource>(m_Heightmap, 64);
+            m_Streamer = std::make_unique<TerrainStreamer>(std::move(tiles), TerrainVertex::Format::Layout(), 96, m_LoadRadius, 3);
+        }
+        m_Drone = glm::vec3(m_Heightmap->GetWorldWidth() * 0.5f, m_Heightmap->GetMaxHeight() + 50.0f, m_Heightmap->GetWorldDepth() * 0.5f);
+    }
+
+    void Test3DTerrain::OnUpdate(float deltaTime)
+    {
+        glm::vec3 lastDrone = m_Drone;
+        ProcessInput(deltaTime);
+        if (deltaTime > 0.0f)
+            m_DroneVelocity = (m_Drone - lastDrone) / deltaTime;
+
+        if (m_CDLOD)
+            m_CDLOD->SetLodDistance(m_LodDistance);
+
+        const bool depthCamera = m_UseDepthCamera && m_Streamer;
+        m_LidarTimer += deltaTime;
+        if (m_LidarTimer >= 0.25f) // same rate the server thread samples at
+        {
+            if (depthCamera)
+                m_DepthCaptureDue = true; // drawn in OnRender, read back a frame or two later
+            else
+                m_LastLidarScan = LidarScanBelow();
+            m_LidarTimer = 0.0f;
+        }
+    }
+
+    void Test3DTerrain::OnRender()
+    {
+        Renderer renderer;
+
+        // Streaming and the depth camera upload and read back, so they live here rather than in OnUpdate
+        if (m_Streamer)
+        {
+            // Stream around the drone, two seconds ahead of it so tiles are ready before it arrives,
+            // and around the camera too when it wanders off in free look
+            std::vector<glm::vec3> focus = {m_Drone, m_Drone + m_DroneVelocity * 2.0f};
+            if (m_FreeLookEnabled)
+                focus.push_back(m_CameraPos);
+            m_Streamer->SetLoadRadius(m_LoadRadius);
+            m_Streamer->Update(focus);
+        }
+        if (m_UseDepthCamera && m_Streamer && m_DepthCamera->Poll())
+            m_LastLidarScan = m_DepthCamera->SampleGrid(5, 25.0f);
+
+        if (m_DepthCaptureDue && m_Streamer)
+        {
+            m_DepthCamera->Capture(m_Drone, [&](Shader& shader, const glm::mat4& viewProj)
+            {
+                shader.Set(shader.GetMVPUniform(), viewProj);
+                m_Streamer->Draw(renderer, shader, viewProj);
+            });
+        }
+        m_DepthCaptureDue = false;
+
+        GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+        GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+
+        if (m_FreeLookEnabled)
+        {
+            m_View = glm::lookAt(m_CameraPos, m_CameraFront + m_CameraPos, m_CameraUp);
+        }
+        else
+        {
+            m_CameraFront = m_Drone - m_CameraPos;
+            m_View = glm::lookAt(m_CameraPos + m_Drone, m_CameraFront + m_CameraPos, m_CameraUp);
+        }
+
+        glm::mat4 vp = m_Proj * m_View;
+
+        if (m_Streamer)
+        {
+            // Terrain
+            GPUScope scope("Terrain");
+            m_Shader->Bind();
+            m_Shader->Set(m_Shader->GetMVPUniform(), vp);
+            m_Streamer->Draw(renderer, *m_Shader, vp);
+        }
+        if (m_CDLOD)
+        {
+            // Terrain
+            GPUScope scope("Terrain");
+            glm::vec3 eye = m_FreeLookEnabled ? m_CameraPos : m_CameraPos + m_Drone;
+            m_CDLOD->Draw(renderer, *m_TerrainShader, vp, eye);
+        }
+        {
+            // Drone
+            GPUScope scope("Drone");
+            glm::mat4 mvp = vp * glm::translate(glm::mat4(1.0f), m_Drone);
+            m_Shader->Bind();
+            m_Shader->Set(m_Shader->GetMVPUniform(), mvp);
+            renderer.Draw(*m_VAO_Drone, *m_IndexBuffer_Drone, *m_Shader);
+        }
+    }
+
+    void Test3DTerrain::OnImGuiRender()
+    {
+        ImGuiIO &io = ImGui::GetIO();
+        ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+        ImGui::SliderFloat3("m_Drone", &m_Drone.x, -5000.0f, 5000.0f);
+        ImGui::SliderFloat("Drone speed", &m_DroneSpeed, 10.0f, 2000.0f);
+
+        const char *sources[] = {"Baked 3DC map", "Procedural", "Heightmap (CDLOD)", "Heightmap file"};
+        bool regenerate = ImGui::Combo("Terrain", &m_TerrainSource, sources, 4);
+        if (m_TerrainSource == 1 || m_TerrainSource == 2)
+        {
+            ImGui::InputInt("Seed", &m_Seed);
+            if (m_TerrainSource == 2)
+                ImGui::SliderInt("Heightmap size", &m_HeightmapSize, 256, 4096);
+            regenerate |= ImGui::Button("Regenerate");
+        }
+        else if (m_TerrainSource == 3)
+        {
+            // RAW and PGM carry no scale or spacing, DHM files bring their own
+            ImGui::InputText("Path", m_HeightmapPath, sizeof(m_HeightmapPath));
+            ImGui::InputInt("RAW width (0 = square)", (int *)&m_Import.width);
+            ImGui::InputInt("RAW height", (int *)&m_Import.height);
+            ImGui::InputFloat("Spacing", &m_Import.spacing);
+            ImGui::InputFloat("Height scale", &m_Import.scale);
+            ImGui::InputFloat("Height offset", &m_Import.offset);
+            ImGui::InputFloat2("Height range (min > max = unknown)", &m_Import.minHeight);
+            regenerate |= ImGui::Button("Load");
+            if (!m_Heightmap)
+                ImGui::Text("No heightmap loaded");
+            else
+                ImGui::Text("%ux%u samples, %s", m_Heightmap->GetWidth(), m_Heightmap->GetHeight(), m_Heightmap->IsMapped() ? "memory mapped" : "in memory");
+        }
+        if (regenerate)
+            CreateTerrain();
+
+        if (m_CDLOD)
+        {
+            const Heightmap &map = m_CDLOD->GetHeightmap();
+            ImGui::SliderFloat("LOD distance", &m_LodDistance, 100.0f, 2000.0f);
+            ImGui::Text("Heightmap %ux%u, %.1f MB on the GPU", map.GetWidth(), map.GetHeight(), m_CDLOD->GetGPUBytes() / (1024.0f * 1024.0f));
+            ImGui::Text("Nodes drawn: %u (%u LODs)", m_CDLOD->GetNodeCount(), m_CDLOD->GetLodCount());
+        }
+        else if (!m_Streamer)
+        {
+            if (m_TerrainSource == 0)
+                ImGui::Text("No terrain tiles loaded (%s)", TILE_CACHE_PATH);
+            return;
+        }
+        else
+        {
+            ImGui::SliderFloat("Load radius", &m_LoadRadius, 100.0f, 4000.0f);
+            ImGui::Text("Tiles resident: %u / %u (drawn %u)", m_Streamer->GetResidentCount(), m_Streamer->GetPoolSize(), m_Streamer->GetVisibleCount());
+            ImGui::Text("Tiles pending: %u, evictions: %u", m_Streamer->GetPendingCount(), m_Streamer->GetEvictionCount());
+            ImGui::Text("Uploaded this frame: %u tiles (%.1f KB)", m_Streamer->GetUploadsLastFrame(), m_Streamer->GetBytesUploadedLastFrame() / 1024.0f);
+            ImGui::Checkbox("LiDAR from depth camera", &m_UseDepthCamera);
+            if (m_UseDepthCamera)
+                ImGui::Text("Depth camera: %d samples, %u captures dropped", m_DepthCamera->GetResolution() * m_DepthCamera->GetResolution(),
+                    m_DepthCamera->GetDroppedCount());
+        }
+
+        if (!m_LastLidarScan.empty())
+        {
+            ImGui::Separator();
+            ImGui::Text("LiDAR Below Drone (Bird's Eye)");
+
+            const int gridSize = m_LastLidarScan.size();
+            const float cellSize = 20.0f; // pixel size per cell
+            float minVal = -2.0f, maxVal = 170.0f;
+            if (m_Heightmap)
+            {
+                minVal = m_Heightmap->GetMinHeight();
+                maxVal = m_Heightmap->GetMaxHeight();
+            }
+            else if (m_TerrainSource == 1)
+            {
+                minVal = -350.0f;
+                maxVal = 350.0f;
+            }
+
+            ImDrawList *drawList = ImGui::GetWindowDrawList();
+            ImVec2 origin = ImGui::GetCursorScreenPos();
+            for (int i = 0; i < gridSize; i++)
+            {
+                for (int j = 0; j < gridSize; j++)
+                {
+                    float val = m_LastLidarScan[i][j];
+                    ImU32 color;
+                    if (val <= -900.0f)
+                    {
+                        color = IM_COL32(50, 50, 50, 255); // missing data (or tile not resident)
+                    }
+                    else
+                    {
+                        float t = (val - minVal) / (maxVal - minVal + 0.0001f);
+                        ImVec4 col = ImVec4(
+                            std::clamp(1.5f * t, 0.0f, 1.0f),
+                            std::clamp(1.5f - fabsf(2.0f * t - 1.0f), 0.0f, 1.0f),
+                            std::clamp(1.5f * (1.0f - t), 0.0f, 1.0f),
+                            1.0f);
+                        color = ImGui::ColorConvertFloat4ToU32(col);
+                    }
+
+                    ImVec2 p0(origin.x + j * cellSize, origin.y + i * cellSize);
+                    ImVec2 p1(p0.x + cellSize, p0.y + cellSize);
+                    drawList->AddRectFilled(p0, p1, color);
+                    drawList->AddRect(p0, p1, IM_COL32(20, 20, 20, 80));
+                }
+            }
+            ImGui::Dummy(ImVec2(gridSize * cellSize, gridSize * cellSize));
+        }
+    }
+
+    std::vector<std::vector<float>> Test3DTerrain::LidarScanBelow()
+    {
+        const int gridSize = 5;      // 5x5 samples under drone
+        const float spacing = 25.0f; // world units between samples
+
+        std::vector<std::vector<float>> grid(gridSize, std::vector<float>(gridSize, -999.0f));
+        if (!m_Streamer && !m_Heightmap)
+            return grid;
+
+        float half = (gridSize - 1) / 2.0f;
+        for (int i = 0; i < gridSize; i++)
+        {
+            for (int j = 0; j < gridSize; j++)
+            {
+                glm::vec3 origin = m_Drone + glm::vec3((j - half) * spacing, 0.0f, (i - half) * spacing);
+                float t;
+                if (m_Heightmap)
+                {
+                    // Straight down onto a heightfield is just a lookup
+                    if (m_Heightmap->Contains(origin.x, origin.z) && m_Heightmap->Sample(origin.x, origin.z) <= origin.y)
+                        grid[i][j] = m_Heightmap->Sample(origin.x, origin.z);
+                }
+                else if (m_Streamer->Raycast(origin, glm::vec3(0, -1, 0), t))
+                    grid[i][j] = origin.y - t;
+            }
+        }
+        return grid;
+    }
+
+    void Test3DTerrain::ProcessInput(float deltaTime)
+    {
+        m_LeftClick = glfwGetMouseButton(m_Window, GLFW_MOUSE_BUTTON_1) == GLFW_PRESS;
+
+        if (m_FreeLookEnabled)
+        {
+            const float cameraSpeed = 150.0f * deltaTime;
+            if (glfwGetKey(m_Window, GLFW_KEY_W) == GLFW_PRESS)
+                m_CameraPos += cameraSpeed * m_CameraFront;
+            if (glfwGetKey(m_Window, GLFW_KEY_S) == GLFW_PRESS)
+                m_CameraPos -= cameraSpeed * m_CameraFront;
+            if (glfwGetKey(m_Window, GLFW_KEY_A) == GLFW_PRESS)
+                m_CameraPos -= glm::normalize(glm::cross(m_CameraFront, m_CameraUp)) * cameraSpeed;
+            if (glfwGetKey(m_Window, GLFW_KEY_D) == GLFW_PRESS)
+                m_CameraPos += glm::normalize(glm::cross(m_CameraFront, m_CameraUp)) * cameraSpeed;
+            return;
+        }
+
+        // Chase camera, WASD flies the drone over the map and Q/E change altitude
+        const float droneSpeed = m_DroneSpeed * deltaTime;
+        if (glfwGetKey(m_Window, GLFW_KEY_W) == GLFW_PRESS)
+            m_Drone.z -= droneSpeed;
+        if (glfwGetKey(m_Window, GLFW_KEY_S) == GLFW_PRESS)
+            m_Drone.z += droneSpeed;
+        if (glfwGetKey(m_Window, GLFW_KEY_A) == GLFW_PRESS)
+            m_Drone.x -= droneSpeed;
+        if (glfwGetKey(m_Window, GLFW_KEY_D) == GLFW_PRESS)
+            m_Drone.x += droneSpeed;
+        if (glfwGetKey(m_Window, GLFW_KEY_E) == GLFW_PRESS)
+            m_Drone.y += droneSpeed;
+        if (glfwGetKey(m_Window, GLFW_KEY_Q) == GLFW_PRESS)
+            m_Drone.y -= droneSpeed;
+    }
+
+    void Test3DTerrain::KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mods)
+    {
+        ImGui_ImplGlfw_KeyCallback(window, key, scancode, action, mods);
+        auto *self = static_cast<Test3DTerrain *>(glfwGetWindowUserPointer(window));
+        if (!self)
+            return;
+
+        if (key == GLFW_KEY_F && action == GLFW_RELEASE)
+        {
+            if (!self->m_FreeLookEnabled)
+            {
+                self->m_CameraPos = self->m_CameraPos + self->m_Drone;
+                self->yaw = -90.0f;
+                self->pitch = -45.0f;
+                glm::vec3 front;
+                front.x = cos(glm::radians(self->yaw)) * cos(glm::radians(self->pitch));
+                front.y = sin(glm::radians(self->pitch));
+                front.z = sin(glm::radians(self->yaw)) * cos(glm::radians(self->pitch));
+                self->m_CameraFront = glm::normalize(front);
+            }
+            else
+                self->m_CameraPos = glm::vec3(0.0f, 100.0f, 100.0f);
+            self->m_FreeLookEnabled = !self->m_FreeLookEnabled;
+        }
+    }
+
+    void Test3DTerrain::MouseCallback(GLFWwindow *window, double xposIn, double yposIn)
+    {
+        ImGui_ImplGlfw_CursorPosCallback(window, xposIn, yposIn);
+        auto *self = static_cast<Test3DTerrain *>(glfwGetWindowUserPointer(window));
+        if (!self)
+            return;
+
+        float xpos = static_cast<float>(xposIn);
+        float ypos = static_cast<float>(yposIn);
+
+        if (self->m_LeftClick && self->m_FreeLookEnabled)
+        {
+            float sensitivity = 0.5f;
+            self->yaw += (xpos - self->m_LastX) * sensitivity;
+            self->pitch += (self->m_LastY - ypos) * sensitivity; // inverted Y
+            self->pitch = std::clamp(self->pitch, -89.0f, 89.0f);
+
+            glm::vec3 front;
+            front.x = cos(glm::radians(self->yaw)) * cos(glm::radians(self->pitch));
+            front.y = sin(glm::radians(self->pitch));
+            front.z = sin(glm::radians(self->yaw)) * cos(glm::radians(self->pitch));
+            self->m_CameraFront = glm::normalize(front);
+        }
+        self->m_LastX = xpos;
+        self->m_LastY = ypos;
+    }
+
+    void Test3DTerrain::ScrollCallback(GLFWwindow *window, double xoffset, double yoffset)
+    {
+        ImGui_ImplGlfw_ScrollCallback(window, xoffset, yoffset);
+        auto *self = static_cast<Test3DTerrain *>(glfwGetWindowUserPointer(window));
+        if (!self)
+            return;
+        self->fov = std::clamp(self->fov - (float)yoffset, 1.0f, 60.0f);
+        self->m_Proj = glm::perspective(glm::radians(self->fov), 16.0f / 9.0f, 0.1f, 4000.0f);
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Test.h"
+#include "TerrainStreamer.h"
+#include "TerrainGenerator.h"
+#include "CDLODTerrain.h"
+#include "DepthCamera.h"
+#include "HeightmapTileSource.h"
+
+#include <memory>
+
+namespace test
+{
+
+    // Free flight over streamed terrain. WASD/QE fly the drone (F toggles free look like 3DC),
+    // tiles are paged in around the drone and camera and LiDAR only sees resident tiles.
+    // Tiles come either from the baked 3DC map or from the procedural generator (endless),
+    // or a heightmap (generated or imported from RAW/PGM/DHM) is drawn with CDLOD instead of streaming meshes
+    class Test3DTerrain : public Test
+    {
+    public:
+        Test3DTerrain(GLFWwindow *window);
+        ~Test3DTerrain();
+
+        void OnUpdate(float deltaTime) override;
+        void OnRender() override;
+        void OnImGuiRender() override;
+
+    private:
+        // draw call data
+        std::unique_ptr<TerrainStreamer> m_Streamer;
+        std::shared_ptr<Heightmap> m_Heightmap;
+        std::unique_ptr<CDLODTerrain> m_CDLOD;
+        int m_TerrainSource = 0; // 0 = baked 3DC map, 1 = procedural, 2 = generated heightmap (CDLOD), 3 = heightmap file
+        char m_HeightmapPath[256] = "res/heightmaps/terrain.dhm";
+        HeightmapImport m_Import;
+        int m_Seed = 1337;
+        int m_HeightmapSize = 2048;
+        float m_LodDistance = 0.0f;
+
+        std::unique_ptr<VertexArray> m_VAO_Drone;
+        std::unique_ptr<VertexBuffer> m_VertexBuffer_Drone;
+        std::unique_ptr<IndexBuffer> m_IndexBuffer_Drone;
+
+        std::unique_ptr<Shader> m_Shader;
+        std::unique_ptr<Shader> m_TerrainShader;
+        std::unique_ptr<TextureArray> m_Materials;
+
+        // transformation data
+        glm::mat4 m_Proj, m_View;
+        glm::vec3 m_Drone;
+        glm::vec3 m_DroneVelocity = glm::vec3(0.0f);
+        float m_DroneSpeed = 300.0f;
+        float m_LoadRadius = 1200.0f;
+
+        // camera work
+        glm::vec3 m_CameraPos = glm::vec3(0.0f, 100.0f, 100.0f);
+        glm::vec3 m_CameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+        glm::vec3 m_CameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+        float yaw = -90.0f;
+        float pitch = 0.0f;
+        float fov = 45.0f;
+
+        // user input data
+        GLFWwindow *m_Window;
+        bool m_FreeLookEnabled;
+        bool m_LeftClick;
+        float m_LastX, m_LastY;
+
+        // LiDAR against resident tiles only
+        std::vector<std::vector<float>> LidarScanBelow();
+        std::vector<std::vector<float>> m_LastLidarScan;
+        float m_LidarTimer = 0.0f;
+
+        // Or the same grid out of a depth camera render of the streamed tiles
+        std::unique_ptr<DepthCamera> m_DepthCamera;
+        bool m_UseDepthCamera = false;
+        bool m_DepthCaptureDue = false;
+
+        void CreateTerrain();
+        void ProcessInput(float deltaTime);
+        static void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mods);
+        static void MouseCallback(GLFWwindow *window, double xposIn, double yposIn);
+        static void ScrollCallback(GLFWwindow *window, double xoffset, double yoffset);
+    };
+
+}
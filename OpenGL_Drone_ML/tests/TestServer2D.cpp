@@ -30,8 +30,8 @@ namespace test
             0, 1, 2,
             2, 3, 0};
 
-        GLCall(glEnable(GL_BLEND));
-        GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+        GLState::SetBlend(true);
+        GLState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         m_VAO = std::make_unique<VertexArray>();
 
@@ -70,6 +70,7 @@ namespace test
 
     void TestServer2D::OnUpdate(float deltaTime)
     {
+        CommunicateWithServer(); // blocks on the server, so not on the render thread
     }
 
     void TestServer2D::OnRender()
@@ -81,13 +82,11 @@ namespace test
 
         m_Texture->Bind();
 
-        CommunicateWithServer();
-
         {
             glm::mat4 model = glm::translate(glm::mat4(1.0f), m_TranslationA);
             glm::mat4 mvp = m_Proj * m_View * model; // OpenGL col major leads to this order**
             m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", mvp);
+            m_Shader->Set(m_Shader->GetMVPUniform(), mvp);
 
             renderer.Draw(*m_VAO, *m_IndexBuffer, *m_Shader);
         }
@@ -96,7 +95,7 @@ namespace test
             glm::mat4 model = glm::translate(glm::mat4(1.0f), m_TranslationB);
             glm::mat4 mvp = m_Proj * m_View * model; // OpenGL col major leads to this order**
             m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", mvp);
+            m_Shader->Set(m_Shader->GetMVPUniform(), mvp);
 
             renderer.Draw(*m_VAO, *m_IndexBuffer, *m_Shader);
         }
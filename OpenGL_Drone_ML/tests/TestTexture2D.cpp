@@ -26,8 +26,8 @@ namespace test {
             2, 3, 0
         };
 
-        GLCall(glEnable(GL_BLEND));
-        GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+        GLState::SetBlend(true);
+        GLState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         m_VAO = std::make_unique<VertexArray>();
 
@@ -69,7 +69,7 @@ namespace test {
             glm::mat4 model = glm::translate(glm::mat4(1.0f), m_TranslationA);
             glm::mat4 mvp = m_Proj * m_View * model; // OpenGL col major leads to this order**
             m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", mvp);
+            m_Shader->Set(m_Shader->GetMVPUniform(), mvp);
             
             renderer.Draw(*m_VAO, *m_IndexBuffer, *m_Shader);
         }
@@ -78,7 +78,7 @@ namespace test {
             glm::mat4 model = glm::translate(glm::mat4(1.0f), m_TranslationB);
             glm::mat4 mvp = m_Proj * m_View * model; // OpenGL col major leads to this order**
             m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", mvp);
+            m_Shader->Set(m_Shader->GetMVPUniform(), mvp);
             
             renderer.Draw(*m_VAO, *m_IndexBuffer, *m_Shader);
         }